@@ -0,0 +1,104 @@
+#ifndef ANOMALIAS_H
+#define ANOMALIAS_H
+
+// Detección de anomalías sobre la marcha, por métrica, en O(1) por muestra:
+//
+//   rechazada      el sensor no dio un valor válido (sin respuesta, o fuera
+//                  del rango físico de sensores.cpp) y se publicó el anterior
+//   limite         el valor se aleja del promedio más de ANOMALIA_K_SIGMAS
+//                  desvíos (límites de control sobre promedio y varianza
+//                  exponenciales)
+//   velocidad      cambió más rápido que el máximo por minuto de la métrica
+//
+// Las primeras ANOMALIA_CALENTAMIENTO muestras arman la línea de base con
+// Welford, sin alertar; después promedio y varianza siguen con un peso
+// ANOMALIA_ALFA por muestra. Las muestras anómalas no entran en la línea de
+// base. Si siguen anómalas ANOMALIA_PERSISTENCIA muestras seguidas, se toma
+// como un cambio de nivel real (p. ej. se agregó cloro) y la línea de base
+// vuelve a empezar desde ahí.
+//
+// Un episodio es una racha de muestras anómalas: se avisa una vez, al
+// empezar. Los episodios de una sola muestra se cuentan aparte: son casi
+// siempre ruido, la mejor aproximación a falsos positivos que hay sin saber
+// qué pasó en el agua. No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ANOMALIA_K_SIGMAS 4.0f
+#define ANOMALIA_ALFA 0.05f
+#define ANOMALIA_CALENTAMIENTO 10
+#define ANOMALIA_PERSISTENCIA 6
+#define ANOMALIA_LARGO_JSON 224    // Una alerta, con device_id de 32
+#define ANOMALIA_LARGO_INFORME 640 // describirDetector()
+
+enum MetricaAnomalia : uint8_t { METRICA_PH, METRICA_TEMPERATURA, METRICA_TDS, CANTIDAD_METRICAS };
+
+enum TipoAnomalia : uint8_t {
+  ANOMALIA_NINGUNA,
+  ANOMALIA_RECHAZADA,
+  ANOMALIA_LIMITE,
+  ANOMALIA_VELOCIDAD,
+  CANTIDAD_TIPOS_ANOMALIA
+};
+
+struct LimitesMetrica {
+  const char* nombre;       // Como en el esquema de la telemetría
+  float sigmaMinima;        // Piso del desvío: con el agua quieta la varianza tiende a 0
+  float maximoPorMinuto;    // Cambio más rápido que se considera normal
+};
+
+extern const LimitesMetrica LIMITES_METRICAS[CANTIDAD_METRICAS];
+
+struct DetectorMetrica {
+  uint32_t muestras;        // De la línea de base
+  double media;
+  double varianza;          // En el calentamiento, la suma de Welford (M2)
+  float anterior;           // Última muestra normal
+  uint32_t msAnterior;
+  bool hayAnterior;
+  uint8_t seguidas;         // Muestras anómalas seguidas
+
+  // Contadores
+  uint32_t evaluadas;
+  uint32_t anomalas[CANTIDAD_TIPOS_ANOMALIA];
+  uint32_t episodios;
+  uint32_t transitorios;    // Episodios de una sola muestra
+  uint32_t cambiosNivel;    // Episodios que terminaron en una línea de base nueva
+};
+
+struct DetectorAnomalias {
+  DetectorMetrica metricas[CANTIDAD_METRICAS];
+};
+
+// Un episodio que empieza: lo que va en la alerta
+struct Anomalia {
+  MetricaAnomalia metrica;
+  TipoAnomalia tipo;
+  float valor;              // En una rechazada, el que se descartó (NAN si no hubo)
+  float esperado;           // Promedio de la línea de base, o el valor anterior para 'velocidad'
+  float limite;             // Diferencia máxima aceptada con 'esperado'
+};
+
+void iniciarDetector(DetectorAnomalias* detector);
+
+// Evalúa una muestra de cada métrica. 'rechazadas' tiene un bit
+// (1 << metrica) por cada una que el sensor no pudo leer; su valor (lo que
+// dio el sensor, o NAN) solo va a la alerta, no a la línea de base. Un
+// valor NAN o infinito se toma como rechazado aunque no tenga su bit. Deja en
+// 'nuevas' los episodios que empiezan con esta muestra y devuelve cuántos
+// son.
+uint8_t evaluarMuestra(DetectorAnomalias* detector, const float valores[CANTIDAD_METRICAS], uint8_t rechazadas,
+                       uint32_t ms, Anomalia nuevas[CANTIDAD_METRICAS]);
+
+const char* nombreTipoAnomalia(TipoAnomalia tipo);
+
+// Alerta en JSON (terminado en \0); un valor NAN va como null. Devuelve
+// el largo.
+size_t codificarAlertaJson(const Anomalia& anomalia, uint32_t timestamp, const char* idDispositivo, char* destino,
+                           size_t capacidad);
+
+// Contadores de cada métrica en JSON (GET /api/anomalies). Devuelve el largo.
+size_t describirDetector(const DetectorAnomalias& detector, char* destino, size_t largo);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef ARRANQUE_H
+#define ARRANQUE_H
+
+// Perfil del arranque: en qué milisegundo (desde que arrancó la aplicación,
+// sin contar el bootloader) terminó cada fase, hasta la primera publicación.
+// Cada fase se marca una sola vez; las que no ocurrieron no se informan.
+// No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum FaseArranque : uint8_t {
+  FASE_SETUP,                // Comienzo de setup()
+  FASE_TRANSPORTE,           // Certificados cargados
+  FASE_PORTAL,               // Punto de acceso y servidor web
+  FASE_CONFIGURACION,        // Red configurada (portal o guardada)
+  FASE_SENSORES,             // Sensores iniciados
+  FASE_PRIMERA_LECTURA,
+  FASE_WIFI,                 // Asociado y con IP
+  FASE_HORA,                 // Hora NTP
+  FASE_INICIO_SALIDA,        // Primer intento de conectar al broker
+  FASE_SALIDA,               // Broker conectado (con TLS, después del handshake)
+  FASE_PRIMERA_PUBLICACION,
+  CANTIDAD_FASES
+};
+
+#define ARRANQUE_LARGO_INFORME 384  // JSON de describirArranque(), con device_id de 32
+
+struct Arranque {
+  uint32_t ms[CANTIDAD_FASES];
+  uint16_t marcadas;  // Un bit por fase
+};
+
+void iniciarArranque(Arranque* arranque);
+
+// La primera vez que se marca cada fase queda 'ms'; las siguientes no cambian nada
+void marcarFase(Arranque* arranque, FaseArranque fase, uint32_t ms);
+
+bool faseMarcada(const Arranque& arranque, FaseArranque fase);
+
+// Informe en JSON: {"device_id":...,"version":...,"reset_reason":...,
+// "phases_ms":{"setup":...,...}}. Devuelve el largo.
+size_t describirArranque(const Arranque& arranque, const char* idDispositivo, const char* version,
+                         const char* motivoReinicio, char* destino, size_t largo);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef ASOCIACION_H
+#define ASOCIACION_H
+
+// Reconexión rápida a WiFi. Después de cada conexión se guardan en NVS el
+// BSSID y el canal del AP y la IP, puerta de enlace, máscara y DNS que dio
+// el DHCP. La próxima asociación a la misma red va directo a ese AP y
+// canal, sin escanear, y con esa IP fija, sin DHCP: tarda una fracción de
+// la completa.
+//
+// Si la rápida no conecta en ASOCIACION_PLAZO_RAPIDO_MS (cambió el AP o el
+// canal, o el router no la acepta), se descarta lo guardado y se hace la
+// completa, con escaneo y DHCP. NVS se escribe solo cuando algo cambió.
+//
+// La IP se reusa sin pedirla: conviene reservarla en el router para que el
+// DHCP no se la dé a otro equipo. Con -DASOCIACION_REUSAR_IP=0 se guarda
+// solo el AP y el canal, y la IP se sigue pidiendo por DHCP. Lo guardado
+// sale siempre de un DHCP, nunca de una conexión con la IP fija:
+//
+//   - si con la IP fija la red no responde en
+//     ASOCIACION_PLAZO_VERIFICACION_MS, se vuelve a asociar al mismo AP con
+//     DHCP. Responde si la puerta de enlace contesta el ARP, que se le
+//     pregunta cada ASOCIACION_PERIODO_PRUEBA_MS, o si algo de afuera
+//     contestó (redAlcanzada()). Así una caída del broker no cuenta.
+//   - cada ASOCIACION_RENOVAR_MS con la IP fija se vuelve a asociar al
+//     mismo AP pidiendo la IP por DHCP, para que el router la siga viendo
+//     en uso y para tomar cambios de la red
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ASOCIACION_RAPIDA
+#define ASOCIACION_RAPIDA 1
+#endif
+#ifndef ASOCIACION_REUSAR_IP
+#define ASOCIACION_REUSAR_IP 1
+#endif
+
+#define ASOCIACION_PLAZO_RAPIDO_MS 3000
+#define ASOCIACION_PLAZO_COMPLETO_MS 10000  // Sin conectar, se vuelve a llamar a WiFi.begin()
+#define ASOCIACION_PLAZO_VERIFICACION_MS 30000
+#define ASOCIACION_PERIODO_PRUEBA_MS 1000
+#define ASOCIACION_RENOVAR_MS (12UL * 60 * 60 * 1000)
+
+// Largo máximo de un informe de describirAsociacion()
+#define ASOCIACION_LARGO_INFORME 384
+
+struct EstadisticasCamino {
+  uint32_t intentos;
+  uint32_t exitos;
+  uint32_t msUltima;   // De WiFi.begin() a conectado (con IP)
+  uint32_t msMinima;
+  uint32_t msMaxima;
+  uint64_t msTotal;
+};
+
+struct EstadisticasAsociacion {
+  EstadisticasCamino rapida;
+  EstadisticasCamino completa;
+  uint32_t escriturasNvs;
+  uint32_t ipsDescartadas;  // La red no respondió con la IP fija
+  uint32_t renovaciones;    // Asociaciones para renovar la IP por DHCP
+};
+
+// Carga lo guardado. Llamar una vez en setup().
+void iniciarAsociacion();
+
+// Empieza a asociarse (WiFi.begin()): rápida si hay datos guardados de esa
+// red, completa si no. No bloquea.
+void empezarAsociacion(const char* ssid, const char* clave);
+
+// Lo que hay que esperar al intento en curso antes de darlo por fallido
+uint32_t plazoAsociacion();
+
+// El intento en curso conectó: cuenta su tiempo y, si la IP vino del DHCP,
+// guarda el AP y la IP
+void asociacionLograda();
+
+// El intento en curso no conectó a tiempo. Si era el rápido, lo guardado
+// se descarta y el próximo es completo.
+void asociacionFallida();
+
+// Algo de afuera respondió con la IP actual (conectó el broker o se
+// publicó un lote)
+void redAlcanzada();
+
+// Llamar seguido con WiFi conectado: con la IP fija, prueba la puerta de
+// enlace. Devuelve false si hay que volver a asociarse ya, pidiendo la IP
+// por DHCP: la IP fija no se verificó a tiempo o toca renovarla.
+bool asociacionVigente();
+
+const EstadisticasAsociacion& estadisticasAsociacion();
+
+// Estadísticas en JSON (GET /api/wifi). Devuelve el largo.
+size_t describirAsociacion(char* destino, size_t largo);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+// Aplicación de deltas binarios de firmware (los genera
+// scripts/preparar_ota.py). El delta describe la imagen nueva como una
+// secuencia de operaciones sobre la imagen que está corriendo:
+//
+//   "PDL1"  tamaño final (u32)
+//   'C' origen (u32) largo (u32)      copiar de la imagen actual
+//   'A' largo (u32) bytes...          agregar bytes nuevos
+//   'F'                               fin
+//
+// Todos los enteros van en little endian. El aplicador recibe el delta en
+// pedazos de cualquier tamaño (tal como salen del descompresor) y no
+// necesita tenerlo entero en memoria. No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DELTA_MAGICO "PDL1"
+#define DELTA_BLOQUE_COPIA 512  // Bytes que se copian de la imagen actual por vez
+
+// Lee 'largo' bytes de la imagen actual desde 'origen'. Devuelve false si falla.
+typedef bool (*LeerBaseDelta)(uint32_t origen, uint8_t* destino, size_t largo, void* contexto);
+// Escribe bytes de la imagen nueva, en orden. Devuelve false si falla.
+typedef bool (*EscribirDelta)(const uint8_t* datos, size_t largo, void* contexto);
+
+enum EstadoDelta : uint8_t {
+  DELTA_ENCABEZADO,
+  DELTA_OPERACION,
+  DELTA_ARGUMENTOS,
+  DELTA_AGREGANDO,
+  DELTA_TERMINADO,
+  DELTA_ERROR,
+};
+
+struct AplicadorDelta {
+  LeerBaseDelta leerBase;
+  EscribirDelta escribir;
+  void* contexto;
+  uint32_t tamanoBase;   // Para validar las copias
+
+  EstadoDelta estado;
+  uint8_t operacion;
+  uint8_t acumulado[8];  // Encabezado o argumentos a medio llegar
+  uint8_t cantidadAcumulada;
+  uint32_t restante;     // Bytes que faltan de un 'A'
+  uint32_t tamanoFinal;
+  uint32_t escritos;
+};
+
+void iniciarDelta(AplicadorDelta* delta, LeerBaseDelta leerBase, EscribirDelta escribir,
+                  void* contexto, uint32_t tamanoBase);
+
+// Procesa el siguiente pedazo del delta. Devuelve false ante un delta
+// inválido o si falla la lectura/escritura.
+bool agregarDelta(AplicadorDelta* delta, const uint8_t* datos, size_t largo);
+
+// true si llegó la 'F' y se escribió exactamente el tamaño anunciado
+bool deltaCompleto(const AplicadorDelta& delta);
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef ESQUEMA_H
+#define ESQUEMA_H
+
+// Esquema de la telemetría que se publica en pool/metrics.
+//
+// Es la única definición de los campos: el firmware, el decodificador de la
+// PC (src/esquema) y el simulador de Python (lecture-simulator/esquema_pileta.py,
+// generado a partir de esta tabla) salen de acá. Para agregar o cambiar un
+// campo se toca CAMPOS_MEDICION y se regenera el módulo de Python.
+//
+// Los valores numéricos viajan en punto fijo: un pH de 7.42 con 2 decimales
+// se guarda como 742. Así el formato de cada campo se resuelve al compilar y
+// no hace falta printf de floats.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <utility>
+
+#define ESQUEMA_VERSION 1
+
+enum TipoCampo : uint8_t {
+  CAMPO_NUMERO,  // Entero en punto fijo con 'decimales' decimales
+  CAMPO_TEXTO,   // Texto ASCII sin comillas ni barras, hasta 'largoMaximo'
+};
+
+struct Campo {
+  const char* nombre;
+  TipoCampo tipo;
+  uint8_t decimales;
+  int64_t minimo;       // Rango del valor ya escalado (solo CAMPO_NUMERO)
+  int64_t maximo;
+  uint8_t largoMaximo;  // Solo CAMPO_TEXTO
+};
+
+// Índices de CAMPOS_MEDICION, en el mismo orden
+enum IndiceCampo : uint8_t {
+  CAMPO_PH,
+  CAMPO_TEMPERATURA,
+  CAMPO_TDS,
+  CAMPO_TENDENCIA,
+  CAMPO_VALOR_TENDENCIA,
+  CAMPO_TIMESTAMP,
+  CAMPO_ID_DISPOSITIVO,
+  CANTIDAD_CAMPOS
+};
+
+constexpr Campo CAMPOS_MEDICION[CANTIDAD_CAMPOS] = {
+  {"ph",            CAMPO_NUMERO, 2, 0,    1400,        0},
+  {"temperature_c", CAMPO_NUMERO, 1, -100, 600,         0},
+  {"tds_ppm",       CAMPO_NUMERO, 0, 0,    3000,        0},
+  {"trend",         CAMPO_TEXTO,  0, 0,    0,           8},
+  {"trend_value",   CAMPO_NUMERO, 0, -1,   1,           0},
+  {"timestamp",     CAMPO_NUMERO, 0, 0,    4294967295LL, 0},  // Unix, en segundos
+  {"device_id",     CAMPO_TEXTO,  0, 0,    0,           32},
+};
+
+// Valores posibles de "trend"
+#define TENDENCIA_SUBIENDO "subiendo"
+#define TENDENCIA_ESTABLE "estable"
+#define TENDENCIA_BAJANDO "bajando"
+
+// Una medición lista para codificar. Los textos apuntan a memoria del que
+// arma la medición (en el decodificador, al buffer que se le pasa).
+struct Medicion {
+  int64_t numeros[CANTIDAD_CAMPOS];
+  const char* textos[CANTIDAD_CAMPOS];
+};
+
+// ---------------------------------------------------------------------------
+// Cálculos en tiempo de compilación
+
+constexpr size_t largoTexto(const char* texto) {
+  return *texto == '\0' ? 0 : 1 + largoTexto(texto + 1);
+}
+
+constexpr int64_t potenciaDeDiez(uint8_t exponente) {
+  return exponente == 0 ? 1 : 10 * potenciaDeDiez(exponente - 1);
+}
+
+constexpr size_t cantidadDigitos(uint64_t valor) {
+  return valor < 10 ? 1 : 1 + cantidadDigitos(valor / 10);
+}
+
+constexpr uint64_t valorAbsoluto(int64_t valor) {
+  return valor < 0 ? (uint64_t)(-valor) : (uint64_t)valor;
+}
+
+// Caracteres que puede ocupar el valor de un campo en JSON
+constexpr size_t largoMaximoValorJson(const Campo& campo) {
+  if (campo.tipo == CAMPO_TEXTO) return campo.largoMaximo + 2;  // Comillas
+
+  uint64_t mayor = valorAbsoluto(campo.minimo) > valorAbsoluto(campo.maximo)
+                       ? valorAbsoluto(campo.minimo) : valorAbsoluto(campo.maximo);
+  size_t digitos = cantidadDigitos(mayor);
+  if (digitos <= campo.decimales) digitos = campo.decimales + 1;  // "0.05"
+  return (campo.minimo < 0 ? 1 : 0) + digitos + (campo.decimales > 0 ? 1 : 0);
+}
+
+// Bytes que ocupa un campo numérico en binario: se guarda valor - minimo
+// en la menor cantidad de bytes que cubre el rango
+constexpr size_t bytesCampoBinario(const Campo& campo) {
+  if (campo.tipo == CAMPO_TEXTO) return 1 + campo.largoMaximo;  // Largo + texto
+
+  uint64_t rango = (uint64_t)(campo.maximo - campo.minimo);
+  size_t bytes = 1;
+  while (bytes < 8 && (rango >> (8 * bytes)) != 0) bytes++;
+  return bytes;
+}
+
+constexpr size_t calcularTamanoJson() {
+  size_t total = 2;  // {}
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    // "nombre": valor, (la coma sobra en el último pero cubre el \0 final)
+    total += largoTexto(CAMPOS_MEDICION[i].nombre) + 3 + largoMaximoValorJson(CAMPOS_MEDICION[i]) + 1;
+  }
+  return total;
+}
+
+constexpr size_t calcularTamanoBinario() {
+  size_t total = 1;  // Versión
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) total += bytesCampoBinario(CAMPOS_MEDICION[i]);
+  return total;
+}
+
+constexpr size_t calcularTamanoTextos() {
+  size_t total = 0;
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (CAMPOS_MEDICION[i].tipo == CAMPO_TEXTO) total += CAMPOS_MEDICION[i].largoMaximo + 1;
+  }
+  return total;
+}
+
+// Peor caso de cada codificación, incluido el \0 del JSON
+constexpr size_t TAMANO_MAXIMO_JSON = calcularTamanoJson();
+constexpr size_t TAMANO_MAXIMO_BINARIO = calcularTamanoBinario();
+
+// Buffer que necesita el decodificador para guardar los textos
+constexpr size_t TAMANO_TEXTOS_MEDICION = calcularTamanoTextos();
+
+// ---------------------------------------------------------------------------
+// Armado de mediciones
+
+// Convierte un valor real al punto fijo del campo, redondeando y
+// recortando al rango del esquema
+inline void fijarNumero(Medicion* medicion, IndiceCampo indice, double valor) {
+  const Campo& campo = CAMPOS_MEDICION[indice];
+  double escalado = valor * potenciaDeDiez(campo.decimales);
+  int64_t entero = (int64_t)(escalado < 0 ? escalado - 0.5 : escalado + 0.5);
+  if (entero < campo.minimo) entero = campo.minimo;
+  if (entero > campo.maximo) entero = campo.maximo;
+  medicion->numeros[indice] = entero;
+}
+
+inline double leerNumero(const Medicion& medicion, IndiceCampo indice) {
+  return (double)medicion.numeros[indice] / potenciaDeDiez(CAMPOS_MEDICION[indice].decimales);
+}
+
+// ---------------------------------------------------------------------------
+// Codificadores. Se generan campo por campo con plantillas: el nombre, la
+// cantidad de decimales y el ancho binario de cada campo son constantes.
+
+namespace esquema_detalle {
+
+// Escribe un entero en punto fijo con DECIMALES decimales; devuelve el largo
+template <uint8_t DECIMALES>
+inline size_t escribirFijo(char* destino, int64_t valor) {
+  char digitos[24];
+  size_t cantidad = 0;
+  uint64_t resto = valorAbsoluto(valor);
+
+  do {
+    digitos[cantidad++] = '0' + (resto % 10);
+    resto /= 10;
+  } while (resto != 0 || cantidad <= DECIMALES);
+
+  size_t largo = 0;
+  if (valor < 0) destino[largo++] = '-';
+  while (cantidad > 0) {
+    if (DECIMALES > 0 && cantidad == DECIMALES) destino[largo++] = '.';
+    destino[largo++] = digitos[--cantidad];
+  }
+  return largo;
+}
+
+template <size_t I>
+inline size_t codificarCampoJson(const Medicion& medicion, char* destino) {
+  constexpr const Campo& campo = CAMPOS_MEDICION[I];
+  constexpr size_t largoNombre = largoTexto(campo.nombre);
+
+  size_t largo = 0;
+  if (I > 0) destino[largo++] = ',';
+  destino[largo++] = '"';
+  memcpy(destino + largo, campo.nombre, largoNombre);
+  largo += largoNombre;
+  destino[largo++] = '"';
+  destino[largo++] = ':';
+
+  if constexpr (campo.tipo == CAMPO_TEXTO) {
+    const char* texto = medicion.textos[I] != nullptr ? medicion.textos[I] : "";
+    size_t largoValor = strnlen(texto, campo.largoMaximo);
+    destino[largo++] = '"';
+    memcpy(destino + largo, texto, largoValor);
+    largo += largoValor;
+    destino[largo++] = '"';
+  } else {
+    largo += escribirFijo<campo.decimales>(destino + largo, medicion.numeros[I]);
+  }
+  return largo;
+}
+
+template <size_t I>
+inline size_t codificarCampoBinario(const Medicion& medicion, uint8_t* destino) {
+  constexpr const Campo& campo = CAMPOS_MEDICION[I];
+
+  if constexpr (campo.tipo == CAMPO_TEXTO) {
+    const char* texto = medicion.textos[I] != nullptr ? medicion.textos[I] : "";
+    size_t largo = strnlen(texto, campo.largoMaximo);
+    destino[0] = (uint8_t)largo;
+    memcpy(destino + 1, texto, largo);
+    return 1 + largo;
+  } else {
+    constexpr size_t bytes = bytesCampoBinario(campo);
+    uint64_t desplazado = (uint64_t)(medicion.numeros[I] - campo.minimo);
+    for (size_t b = 0; b < bytes; b++) destino[b] = (uint8_t)(desplazado >> (8 * b));
+    return bytes;
+  }
+}
+
+template <size_t... I>
+inline size_t codificarJson(const Medicion& medicion, char* destino, std::index_sequence<I...>) {
+  size_t largo = 1;
+  destino[0] = '{';
+  ((largo += codificarCampoJson<I>(medicion, destino + largo)), ...);
+  destino[largo++] = '}';
+  destino[largo] = '\0';
+  return largo;
+}
+
+template <size_t... I>
+inline size_t codificarBinario(const Medicion& medicion, uint8_t* destino, std::index_sequence<I...>) {
+  size_t largo = 1;
+  destino[0] = ESQUEMA_VERSION;
+  ((largo += codificarCampoBinario<I>(medicion, destino + largo)), ...);
+  return largo;
+}
+
+}  // namespace esquema_detalle
+
+// Escribe la medición como JSON (terminado en \0) en un buffer de al menos
+// TAMANO_MAXIMO_JSON bytes. Devuelve el largo sin el \0.
+inline size_t codificarJson(const Medicion& medicion, char* destino) {
+  return esquema_detalle::codificarJson(medicion, destino, std::make_index_sequence<CANTIDAD_CAMPOS>());
+}
+
+// Escribe la medición en binario en un buffer de al menos
+// TAMANO_MAXIMO_BINARIO bytes. Devuelve el largo.
+inline size_t codificarBinario(const Medicion& medicion, uint8_t* destino) {
+  return esquema_detalle::codificarBinario(medicion, destino, std::make_index_sequence<CANTIDAD_CAMPOS>());
+}
+
+// ---------------------------------------------------------------------------
+// Decodificadores (src/esquema.cpp). Los textos se copian a 'textos', que
+// debe tener TAMANO_TEXTOS_MEDICION bytes. Devuelven false si el mensaje no
+// respeta el esquema.
+
+bool decodificarJson(const char* json, size_t largo, Medicion* medicion, char* textos);
+bool decodificarBinario(const uint8_t* datos, size_t largo, Medicion* medicion, char* textos);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef EZO_H
+#define EZO_H
+
+// Lectura de respuestas de los circuitos Atlas Scientific EZO sin usar heap.
+//
+// Las respuestas llegan byte a byte por la UART y terminan en '\r'. El lector
+// las arma en un buffer fijo y, al completar la línea, la clasifica y, si es
+// un número, lo deja en punto fijo (milésimas) sin pasar por float ni String.
+// No depende de Arduino: lo usan el firmware, sensores.cpp y el replay.
+//
+// ColaEzo pasa las líneas completas de la tarea que recibe de la UART a
+// loop() (ver uart_ezo.h).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define EZO_LARGO_MAXIMO 31   // Las respuestas del EZO-pH no pasan de ~15 bytes
+#define EZO_DECIMALES 3       // Los valores se guardan en milésimas
+#define EZO_CAPACIDAD_COLA 16 // Líneas sin leer; potencia de 2
+
+enum TipoRespuestaEzo : uint8_t {
+  EZO_INCOMPLETA,   // Todavía no llegó el '\r'
+  EZO_VALOR,        // Número (se toma el primero si vienen varios separados por coma)
+  EZO_OK,           // *OK  comando aceptado
+  EZO_ER,           // *ER  comando desconocido o mal formado
+  EZO_OV,           // *OV  sobretensión
+  EZO_UV,           // *UV  subtensión
+  EZO_RS,           // *RS  se reinició
+  EZO_OTRO_ESTADO,  // Otro código *XX (*RE, *SL, *WA, *DONE...)
+  EZO_MALFORMADA,   // Línea vacía, con basura o número inválido
+  EZO_DESBORDE,     // Línea más larga que el buffer
+};
+
+struct LectorEzo {
+  char linea[EZO_LARGO_MAXIMO + 1];  // Última línea completa, terminada en \0
+  uint8_t largo;
+  bool desbordado;
+  bool conBasura;                    // Llegó algún byte no imprimible
+  int32_t valor;                     // Para EZO_VALOR, en milésimas
+};
+
+void reiniciarLectorEzo(LectorEzo* lector);
+
+// Agrega un byte recibido. Devuelve EZO_INCOMPLETA mientras la línea no
+// termine; al llegar el '\r' devuelve la clasificación y la línea queda en
+// lector->linea hasta el próximo byte.
+TipoRespuestaEzo agregarByteEzo(LectorEzo* lector, uint8_t byte);
+
+// Clasifica una línea ya completa (sin el '\r'). Si es un valor lo deja en
+// *valor, en milésimas. Ignora espacios al principio y al final.
+TipoRespuestaEzo clasificarLineaEzo(const char* linea, size_t largo, int32_t* valor);
+
+struct LineaEzo {
+  uint32_t ms;                       // Cuándo terminó de llegar
+  TipoRespuestaEzo tipo;
+  int32_t valor;                     // Para EZO_VALOR, en milésimas
+  char linea[EZO_LARGO_MAXIMO + 1];
+};
+
+// Cola sin locks de un productor y un consumidor. Cada lado solo escribe su
+// contador; con la cola llena la línea nueva se descarta y se cuenta.
+struct ColaEzo {
+  LineaEzo lineas[EZO_CAPACIDAD_COLA];
+  std::atomic<uint32_t> escritas;
+  std::atomic<uint32_t> leidas;
+  std::atomic<uint32_t> descartadas;
+};
+
+// Solo sin el productor andando
+void reiniciarColaEzo(ColaEzo* cola);
+
+// Productor. Devuelve false si la cola estaba llena.
+bool encolarEzo(ColaEzo* cola, const LineaEzo& linea);
+
+// Consumidor. Devuelve false si no hay nada.
+bool desencolarEzo(ColaEzo* cola, LineaEzo* linea);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef GZIP_H
+#define GZIP_H
+
+// Compresión gzip chica para los cuerpos que se mandan por HTTP (ver
+// salida_influx.h). Es deflate con un solo bloque de códigos Huffman fijos
+// y LZ77 con una tabla hash de GZIP_BITS_HASH bits: no llega a lo que
+// comprime zlib, pero en el protocolo de líneas casi todo es el prefijo
+// y los nombres de los campos repetidos, que es justo lo que encuentra.
+// Usa unos pocos KB de pila en vez de los ~160 KB del tdefl de la ROM.
+// No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GZIP_BITS_HASH 10
+#define GZIP_LARGO_MAXIMO 65535  // Las posiciones de la tabla hash son de 16 bits
+
+// Comprime 'largo' bytes de 'datos' en 'destino' (encabezado y cola gzip
+// incluidos). Devuelve el largo comprimido, o 0 si no entra en 'capacidad'
+// o si 'largo' pasa GZIP_LARGO_MAXIMO.
+size_t comprimirGzip(const uint8_t* datos, size_t largo, uint8_t* destino, size_t capacidad);
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef HISTORIAL_H
+#define HISTORIAL_H
+
+// Historial en RAM de tamaño fijo, para ver tendencias desde el propio
+// equipo sin el stack de docker:
+//
+//   - el promedio de cada minuto de las últimas HISTORIAL_MINUTOS / 60
+//     horas: la hora en curso tal cual y cada hora cerrada como una serie
+//     comprimida (serie.h) en un anillo de HISTORIAL_BYTES_SERIES bytes
+//   - un anillo de HISTORIAL_HORAS horas con el promedio de cada hora, que
+//     se arma al cerrar cada hora y cubre lo que ya salió del primero
+//
+// Los valores se guardan cuantizados con los decimales del esquema (pH en
+// centésimas, temperatura en décimas, TDS en ppm), en 6 bytes por punto sin
+// comprimir. Un campo rechazado (el sensor no dio un valor válido y quedó
+// el anterior) no se suma: el promedio de cada campo es de sus lecturas
+// válidas, y un campo sin ninguna queda vacío. Con los valores quietos, un minuto comprimido ocupa unos 2
+// bytes; si el agua cambia tanto que las series no entran, se pierden los
+// minutos de las horas más viejas antes de tiempo (las horas quedan). El
+// tiempo es el mismo timestamp que se publica; un salto hacia atrás (p. ej.
+// al sincronizar la hora) vacía el historial. No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esquema.h"
+
+#ifndef HISTORIAL_MINUTOS
+#define HISTORIAL_MINUTOS (24 * 60)
+#endif
+
+#ifndef HISTORIAL_HORAS
+#define HISTORIAL_HORAS (7 * 24)
+#endif
+
+// Una hora de minutos comprimida ocupa unos 150 bytes con la pileta quieta
+#ifndef HISTORIAL_BYTES_SERIES
+#define HISTORIAL_BYTES_SERIES 6144
+#endif
+
+#define HISTORIAL_BLOQUES (HISTORIAL_MINUTOS / 60)  // Horas cerradas con sus minutos
+
+static_assert(HISTORIAL_BYTES_SERIES <= UINT16_MAX, "Las series se ubican con 16 bits");
+
+#define HISTORIAL_VACIO INT16_MIN  // Campo de un punto sin datos
+
+// Campos que se guardan, en el orden de Lectura::rechazadas
+constexpr IndiceCampo CAMPOS_HISTORIAL[] = {CAMPO_PH, CAMPO_TEMPERATURA, CAMPO_TDS};
+constexpr size_t CANTIDAD_CAMPOS_HISTORIAL = sizeof(CAMPOS_HISTORIAL) / sizeof(CAMPOS_HISTORIAL[0]);
+
+struct PuntoGuardado {
+  int16_t valores[CANTIDAD_CAMPOS_HISTORIAL];  // HISTORIAL_VACIO: sin datos
+};
+
+// Los minutos de una hora cerrada, en 'series'
+struct BloqueHora {
+  uint32_t hora;    // timestamp / 3600
+  uint16_t inicio;
+  uint16_t largo;   // 0: sin serie (la hora no tuvo datos o ya se pisó)
+};
+
+struct Historial {
+  PuntoGuardado minutos[60];                // Los de la hora en curso
+  uint8_t series[HISTORIAL_BYTES_SERIES];   // Anillo de series, una por hora cerrada
+  BloqueHora bloques[HISTORIAL_BLOQUES];    // Por hora % HISTORIAL_BLOQUES
+  uint16_t escritura;                       // Donde empieza la próxima serie
+  uint32_t primeraHoraMinutos;              // La hora más vieja con minutos guardados
+  PuntoGuardado horas[HISTORIAL_HORAS];
+  uint32_t ultimoMinuto;  // Minuto (timestamp / 60) de la última medición
+  bool hayDatos;
+
+  // Acumulado del minuto en curso, por campo
+  int32_t sumas[CANTIDAD_CAMPOS_HISTORIAL];
+  uint16_t muestras[CANTIDAD_CAMPOS_HISTORIAL];
+};
+
+constexpr size_t TAMANO_HISTORIAL = sizeof(Historial);
+
+void iniciarHistorial(Historial* historial);
+
+// Suma una medición al minuto que le corresponde. 'rechazadas' tiene un
+// bit por campo de CAMPOS_HISTORIAL, en ese orden: esos campos no se suman.
+void registrarHistorial(Historial* historial, const Medicion& medicion, uint8_t rechazadas);
+
+// Un punto de la consulta: promedio de los datos entre 'timestamp' y
+// timestamp + paso. Los valores van en punto fijo, con los decimales del
+// esquema, en el orden de CAMPOS_HISTORIAL; HISTORIAL_VACIO si ese campo no
+// tuvo datos en el tramo.
+struct PuntoHistorial {
+  uint32_t timestamp;
+  uint32_t paso;  // Puede ser mayor al pedido donde solo quedan horas
+  int32_t valores[CANTIDAD_CAMPOS_HISTORIAL];
+};
+
+struct ConsultaHistorial {
+  const Historial* historial;
+  uint32_t siguiente;
+  uint32_t hasta;
+  uint32_t paso;
+
+  // Los minutos de la última hora cerrada que se descomprimió
+  PuntoGuardado minutos[60];
+  uint32_t horaDescomprimida;
+  bool hayDescomprimida;
+};
+
+// Consulta [desde, hasta) de a 'paso' segundos (se redondea a minutos).
+// Los tramos sin datos en ningún campo se saltean.
+void iniciarConsulta(ConsultaHistorial* consulta, const Historial* historial, uint32_t desde,
+                     uint32_t hasta, uint32_t paso);
+bool siguientePunto(ConsultaHistorial* consulta, PuntoHistorial* punto);
+
+#endif
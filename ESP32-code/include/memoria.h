@@ -0,0 +1,60 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+// Uso del heap. Fuera de setup() el firmware no pide memoria para medir ni
+// publicar: los buffers son de tamaño fijo. Lo que queda son las
+// bibliotecas de Arduino al atender la web, conectar o actualizar.
+//
+// Con -DMEMORIA_ESTATICA=1 se cuenta cada malloc(), calloc(), realloc() y
+// new de la tarea de loop(), por tarea del planificador (planificador.h):
+// lo de setup() aparte y lo de después, a nombre de la tarea que estaba
+// corriendo. Las otras tareas de FreeRTOS (WiFi, lwIP, el registro) no se
+// cuentan. Con -DMEMORIA_ESTATICA=2 además se corta (abort(), con su
+// backtrace por el puerto serie) si pide memoria una tarea marcada con
+// prohibirAsignaciones().
+//
+// Los dos modos necesitan que el linker envuelva las funciones del heap
+// (-Wl,--wrap=malloc,...): ver el env esp32dev_estatica.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "planificador.h"
+
+#ifndef MEMORIA_ESTATICA
+#define MEMORIA_ESTATICA 0
+#endif
+
+// Largo máximo de un informe de describirMemoria()
+#define MEMORIA_LARGO_INFORME (160 + PLANIFICADOR_MAXIMO_TAREAS * 64)
+
+struct AsignacionesMemoria {
+  uint32_t cantidad;
+  uint32_t bytes;
+};
+
+struct EstadoHeap {
+  uint32_t libre;
+  uint32_t minimoLibre;    // Desde el arranque
+  uint32_t bloqueMaximo;   // El malloc() más grande que entraría ahora
+};
+
+// Al empezar setup(), desde la tarea de loop(): desde acá se cuenta
+void iniciarMemoria(const Planificador* planificador);
+
+// Al terminar setup(): lo que sigue ya es el régimen normal
+void terminarSetupMemoria();
+
+// Con MEMORIA_ESTATICA=2, pedir memoria desde esta tarea corta el programa
+void prohibirAsignaciones(int tarea);
+
+EstadoHeap estadoHeap();
+
+// Lo de setup(), y lo de después fuera de las tareas (en loop() mismo)
+AsignacionesMemoria asignacionesSetup();
+AsignacionesMemoria asignacionesFueraDeTareas();
+AsignacionesMemoria asignacionesTarea(int tarea);
+
+// Heap y asignaciones por tarea en JSON (GET /api/memory). Devuelve el largo.
+size_t describirMemoria(char* destino, size_t largo);
+
+#endif
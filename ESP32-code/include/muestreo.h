@@ -0,0 +1,83 @@
+#ifndef MUESTREO_H
+#define MUESTREO_H
+
+// Intervalo de muestreo adaptivo. Mientras los valores cambian más que la
+// banda muerta o están fuera del rango objetivo (p. ej. mientras se dosifica
+// cloro) se lee cada intervaloRapidoMs. Con los valores quietos el
+// intervalo se duplica en cada lectura hasta intervaloLentoMs.
+//
+// La configuración se cambia en marcha con mensajes "clave=valor" (ver
+// aplicarControlMuestreo) que llegan por pool/<id>/control. No depende de
+// Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensores.h"
+
+// Intervalo rápido; cada env puede cambiarlo con -DINTERVALO_ENVIO_MS
+#ifndef INTERVALO_ENVIO_MS
+#define INTERVALO_ENVIO_MS 5000
+#endif
+
+#ifndef INTERVALO_LENTO_MS
+#define INTERVALO_LENTO_MS (INTERVALO_ENVIO_MS * 12)
+#endif
+
+#define INTERVALO_MINIMO_PERMITIDO_MS 1000
+#define INTERVALO_MAXIMO_PERMITIDO_MS 3600000
+
+// Mediciones que se juntan como máximo en una publicación
+#define LOTE_MAXIMO 8
+
+#define LARGO_MAXIMO_CONTROL 320  // Mensaje de control o descripción de la configuración
+
+struct ConfiguracionMuestreo {
+  uint32_t intervaloRapidoMs;
+  uint32_t intervaloLentoMs;
+
+  // Cambio entre dos lecturas seguidas que se considera movimiento
+  float bandaPh;
+  float bandaTemperatura;
+  float bandaTds;
+
+  // Rango objetivo; fuera de él se muestrea rápido
+  float phMinimo, phMaximo;
+  float temperaturaMinima, temperaturaMaxima;
+  float tdsMinimo, tdsMaximo;
+
+  // Mediciones por publicación con los valores quietos (1 = una por vez).
+  // Cuando algo se mueve se publica enseguida.
+  uint8_t lote;
+};
+
+struct EstadoMuestreo {
+  bool hayAnterior;
+  float ph, temperatura, tds;  // Última lectura
+  uint32_t intervaloMs;
+  bool acelerado;              // La última lectura se movió o salió de rango
+};
+
+ConfiguracionMuestreo configuracionMuestreoInicial();
+
+void iniciarMuestreo(EstadoMuestreo* estado, const ConfiguracionMuestreo& configuracion);
+
+// Registra una lectura y devuelve cuánto esperar hasta la próxima
+uint32_t planificarMuestreo(EstadoMuestreo* estado, const ConfiguracionMuestreo& configuracion,
+                            const Lectura& lectura);
+
+// Aplica un mensaje de control: pares "clave=valor" separados por espacios,
+// comas o saltos de línea, p. ej. "ph_min=7.2 ph_max=7.6 lote=4". Claves:
+//
+//   intervalo_rapido_ms intervalo_lento_ms lote
+//   banda_ph banda_temperatura banda_tds
+//   ph_min ph_max temperatura_min temperatura_max tds_min tds_max
+//
+// Se aplica todo o nada: si una clave no existe o la configuración que
+// queda no es válida devuelve false y no cambia nada.
+bool aplicarControlMuestreo(ConfiguracionMuestreo* configuracion, const char* texto, size_t largo);
+
+// La configuración en el mismo formato que acepta aplicarControlMuestreo.
+// Devuelve el largo sin el \0.
+size_t describirMuestreo(const ConfiguracionMuestreo& configuracion, char* destino, size_t largo);
+
+#endif
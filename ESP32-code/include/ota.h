@@ -0,0 +1,88 @@
+#ifndef OTA_H
+#define OTA_H
+
+// Actualización del firmware por WiFi desde cualquier servidor HTTP (ver
+// scripts/preparar_ota.py). El servidor tiene manifest.txt, la imagen
+// completa comprimida con zlib y opcionalmente un delta comprimido contra
+// la versión que tienen los equipos.
+//
+// La imagen se descomprime (y se arma desde el delta) a medida que llega,
+// directo a la partición OTA libre; nunca está entera en memoria. Update
+// verifica el MD5 antes de cambiar la partición de arranque.
+//
+// La imagen nueva arranca "a prueba": si no llega a publicar una medición
+// dentro de OTA_PLAZO_CONFIRMACION_MS, o se reinicia antes, el bootloader
+// vuelve a la anterior.
+//
+// Todo se firma con una clave compartida que va en el firmware
+// (-DOTA_CLAVE=\"...\"); sin ella no se aceptan actualizaciones. El pedido
+// lleva el HMAC-SHA256 del id del equipo, un desafío de un solo uso que el
+// equipo acaba de dar y el servidor (la clave no viaja por la red, y un
+// pedido visto en la red no se puede repetir). manifest.txt termina en una
+// línea "firma=" con el HMAC-SHA256 de todo lo anterior, que incluye el MD5
+// de la imagen. Solo se instala una versión más nueva que la que corre.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef VERSION_FIRMWARE
+#define VERSION_FIRMWARE "1.0.0"
+#endif
+
+#ifndef OTA_CLAVE
+#define OTA_CLAVE ""
+#endif
+
+#define TOPICO_MQTT_OTA "pool/ota"
+#define OTA_LARGO_VERSION 12     // Con el '\0'
+#define OTA_LARGO_INFORME 224    // JSON del informe, peor caso con device_id de 32
+#define OTA_LARGO_DESAFIO 17     // 16 dígitos hexadecimales y el '\0'
+#define OTA_VIGENCIA_DESAFIO_MS 60000
+
+#define OTA_PLAZO_CONFIRMACION_MS (5UL * 60 * 1000)
+#define OTA_TIMEOUT_DESCARGA_MS 15000  // Sin recibir datos
+#define OTA_BLOQUE_DESCARGA 1024
+
+// Configuración de red que se conserva a través del reinicio de la
+// actualización, para que la imagen nueva pueda conectarse y confirmarse
+// sin pasar por el portal. Vive en la RAM del RTC: se pierde al cortar la
+// alimentación, igual que la configuración del portal.
+struct RedGuardada {
+  char ssid[33];
+  char clave[65];
+  char broker[65];
+  uint16_t puerto;
+};
+
+// true si 'firma' es el HMAC-SHA256 de 'texto' con OTA_CLAVE, en
+// hexadecimal en minúsculas. Sin OTA_CLAVE, siempre false.
+bool firmaOtaValida(const char* texto, size_t largo, const char* firma);
+
+// Da un desafío nuevo en 'destino' (OTA_LARGO_DESAFIO bytes). Vale para un
+// solo pedido, dentro de OTA_VIGENCIA_DESAFIO_MS, y anula el anterior.
+void nuevoDesafioOta(char* destino);
+
+// true si 'firma' es el HMAC-SHA256 de "<idDispositivo>\n<desafío>\n<servidor>"
+// con el desafío vigente. El desafío se gasta aunque la firma no coincida.
+bool pedidoOtaValido(const char* idDispositivo, const char* servidor, const char* firma);
+
+// Baja e instala la versión que anuncia <servidor>/manifest.txt (p. ej.
+// "http://192.168.1.10:8000") y reinicia. Solo vuelve si no hay nada que
+// actualizar (la versión no es más nueva que VERSION_FIRMWARE) o si falló;
+// en ese caso la imagen actual sigue intacta.
+bool actualizarFirmware(const char* servidor, const RedGuardada& red);
+
+// Si el equipo arrancó después de una actualización, copia la red que
+// estaba configurada. Llamar una vez en setup().
+bool recuperarRedGuardada(RedGuardada* red);
+
+// Llamar después de la primera publicación exitosa: da por buena la imagen
+// nueva. Si hay un informe de la última actualización lo deja en 'destino'
+// (JSON para TOPICO_MQTT_OTA) y devuelve true, una sola vez.
+bool confirmarActualizacion(const char* idDispositivo, char* destino, size_t largo);
+
+// Llamar en cada loop(): vuelve a la imagen anterior si la nueva no se
+// confirmó a tiempo.
+void vigilarActualizacion();
+
+#endif
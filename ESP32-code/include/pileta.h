@@ -0,0 +1,1130 @@
+#ifndef PILETA_H
+#define PILETA_H
+
+#include <WiFi.h>
+#include <WebServer.h>
+#include <PubSubClient.h>
+#include <time.h>
+#include <algorithm>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include "anomalias.h"
+#include "arranque.h"
+#include "asociacion.h"
+#include "esquema.h"
+#include "historial.h"
+#include "memoria.h"
+#include "muestreo.h"
+#include "ota.h"
+#include "planificador.h"
+#include "portal.h"
+#include "procesamiento.h"
+#include "prometheus.h"
+#include "registro_uart.h"
+#include "resumen.h"
+#include "salida_influx.h"
+#include "sensores.h"
+#include "serie.h"
+#include "traza.h"
+
+#if MODO_TRAZA == TRAZA_FLASH
+#include <LittleFS.h>
+#endif
+
+// Firmware de la pileta, parametrizado en tiempo de compilación por:
+//
+//   Transporte  cómo se llega al broker MQTT (TransportePlano, TransporteTls)
+//   Sensores    de dónde salen las lecturas (SensoresEzo, SensoresSimulados,
+//               SensoresReplay); atender() corre seguido entre lecturas
+//
+// Cada env de platformio.ini elige una combinación en main.cpp; lo que la
+// combinación no usa no se compila.
+//
+// Con -DSALIDA_INFLUX=1 las mediciones se escriben directo en InfluxDB
+// (salida_influx.h) y no se usa MQTT: sin tópico de control ni informe de
+// actualización por pool/ota (va solo al puerto serie).
+
+#define TOPICO_MQTT "pool/metrics"
+#define TOPICO_MQTT_BINARIO "pool/metrics/bin"
+
+// Publicar además cada medición en binario (ver esquema.h)
+#ifndef PUBLICAR_BINARIO
+#define PUBLICAR_BINARIO 0
+#endif
+
+// Publicar además cada lote como serie comprimida (ver serie.h)
+#define TOPICO_MQTT_SERIE "pool/metrics/serie"
+#ifndef PUBLICAR_SERIE
+#define PUBLICAR_SERIE 0
+#endif
+
+// Resúmenes por ventana (ver resumen.h): uno por minuto y otro cada 15
+// minutos, en su propio tópico. Una ventana de 0 segundos no se publica.
+#define TOPICO_MQTT_RESUMEN "pool/metrics/rollup"
+#ifndef PUBLICAR_RESUMENES
+#define PUBLICAR_RESUMENES !SALIDA_INFLUX
+#endif
+#ifndef RESUMEN_VENTANA_CORTA_S
+#define RESUMEN_VENTANA_CORTA_S 60
+#endif
+#ifndef RESUMEN_VENTANA_LARGA_S
+#define RESUMEN_VENTANA_LARGA_S 900
+#endif
+
+#if SALIDA_INFLUX && (PUBLICAR_BINARIO || PUBLICAR_SERIE || PUBLICAR_RESUMENES)
+#error "PUBLICAR_BINARIO, PUBLICAR_SERIE y PUBLICAR_RESUMENES son tópicos MQTT: no van con SALIDA_INFLUX"
+#endif
+
+// Perfil del arranque (ver arranque.h), una vez por arranque después de la
+// primera publicación
+#define TOPICO_MQTT_ARRANQUE "pool/boot"
+
+// Alertas del detector de anomalías (ver anomalias.h), apenas empieza cada
+// episodio. Con SALIDA_INFLUX solo van al registro.
+#define TOPICO_MQTT_ALERTA "pool/alerts"
+
+// Cualquier hora anterior a esta es el reloj sin sincronizar
+#define HORA_VALIDA_MINIMA 1600000000
+
+// Tópicos propios de cada equipo: pool/<id>/control y pool/<id>/control/estado
+#define LARGO_TOPICO_EQUIPO 64
+
+// Buffer de PubSubClient: el peor caso de lo que se publica o se recibe
+// (payload + tópico + encabezado MQTT)
+constexpr size_t TAMANO_BUFFER_MQTT = std::max({TAMANO_LOTE_JSON + sizeof(TOPICO_MQTT),
+                                                tamanoMaximoSerie(LOTE_MAXIMO) + sizeof(TOPICO_MQTT_SERIE),
+                                                (size_t)LARGO_MAXIMO_CONTROL + LARGO_TOPICO_EQUIPO,
+                                                OTA_LARGO_INFORME + sizeof(TOPICO_MQTT_OTA),
+                                                RESUMEN_LARGO_JSON + sizeof(TOPICO_MQTT_RESUMEN),
+                                                ARRANQUE_LARGO_INFORME + sizeof(TOPICO_MQTT_ARRANQUE),
+                                                ANOMALIA_LARGO_JSON + sizeof(TOPICO_MQTT_ALERTA)}) + 5;
+static_assert(TAMANO_BUFFER_MQTT <= UINT16_MAX, "PubSubClient no admite un buffer tan grande");
+
+// Mediciones por serie en /api/history?format=serie
+#define HISTORIAL_PUNTOS_POR_SERIE 60
+
+#define MAX_INTENTOS_MQTT 5
+#define ESPERA_TRAS_INTENTOS_MS 30000
+
+// Períodos de las tareas de loop() (ver planificador.h). La lectura usa el
+// intervalo del muestreo adaptivo y la publicación se programa cuando hay
+// un lote listo.
+#define PERIODO_WEB_MS 5      // Lo más que espera un pedido al portal o a /api
+#define PERIODO_MQTT_MS 50
+#define PERIODO_DIARIO_MS 200  // Un tramo del diario de InfluxDB por vez
+#define PERIODO_WIFI_MS 500
+#define PERIODO_WIFI_CONECTANDO_MS 50  // Mientras asocia, para no llegar tarde a la IP
+#define PERIODO_NTP_MS 100    // Hasta tener hora: es solo mirar time()
+#define PERIODO_OTA_MS 1000
+#define PERIODO_SENSORES_MS 500
+
+template <class Transporte, class Sensores>
+class Pileta {
+  static_assert(!SALIDA_INFLUX || Transporte::pideBroker, "SALIDA_INFLUX necesita el servidor desde el portal");
+
+ public:
+  Pileta() : server(80), mqttClient(transporte.cliente()) {}
+
+  void setup() {
+    iniciarMemoria(&planificador);
+    Serial.begin(9600);
+    iniciarRegistro();
+    iniciarArranque(&arranque);
+    marcarFase(&arranque, FASE_SETUP, millis());
+
+    transporteListo = transporte.iniciar();
+    marcarFase(&arranque, FASE_TRANSPORTE, millis());
+
+    iniciarAsociacion();
+
+    iniciarProcesamiento(&procesamiento, PUBLICAR_RESUMENES ? RESUMEN_VENTANA_CORTA_S : 0,
+                         PUBLICAR_RESUMENES ? RESUMEN_VENTANA_LARGA_S : 0);
+    REG_INFO("Historial: %u minutos y %u horas en %u bytes", HISTORIAL_MINUTOS, HISTORIAL_HORAS,
+             (unsigned)TAMANO_HISTORIAL);
+
+    muestreo = configuracionMuestreoInicial();
+    iniciarMuestreo(&estadoMuestreo, muestreo);
+    intervaloActual = muestreo.intervaloRapidoMs;
+
+#if !SALIDA_INFLUX
+    snprintf(topicoControl, sizeof(topicoControl), "pool/%s/control", transporte.idDispositivo());
+    snprintf(topicoEstadoControl, sizeof(topicoEstadoControl), "%s/estado", topicoControl);
+    if (!mqttClient.setBufferSize(TAMANO_BUFFER_MQTT)) {
+      REG_ERROR("No hay memoria para el buffer de MQTT");
+    }
+    mqttClient.setCallback([this](char* topico, uint8_t* datos, unsigned int largo) {
+      recibirControl(topico, datos, largo);
+    });
+#endif
+
+    // Inicia punto de acceso
+    WiFi.softAP("ESP32_Config", "12345678");
+    REG_INFO("Punto de acceso iniciado: SSID=ESP32_Config, PASS=12345678");
+
+    // Configurar servidor web
+    server.on("/", [this]() { handleRoot(); });
+    server.on("/guardar", HTTP_POST, [this]() { handleSave(); });
+    server.on("/actualizar", HTTP_GET, [this]() { handleDesafioOta(); });
+    server.on("/actualizar", HTTP_POST, [this]() { handleActualizar(); });
+    server.on("/api/history", HTTP_GET, [this]() { handleHistorial(); });
+    server.on("/api/scheduler", HTTP_GET, [this]() { handlePlanificador(); });
+#if SALIDA_INFLUX
+    server.on("/api/influx", HTTP_GET, [this]() { handleInflux(); });
+#endif
+#if MODO_TRAZA == TRAZA_FLASH
+    server.on("/traza", [this]() { handleTraza(); });
+#endif
+    server.on("/api/boot", HTTP_GET, [this]() { handleArranque(); });
+    server.on("/api/wifi", HTTP_GET, [this]() { handleWiFi(); });
+    server.on("/api/log", HTTP_GET, [this]() { handleRegistro(); });
+    server.on("/api/anomalies", HTTP_GET, [this]() { handleAnomalias(); });
+    server.on("/api/memory", HTTP_GET, [this]() { handleMemoria(); });
+    server.on("/metrics", HTTP_GET, [this]() { handleMetricas(); });
+#if REGISTRO_FLASH
+    server.on("/registro", [this]() { handleRegistroFlash(); });
+#endif
+    server.begin();
+    REG_INFO("Servidor web iniciado");
+    marcarFase(&arranque, FASE_PORTAL, millis());
+
+    iniciarPlanificador(&planificador, []() -> uint32_t { return millis(); });
+    tareaWeb = agregarTarea(&planificador, "web", [](void* p) { ((Pileta*)p)->server.handleClient(); }, this,
+                            PERIODO_WEB_MS, 20);
+    tareaWifi = agregarTarea(&planificador, "wifi", [](void* p) { ((Pileta*)p)->vigilarWiFi(); }, this,
+                             PERIODO_WIFI_MS, 20);
+    tareaNtp = agregarTarea(&planificador, "ntp", [](void* p) { ((Pileta*)p)->esperarHora(); }, this,
+                            PERIODO_NTP_MS, 5);
+#if SALIDA_INFLUX
+    tareaSalida = agregarTarea(&planificador, "diario", [](void* p) { ((Pileta*)p)->vaciarDiario(); }, this,
+                               PERIODO_DIARIO_MS, 500);
+#else
+    tareaSalida = agregarTarea(&planificador, "mqtt", [](void* p) { ((Pileta*)p)->atenderMqtt(); }, this,
+                               PERIODO_MQTT_MS, 100);
+#endif
+    tareaLectura = agregarTarea(&planificador, "lectura", [](void* p) { ((Pileta*)p)->leerSensores(); }, this,
+                                intervaloActual, 2000);
+    tareaSensores = agregarTarea(&planificador, "sensores", [](void* p) { ((Pileta*)p)->sensores.atender(); },
+                                 this, PERIODO_SENSORES_MS, 20);
+    tareaPublicar = agregarTarea(&planificador, "publicar", [](void* p) { ((Pileta*)p)->publicarLote(); }, this,
+                                 0, 500);
+    tareaOta = agregarTarea(&planificador, "ota", [](void* p) { ((Pileta*)p)->atenderOta(); }, this,
+                            PERIODO_OTA_MS, 0);
+    programarTarea(&planificador, tareaWeb, 0);
+    programarTarea(&planificador, tareaOta, 0);
+
+    // Después de una actualización se sigue con la red que estaba configurada
+    RedGuardada red;
+    if (recuperarRedGuardada(&red)) {
+      redWiFi = red.ssid;
+      claveWiFi = red.clave;
+      servidorMqtt = red.broker;
+      puertoMqtt = red.puerto;
+      empezarConexion();
+      REG_INFO("Configuración recuperada después de la actualización");
+    }
+
+    // Los sensores se inician y se leen mientras WiFi asocia: las lecturas
+    // de antes de poder publicar solo van al historial, y la última sale
+    // apenas hay broker (ver alListaSalida())
+    sensores.iniciar();
+    marcarFase(&arranque, FASE_SENSORES, millis());
+    programarTarea(&planificador, tareaSensores, 0);
+    programarTarea(&planificador, tareaLectura, 0);
+
+    registrarMetricas();
+
+    terminarSetupMemoria();
+    EstadoHeap heap = estadoHeap();
+    REG_INFO("Heap al terminar setup(): %lu bytes libres, bloque máximo %lu", (unsigned long)heap.libre,
+             (unsigned long)heap.bloqueMaximo);
+  }
+
+  void loop() {
+    // Entre tarea y tarea no hay nada que hacer: delay() le deja el
+    // procesador a WiFi y lwIP hasta la próxima
+    uint32_t espera = ejecutarPendientes(&planificador);
+    if (espera > 0) delay(espera);
+  }
+
+ private:
+  void handleRoot() {
+    // Las tres partes salen de flash tal cual, sin armar la página en el heap
+    const char* campos = SALIDA_INFLUX ? PORTAL_CAMPOS_INFLUX : Transporte::camposPortal;
+    server.setContentLength(strlen_P(PORTAL_ANTES) + strlen_P(campos) + strlen_P(PORTAL_DESPUES));
+    server.send(200, "text/html", "");
+    server.sendContent_P(PORTAL_ANTES);
+    server.sendContent_P(campos);
+    server.sendContent_P(PORTAL_DESPUES);
+  }
+
+  void handleSave() {
+    String nuevoSSID = server.arg("ssid");
+    String nuevaClave = server.arg("pass");
+
+    // Validaciones
+    if (nuevoSSID.length() == 0) {
+      server.send(400, "text/html", "<html><body><h2>Error: SSID no puede estar vacío</h2></body></html>");
+      return;
+    }
+
+    if (nuevaClave.length() < 8) {
+      server.send(400, "text/html", "<html><body><h2>Error: Contraseña debe tener al menos 8 caracteres</h2></body></html>");
+      return;
+    }
+
+    if (!transporteListo) {
+      server.send(500, "text/html", "<html><body><h2>Error: el transporte seguro no está configurado</h2></body></html>");
+      return;
+    }
+
+    if constexpr (Transporte::pideBroker) {
+      String nuevoBroker = server.arg("broker");
+      int nuevoPuerto = server.arg("port").toInt();
+
+      if (nuevoBroker.length() == 0) {
+        server.send(400, "text/html", "<html><body><h2>Error: IP del broker no puede estar vacía</h2></body></html>");
+        return;
+      }
+
+      if (nuevoPuerto <= 0 || nuevoPuerto > 65535) {
+        server.send(400, "text/html", "<html><body><h2>Error: Puerto debe ser entre 1 y 65535</h2></body></html>");
+        return;
+      }
+
+      servidorMqtt = nuevoBroker;
+      puertoMqtt = nuevoPuerto;
+    } else {
+      servidorMqtt = transporte.servidor();
+      puertoMqtt = transporte.puerto();
+    }
+
+    // Si todas las validaciones pasan, guardar datos
+    redWiFi = nuevoSSID;
+    claveWiFi = nuevaClave;
+
+    REG_INFO("Datos recibidos y validados: SSID %s, clave de %u caracteres, broker %s:%d", redWiFi.c_str(),
+             (unsigned)claveWiFi.length(), servidorMqtt.c_str(), puertoMqtt);
+
+    server.send(200, "text/html", "<html><body><h2>Datos guardados correctamente. Reiniciando conexión...</h2></body></html>");
+    empezarConexion();
+  }
+
+  // GET /api/history?from=&to=&step= (segundos Unix; por defecto las
+  // últimas 24 horas de a un minuto). Responde en JSON, por partes, sin
+  // armar la respuesta entera en memoria. Con &format=serie manda series
+  // comprimidas en hexadecimal, una por línea (ver serie.h).
+  void handleHistorial() {
+    uint32_t hasta = server.hasArg("to") ? strtoul(server.arg("to").c_str(), nullptr, 10) : tiempoActual() + 1;
+    uint32_t desde = server.hasArg("from") ? strtoul(server.arg("from").c_str(), nullptr, 10)
+                                           : (hasta > 86400 ? hasta - 86400 : 0);
+    uint32_t paso = server.hasArg("step") ? strtoul(server.arg("step").c_str(), nullptr, 10) : 60;
+    if (desde >= hasta || paso == 0) {
+      server.send(400, "text/plain", "Se necesita from < to y step > 0");
+      return;
+    }
+
+    ConsultaHistorial consulta;
+    iniciarConsulta(&consulta, &procesamiento.historial, desde, hasta, paso);
+
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    if (server.arg("format") == "serie") {
+      server.send(200, "text/plain", "");
+      enviarHistorialSerie(&consulta);
+    } else {
+      server.send(200, "application/json", "");
+      enviarHistorialJson(&consulta);
+    }
+    server.sendContent("");
+  }
+
+  void enviarHistorialJson(ConsultaHistorial* consulta) {
+    char bloque[512];
+    size_t largo = snprintf(bloque, sizeof(bloque),
+                            "{\"step\":%lu,\"memory_bytes\":%u,"
+                            "\"columns\":[\"timestamp\",\"step\",\"ph\",\"temperature_c\",\"tds_ppm\"],\"points\":[",
+                            (unsigned long)consulta->paso, (unsigned)TAMANO_HISTORIAL);
+
+    PuntoHistorial punto;
+    bool primero = true;
+    while (siguientePunto(consulta, &punto)) {
+      if (largo > sizeof(bloque) - 64) {
+        server.sendContent(bloque, largo);
+        largo = 0;
+      }
+      // Cada punto con su paso: donde solo quedan horas es más largo que el pedido
+      largo += snprintf(bloque + largo, sizeof(bloque) - largo, "%s[%lu,%lu", primero ? "" : ",",
+                        (unsigned long)punto.timestamp, (unsigned long)punto.paso);
+      for (size_t i = 0; i < CANTIDAD_CAMPOS_HISTORIAL; i++) {
+        // Un campo sin lecturas válidas en el tramo va como null
+        const Campo& campo = CAMPOS_MEDICION[CAMPOS_HISTORIAL[i]];
+        if (punto.valores[i] == HISTORIAL_VACIO) {
+          largo += snprintf(bloque + largo, sizeof(bloque) - largo, ",null");
+        } else {
+          largo += snprintf(bloque + largo, sizeof(bloque) - largo, ",%.*f", campo.decimales,
+                            punto.valores[i] / (double)potenciaDeDiez(campo.decimales));
+        }
+      }
+      largo += snprintf(bloque + largo, sizeof(bloque) - largo, "]");
+      primero = false;
+    }
+    largo += snprintf(bloque + largo, sizeof(bloque) - largo, "]}");
+    server.sendContent(bloque, largo);
+  }
+
+  void enviarHistorialSerie(ConsultaHistorial* consulta) {
+    static uint8_t serie[tamanoMaximoSerie(HISTORIAL_PUNTOS_POR_SERIE)];
+    char hexadecimal[64 + 1];
+    CompresorSerie compresor;
+    PuntoHistorial punto;
+    bool quedan = true;
+
+    while (quedan) {
+      iniciarCompresor(&compresor, serie, sizeof(serie), transporte.idDispositivo());
+      while (compresor.cantidad < HISTORIAL_PUNTOS_POR_SERIE && (quedan = siguientePunto(consulta, &punto))) {
+        // La serie no tiene campos vacíos: esos puntos solo salen en JSON
+        Medicion medicion = {};
+        bool completo = true;
+        for (size_t i = 0; i < CANTIDAD_CAMPOS_HISTORIAL; i++) {
+          completo = completo && punto.valores[i] != HISTORIAL_VACIO;
+          medicion.numeros[CAMPOS_HISTORIAL[i]] = punto.valores[i];
+        }
+        medicion.numeros[CAMPO_TIMESTAMP] = punto.timestamp;
+        if (completo) agregarMedicion(&compresor, medicion);
+      }
+      if (compresor.cantidad == 0) break;
+
+      // De a 32 bytes, para no necesitar otro buffer del doble de tamaño
+      size_t largo = largoSerie(compresor);
+      for (size_t i = 0; i < largo; i += 32) {
+        size_t tramo = largo - i < 32 ? largo - i : 32;
+        for (size_t j = 0; j < tramo; j++) snprintf(hexadecimal + 2 * j, 3, "%02x", serie[i + j]);
+        server.sendContent(hexadecimal, 2 * tramo);
+      }
+      server.sendContent("\n", 1);
+    }
+  }
+
+#if SALIDA_INFLUX
+  // GET /api/influx: escrituras, latencia y diario (ver salida_influx.h)
+  void handleInflux() {
+    char informe[INFLUX_LARGO_INFORME];
+    describirInflux(informe, sizeof(informe));
+    server.send(200, "application/json", informe);
+  }
+#endif
+
+  // GET /actualizar: el desafío para firmar el próximo pedido
+  void handleDesafioOta() {
+    char desafioOta[OTA_LARGO_DESAFIO];
+    nuevoDesafioOta(desafioOta);
+    char respuesta[128];
+    snprintf(respuesta, sizeof(respuesta), "{\"device_id\":\"%s\",\"nonce\":\"%s\",\"expires_ms\":%lu}",
+             transporte.idDispositivo(), desafioOta, (unsigned long)OTA_VIGENCIA_DESAFIO_MS);
+    server.send(200, "application/json", respuesta);
+  }
+
+  void handleActualizar() {
+    // POST servidor=http://<ip>:<puerto>&firma=<HMAC de id, desafío y
+    // servidor>: lo arma preparar_ota.py --equipo
+    String servidor = server.arg("servidor");
+    if (sizeof(OTA_CLAVE) <= 1) {
+      server.send(403, "text/plain", "Actualizaciones deshabilitadas: falta -DOTA_CLAVE al compilar");
+      return;
+    }
+    if (!servidor.startsWith("http://")) {
+      server.send(400, "text/plain", "Falta servidor=http://<ip>:<puerto>");
+      return;
+    }
+    if (!pedidoOtaValido(transporte.idDispositivo(), servidor.c_str(), server.arg("firma").c_str())) {
+      REG_AVISO("Pedido de actualización con firma inválida desde %s",
+                server.client().remoteIP().toString().c_str());
+      server.send(401, "text/plain", "Firma inválida");
+      return;
+    }
+    if (!configuracionRecibida) {
+      server.send(409, "text/plain", "Primero hay que configurar la red");
+      return;
+    }
+
+    servidorOta = servidor;
+    programarTarea(&planificador, tareaOta, 0);
+    server.send(202, "text/plain", "Actualización pedida a " + servidor + ", ver el puerto serie y " TOPICO_MQTT_OTA);
+  }
+
+  void actualizar() {
+    RedGuardada red;
+    if (redWiFi.length() >= sizeof(red.ssid) || claveWiFi.length() >= sizeof(red.clave) ||
+        servidorMqtt.length() >= sizeof(red.broker)) {
+      REG_ERROR("OTA: la configuración de red no entra en la RAM del RTC");
+      return;
+    }
+    strcpy(red.ssid, redWiFi.c_str());
+    strcpy(red.clave, claveWiFi.c_str());
+    strcpy(red.broker, servidorMqtt.c_str());
+    red.puerto = puertoMqtt;
+
+    mqttClient.disconnect();
+    actualizarFirmware(servidorOta.c_str(), red);
+  }
+
+#if MODO_TRAZA == TRAZA_FLASH
+  void handleTraza() {
+    // GET descarga la traza grabada; ?borrar=1 la elimina para empezar otra
+    if (server.hasArg("borrar")) {
+      LittleFS.remove(TRAZA_ARCHIVO);
+      server.send(200, "text/plain", "Traza borrada");
+      return;
+    }
+
+    File archivo = LittleFS.open(TRAZA_ARCHIVO, "r");
+    if (!archivo) {
+      server.send(404, "text/plain", "No hay traza grabada");
+      return;
+    }
+    server.streamFile(archivo, "text/plain");
+    archivo.close();
+  }
+#endif
+
+  // Con la configuración completa arrancan la conexión y las lecturas
+  void empezarConexion() {
+    configuracionRecibida = true;
+    marcarFase(&arranque, FASE_CONFIGURACION, millis());
+    if (!transporteListo) return;
+
+    // WiFi.begin() ya, sin esperar la tarea: asocia mientras sigue el resto
+    vigilarWiFi();
+    programarTarea(&planificador, tareaWifi, PERIODO_WIFI_CONECTANDO_MS);
+    programarTarea(&planificador, tareaSalida, 0);
+  }
+
+  // Tarea "wifi": conecta sin bloquear. WiFi.begin() sigue solo; acá se
+  // mira cómo le fue y se reintenta si pasó el plazo del intento (rápido
+  // con el AP guardado o completo, ver asociacion.h).
+  void vigilarWiFi() {
+    if (WiFi.status() == WL_CONNECTED) {
+      if (soltandoWiFi) return;
+      if (!wifiConectado) {
+        if (conectandoWiFi) asociacionLograda();
+        alConectarWiFi();
+      }
+      if (asociacionVigente()) return;
+
+      // La IP fija no se verificó a tiempo, o toca renovarla: se suelta la
+      // red y, cuando se cae, se asocia de nuevo
+      WiFi.disconnect(false, false);
+      soltandoWiFi = true;
+      wifiConectado = false;
+      desconexionesWiFi++;
+      return;
+    }
+    soltandoWiFi = false;
+
+    if (wifiConectado) {
+      REG_AVISO("WiFi desconectado");
+      desconexionesWiFi++;
+      wifiConectado = false;
+      conectandoWiFi = false;
+    }
+    if (conectandoWiFi && millis() - inicioConexionWiFi < plazoAsociacion()) return;
+
+    if (conectandoWiFi) {
+      REG_AVISO("Fallo al conectar WiFi");
+      asociacionFallida();
+    }
+    REG_INFO("Conectando a WiFi...");
+    empezarAsociacion(redWiFi.c_str(), claveWiFi.c_str());
+    conectandoWiFi = true;
+    inicioConexionWiFi = millis();
+    cambiarPeriodo(&planificador, tareaWifi, PERIODO_WIFI_CONECTANDO_MS);
+  }
+
+  void alConectarWiFi() {
+    wifiConectado = true;
+    conexionesWiFi++;
+    conectandoWiFi = false;
+    cambiarPeriodo(&planificador, tareaWifi, PERIODO_WIFI_MS);
+    marcarFase(&arranque, FASE_WIFI, millis());
+    REG_INFO("WiFi conectado: %s", WiFi.localIP().toString().c_str());
+
+    // Sincronizar hora para el timestamp de las mediciones; la tarea "ntp"
+    // avisa cuando llega
+    configTime(0, 0, "time.google.com", "time.windows.com");
+    programarTarea(&planificador, tareaNtp, 0);
+
+#if SALIDA_INFLUX
+    configurarSalidaInflux(servidorMqtt.c_str(), puertoMqtt);
+    alListaSalida();
+#endif
+  }
+
+  // La salida quedó lista (broker conectado, o WiFi con SALIDA_INFLUX). La
+  // primera vez se publica enseguida la última medición, si es del
+  // intervalo en curso, o se lee de nuevo. Esa medición ya pasó por el
+  // historial y los resúmenes: solo falta el lote.
+  void alListaSalida() {
+    marcarFase(&arranque, FASE_SALIDA, millis());
+    if (primeraPublicacion) return;
+
+    if (hayLectura && millis() - msUltimaLectura < intervaloActual) {
+      encolarMedicion(procesamiento.ultimaMedicion);
+    } else {
+      programarTarea(&planificador, tareaLectura, 0);
+    }
+  }
+
+  bool salidaLista() {
+#if SALIDA_INFLUX
+    return wifiConectado;
+#else
+    return mqttClient.connected();
+#endif
+  }
+
+  // Tarea "ntp": hasta que llega la hora. Después configTime() la mantiene
+  // sola. Con TLS, MQTT no se conecta antes porque no podría validar los
+  // certificados.
+  void esperarHora() {
+    time_t ahora = time(nullptr);
+    if (ahora <= HORA_VALIDA_MINIMA) return;
+
+    struct tm hora;
+    gmtime_r(&ahora, &hora);
+    char texto[20];
+    strftime(texto, sizeof(texto), "%Y-%m-%d %H:%M:%S", &hora);
+    REG_INFO("Hora sincronizada con NTP: %s", texto);
+    horaSincronizada = true;
+    marcarFase(&arranque, FASE_HORA, millis());
+    detenerTarea(&planificador, tareaNtp);
+
+    // Lo que se juntó sin hora sale ahora, con el timestamp corregido
+    if (procesamiento.cantidadEnLote > 0) programarTarea(&planificador, tareaPublicar, 0);
+  }
+
+  // Tarea "mqtt": conecta o atiende lo que llegó
+  void atenderMqtt() {
+    if (!mqttClient.connected()) connectMQTT();
+    mqttClient.loop();
+  }
+
+#if SALIDA_INFLUX
+  // Tarea "diario": reenvía lo que no se pudo escribir en InfluxDB
+  void vaciarDiario() {
+    if (wifiConectado) vaciarDiarioInflux();
+  }
+#endif
+
+  // Tarea "lectura": su período es el intervalo del muestreo adaptivo
+  void leerSensores() {
+    Lectura lectura = sensores.leer();
+    lecturas++;
+    marcarFase(&arranque, FASE_PRIMERA_LECTURA, millis());
+    ultimaLectura = lectura;
+    msUltimaLectura = millis();
+    hayLectura = true;
+    intervaloActual = planificarMuestreo(&estadoMuestreo, muestreo, lectura);
+    cambiarPeriodo(&planificador, tareaLectura, intervaloActual);
+    publishMetrics(lectura);
+  }
+
+  // Cada episodio nuevo se avisa enseguida, y el lote que tiene la lectura
+  // anómala sale en la próxima pasada en lugar de esperar a llenarse
+  void avisarAnomalias(const ResultadoLectura& resultado) {
+    if (resultado.anomalias == 0) return;
+
+    for (uint8_t i = 0; i < resultado.anomalias; i++) {
+      char alerta[ANOMALIA_LARGO_JSON];
+      codificarAlertaJson(resultado.nuevas[i], tiempoActual(), transporte.idDispositivo(), alerta, sizeof(alerta));
+      REG_AVISO("Anomalía: %s", alerta);
+#if !SALIDA_INFLUX
+      // Sin conexión o sin hora la alerta queda solo en el registro: la
+      // lectura llega igual, en el lote
+      if (horaValida() && salidaLista() && !mqttClient.publish(TOPICO_MQTT_ALERTA, alerta)) {
+        REG_ERROR("Error publicando la alerta en MQTT");
+      }
+#endif
+    }
+    if (procesamiento.cantidadEnLote > 0) programarTarea(&planificador, tareaPublicar, 0);
+  }
+
+  // Tarea "ota": vuelve a la imagen anterior si no se confirmó a tiempo, y
+  // hace la actualización pedida desde el portal, con WiFi y fuera del
+  // handler HTTP. Si sale bien no vuelve (reinicia).
+  void atenderOta() {
+    vigilarActualizacion();
+    if (servidorOta.length() > 0 && wifiConectado) {
+      actualizar();
+      servidorOta = "";
+    }
+  }
+
+  // GET /api/scheduler: atraso y duración de cada tarea de loop()
+  void handlePlanificador() {
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    char bloque[320];
+    for (uint8_t i = 0; i < planificador.cantidad; i++) {
+      bloque[0] = i == 0 ? '[' : ',';
+      size_t largo = 1 + describirTarea(planificador.tareas[i], bloque + 1, sizeof(bloque) - 1);
+      server.sendContent(bloque, largo);
+    }
+    server.sendContent("]");
+    server.sendContent("");
+  }
+
+  // GET /api/boot: perfil del arranque, aunque todavía no haya publicado
+  void handleArranque() {
+    char informe[ARRANQUE_LARGO_INFORME];
+    describirArranque(arranque, transporte.idDispositivo(), VERSION_FIRMWARE, motivoReinicio(), informe,
+                      sizeof(informe));
+    server.send(200, "application/json", informe);
+  }
+
+  // GET /api/log: mensajes escritos, descartados y cortados del registro
+  void handleRegistro() {
+    char informe[REGISTRO_LARGO_INFORME];
+    describirRegistro(informe, sizeof(informe));
+    server.send(200, "application/json", informe);
+  }
+
+#if REGISTRO_FLASH
+  void handleRegistroFlash() {
+    // GET manda lo guardado en flash como texto; ?borrar=1 lo borra
+    if (server.hasArg("borrar")) {
+      borrarRegistroFlash();
+      server.send(200, "text/plain", "Registro borrado");
+      return;
+    }
+
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain", "");
+    leerRegistroFlash([](void* p, const char* linea, size_t largo) { ((WebServer*)p)->sendContent(linea, largo); },
+                      &server);
+    server.sendContent("");
+  }
+#endif
+
+  // GET /api/anomalies: muestras, anomalías y episodios de cada métrica
+  void handleAnomalias() {
+    char informe[ANOMALIA_LARGO_INFORME];
+    describirDetector(procesamiento.detector, informe, sizeof(informe));
+    server.send(200, "application/json", informe);
+  }
+
+  // GET /api/memory: heap y, con MEMORIA_ESTATICA, lo que pidió cada tarea
+  void handleMemoria() {
+    char informe[MEMORIA_LARGO_INFORME];
+    describirMemoria(informe, sizeof(informe));
+    server.send(200, "application/json", informe);
+  }
+
+  // GET /metrics: formato de Prometheus, en chunks desde la tabla de métricas.
+  // Solo lee lo guardado: consultar seguido no mueve las lecturas.
+  void handleMetricas() {
+    uint32_t inicio = micros();
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4; charset=utf-8", "");
+    escribirPrometheus(
+        metricas, [](void* p, const char* texto, size_t largo) { ((WebServer*)p)->sendContent(texto, largo); },
+        &server);
+    server.sendContent("");
+    usUltimaConsulta = micros() - inicio;
+  }
+
+  // La tabla de /metrics (ver prometheus.h). Después de agregar las tareas:
+  // hay una serie por tarea.
+  void registrarMetricas() {
+    iniciarTablaPrometheus(&metricas);
+
+    // Última lectura; NaN hasta la primera
+    agregarMetrica(&metricas, "pool_ph", "pH de la última lectura", PROMETHEUS_GAUGE,
+                   [](const void* p, uint8_t) { return yo(p).valorLectura(yo(p).ultimaLectura.ph); }, this);
+    agregarMetrica(&metricas, "pool_temperature_celsius", "Temperatura de la última lectura", PROMETHEUS_GAUGE,
+                   [](const void* p, uint8_t) { return yo(p).valorLectura(yo(p).ultimaLectura.temperatura); }, this);
+    agregarMetrica(&metricas, "pool_tds_ppm", "TDS de la última lectura", PROMETHEUS_GAUGE,
+                   [](const void* p, uint8_t) { return yo(p).valorLectura(yo(p).ultimaLectura.tds); }, this);
+    agregarMetrica(&metricas, "pool_trend", "Tendencia de la última lectura: -1 bajando, 0 estable, 1 subiendo",
+                   PROMETHEUS_GAUGE,
+                   [](const void* p, uint8_t) { return yo(p).valorLectura(yo(p).ultimaLectura.valorTendencia); },
+                   this);
+    agregarMetrica(&metricas, "pool_reading_age_seconds", "Antigüedad de la última lectura", PROMETHEUS_GAUGE,
+                   [](const void* p, uint8_t) {
+                     return yo(p).valorLectura((millis() - yo(p).msUltimaLectura) / 1000.0);
+                   },
+                   this);
+    agregarMetrica(&metricas, "pool_readings_total", "Lecturas de los sensores", PROMETHEUS_COUNTER,
+                   [](const void* p, uint8_t) -> double { return yo(p).lecturas; }, this);
+    agregarMetrica(&metricas, "pool_sampling_interval_seconds", "Intervalo actual del muestreo adaptivo",
+                   PROMETHEUS_GAUGE, [](const void* p, uint8_t) { return yo(p).intervaloActual / 1000.0; }, this);
+    agregarMetricaPorSerie(&metricas, "pool_rejected_readings_total",
+                           "Lecturas sin valor válido (se usó el anterior)", PROMETHEUS_COUNTER,
+                           [](const void* p, uint8_t s) -> double {
+                             return yo(p).procesamiento.detector.metricas[s].anomalas[ANOMALIA_RECHAZADA];
+                           },
+                           this, "metric", [](const void*, uint8_t s) { return LIMITES_METRICAS[s].nombre; },
+                           CANTIDAD_METRICAS);
+    agregarMetricaPorSerie(&metricas, "pool_anomaly_episodes_total", "Episodios de anomalías (ver /api/anomalies)",
+                           PROMETHEUS_COUNTER,
+                           [](const void* p, uint8_t s) -> double { return yo(p).procesamiento.detector.metricas[s].episodios; },
+                           this, "metric", [](const void*, uint8_t s) { return LIMITES_METRICAS[s].nombre; },
+                           CANTIDAD_METRICAS);
+
+    // Conexiones y publicaciones
+    agregarMetrica(&metricas, "pool_wifi_connects_total", "Conexiones a WiFi", PROMETHEUS_COUNTER,
+                   [](const void* p, uint8_t) -> double { return yo(p).conexionesWiFi; }, this);
+    agregarMetrica(&metricas, "pool_wifi_disconnects_total", "Desconexiones de WiFi", PROMETHEUS_COUNTER,
+                   [](const void* p, uint8_t) -> double { return yo(p).desconexionesWiFi; }, this);
+#if !SALIDA_INFLUX
+    agregarMetrica(&metricas, "pool_mqtt_connects_total", "Conexiones al broker", PROMETHEUS_COUNTER,
+                   [](const void* p, uint8_t) -> double { return yo(p).conexionesMqtt; }, this);
+    agregarMetrica(&metricas, "pool_mqtt_connect_failures_total", "Intentos fallidos de conectar al broker",
+                   PROMETHEUS_COUNTER, [](const void* p, uint8_t) -> double { return yo(p).fallosMqtt; }, this);
+#endif
+    agregarMetricaPorSerie(&metricas, "pool_publish_total", "Lotes publicados, por resultado", PROMETHEUS_COUNTER,
+                           [](const void* p, uint8_t s) -> double { return yo(p).publicaciones[s]; }, this, "result",
+                           [](const void*, uint8_t s) { return s == 0 ? "ok" : "error"; }, 2);
+
+    // Memoria
+    agregarMetrica(&metricas, "pool_heap_free_bytes", "Heap libre", PROMETHEUS_GAUGE,
+                   [](const void*, uint8_t) -> double { return estadoHeap().libre; }, this);
+    agregarMetrica(&metricas, "pool_heap_min_free_bytes", "Heap libre mínimo desde el arranque", PROMETHEUS_GAUGE,
+                   [](const void*, uint8_t) -> double { return estadoHeap().minimoLibre; }, this);
+    agregarMetrica(&metricas, "pool_heap_max_block_bytes", "Bloque más grande que se puede pedir", PROMETHEUS_GAUGE,
+                   [](const void*, uint8_t) -> double { return estadoHeap().bloqueMaximo; }, this);
+    agregarMetrica(&metricas, "pool_uptime_seconds", "Tiempo desde el arranque", PROMETHEUS_GAUGE,
+                   [](const void*, uint8_t) { return esp_timer_get_time() / 1e6; }, this);
+
+    // Tareas de loop() (ver /api/scheduler)
+    EtiquetaPrometheus nombreTarea = [](const void* p, uint8_t s) { return yo(p).planificador.tareas[s].nombre; };
+    uint8_t tareas = planificador.cantidad;
+    agregarMetricaPorSerie(&metricas, "pool_task_runs_total", "Ejecuciones de la tarea", PROMETHEUS_COUNTER,
+                           [](const void* p, uint8_t s) -> double { return estadisticas(p, s).ejecuciones; }, this,
+                           "task", nombreTarea, tareas);
+    agregarMetricaPorSerie(&metricas, "pool_task_run_seconds_total", "Tiempo ejecutando la tarea",
+                           PROMETHEUS_COUNTER,
+                           [](const void* p, uint8_t s) { return estadisticas(p, s).duracionTotalMs / 1000.0; }, this,
+                           "task", nombreTarea, tareas);
+    agregarMetricaPorSerie(&metricas, "pool_task_run_max_seconds", "Ejecución más larga de la tarea",
+                           PROMETHEUS_GAUGE,
+                           [](const void* p, uint8_t s) { return estadisticas(p, s).duracionMaximaMs / 1000.0; },
+                           this, "task", nombreTarea, tareas);
+    agregarMetricaPorSerie(&metricas, "pool_task_late_seconds_total", "Atraso acumulado de la tarea",
+                           PROMETHEUS_COUNTER,
+                           [](const void* p, uint8_t s) { return estadisticas(p, s).atrasoTotalMs / 1000.0; }, this,
+                           "task", nombreTarea, tareas);
+    agregarMetricaPorSerie(&metricas, "pool_task_late_max_seconds", "Atraso más grande de la tarea",
+                           PROMETHEUS_GAUGE,
+                           [](const void* p, uint8_t s) { return estadisticas(p, s).atrasoMaximoMs / 1000.0; }, this,
+                           "task", nombreTarea, tareas);
+    agregarMetricaPorSerie(&metricas, "pool_task_over_budget_total", "Ejecuciones que pasaron el presupuesto",
+                           PROMETHEUS_COUNTER,
+                           [](const void* p, uint8_t s) -> double { return estadisticas(p, s).excesos; }, this,
+                           "task", nombreTarea, tareas);
+#if MEMORIA_ESTATICA
+    agregarMetricaPorSerie(&metricas, "pool_task_heap_allocations_total",
+                           "Pedidos al heap de la tarea (MEMORIA_ESTATICA)", PROMETHEUS_COUNTER,
+                           [](const void*, uint8_t s) -> double { return asignacionesTarea(s).cantidad; }, this,
+                           "task", nombreTarea, tareas);
+#endif
+    agregarMetrica(&metricas, "pool_scrape_duration_seconds", "Lo que tardó el /metrics anterior", PROMETHEUS_GAUGE,
+                   [](const void* p, uint8_t) { return yo(p).usUltimaConsulta / 1e6; }, this);
+  }
+
+  static const Pileta& yo(const void* p) { return *(const Pileta*)p; }
+
+  static const EstadisticasTarea& estadisticas(const void* p, uint8_t tarea) {
+    return yo(p).planificador.tareas[tarea].estadisticas;
+  }
+
+  double valorLectura(double valor) const { return hayLectura ? valor : NAN; }
+
+  // GET /api/wifi: tiempos de la asociación rápida y de la completa
+  void handleWiFi() {
+    char informe[ASOCIACION_LARGO_INFORME];
+    describirAsociacion(informe, sizeof(informe));
+    server.send(200, "application/json", informe);
+  }
+
+  void informarArranque() {
+    char informe[ARRANQUE_LARGO_INFORME];
+    describirArranque(arranque, transporte.idDispositivo(), VERSION_FIRMWARE, motivoReinicio(), informe,
+                      sizeof(informe));
+#if !SALIDA_INFLUX
+    mqttClient.publish(TOPICO_MQTT_ARRANQUE, informe);
+#endif
+    REG_INFO("Arranque: %s", informe);
+  }
+
+  static const char* motivoReinicio() {
+    switch (esp_reset_reason()) {
+      case ESP_RST_POWERON: return "power_on";
+      case ESP_RST_EXT: return "external";
+      case ESP_RST_SW: return "software";
+      case ESP_RST_PANIC: return "panic";
+      case ESP_RST_INT_WDT:
+      case ESP_RST_TASK_WDT:
+      case ESP_RST_WDT: return "watchdog";
+      case ESP_RST_DEEPSLEEP: return "deep_sleep";
+      case ESP_RST_BROWNOUT: return "brownout";
+      default: return "unknown";
+    }
+  }
+
+  void connectMQTT() {
+    if (!wifiConectado) return;
+    if (Transporte::necesitaHora && !horaSincronizada) return;
+
+    // Después de varios fallos seguidos se espera antes de volver a intentar,
+    // sin bloquear el servidor web
+    if (esperandoMqtt && millis() - inicioEsperaMqtt < ESPERA_TRAS_INTENTOS_MS) return;
+    esperandoMqtt = false;
+
+    mqttClient.setServer(servidorMqtt.c_str(), puertoMqtt);
+
+    intentosReconexion++;
+    REG_INFO("Conectando a MQTT %s:%d (intento %d)...", servidorMqtt.c_str(), puertoMqtt, intentosReconexion);
+
+    marcarFase(&arranque, FASE_INICIO_SALIDA, millis());
+    if (mqttClient.connect(transporte.idCliente())) {
+      REG_INFO("Conectado al broker");
+      redAlcanzada();
+      conexionesMqtt++;
+      intentosReconexion = 0;
+      mqttClient.subscribe(topicoControl);
+      publicarEstadoControl("conectado");
+      alListaSalida();
+      return;
+    }
+
+    REG_AVISO("Fallo al conectar a MQTT, rc=%d (%s)", mqttClient.state(), describirEstadoMqtt(mqttClient.state()));
+    fallosMqtt++;
+
+    if (intentosReconexion >= MAX_INTENTOS_MQTT) {
+      REG_ERROR("No se pudo conectar a MQTT después de varios intentos, esperando...");
+      esperandoMqtt = true;
+      inicioEsperaMqtt = millis();
+      intentosReconexion = 0;
+    }
+  }
+
+  static const char* describirEstadoMqtt(int estado) {
+    switch (estado) {
+      case -4: return "timeout de conexión";
+      case -3: return "conexión perdida";
+      case -2: return "fallo en la conexión de red";
+      case -1: return "cliente desconectado";
+      case 1: return "versión de protocolo incorrecta";
+      case 2: return "ID de cliente rechazado";
+      case 3: return "servidor no disponible";
+      case 4: return "credenciales incorrectas";
+      case 5: return "no autorizado";
+      default: return "error desconocido";
+    }
+  }
+
+  // Mensaje en pool/<id>/control: cambia la configuración del muestreo sin
+  // reiniciar. La respuesta (y la configuración vigente) va a .../estado.
+  void recibirControl(char* topico, uint8_t* datos, unsigned int largo) {
+    if (strcmp(topico, topicoControl) != 0) return;
+
+    if (!aplicarControlMuestreo(&muestreo, (const char*)datos, largo)) {
+      REG_AVISO("Control de muestreo rechazado");
+      publicarEstadoControl("rechazado");
+      return;
+    }
+
+    // Si el intervalo en curso quedó fuera de los nuevos límites, se corrige ya
+    intervaloActual = std::min(std::max(intervaloActual, muestreo.intervaloRapidoMs), muestreo.intervaloLentoMs);
+    estadoMuestreo.intervaloMs = intervaloActual;
+    cambiarPeriodo(&planificador, tareaLectura, intervaloActual);
+    if (procesamiento.cantidadEnLote >= muestreo.lote) programarTarea(&planificador, tareaPublicar, 0);
+
+    publicarEstadoControl("aplicado");
+  }
+
+  void publicarEstadoControl(const char* resultado) {
+    char estado[LARGO_MAXIMO_CONTROL];
+    int largo = snprintf(estado, sizeof(estado), "%s ", resultado);
+    describirMuestreo(muestreo, estado + largo, sizeof(estado) - largo);
+    mqttClient.publish(topicoEstadoControl, estado);
+    REG_INFO("Muestreo: %s", estado);
+  }
+
+  static bool horaValida() {
+    return time(nullptr) > HORA_VALIDA_MINIMA;
+  }
+
+  // Con hora NTP, Unix; si todavía no sincronizó, segundos desde el inicio
+  static unsigned long tiempoActual() {
+    time_t ahora = time(nullptr);
+    return ahora > HORA_VALIDA_MINIMA ? (unsigned long)ahora : millis() / 1000;
+  }
+
+  // Historial, resúmenes y detector (procesamiento.h); acá solo se publica
+  // lo que salió
+  void publishMetrics(const Lectura& lectura) {
+    ResultadoLectura resultado;
+    procesarLectura(&procesamiento, lectura, tiempoActual(), millis(), transporte.idDispositivo(), &resultado);
+
+#if PUBLICAR_RESUMENES
+    for (uint8_t i = 0; i < resultado.resumenesCerrados; i++) publicarResumen(resultado.cerrados[i]);
+#endif
+
+    encolarMedicion(procesamiento.ultimaMedicion);
+    avisarAnomalias(resultado);
+  }
+
+  void encolarMedicion(const Medicion& medicion) {
+    // Hasta la primera conexión las lecturas solo calientan los sensores
+    if (!primeraPublicacion && !salidaLista()) return;
+
+    // Con los valores quietos se juntan hasta 'lote' mediciones; si algo se
+    // mueve, o es la primera, se manda enseguida (en la próxima pasada del
+    // planificador)
+    if (procesamiento.cantidadEnLote == LOTE_MAXIMO) publicarLote();
+    // Si sigue lleno es porque no hay hora: se pierde la más vieja
+    agregarAlLote(&procesamiento, medicion);
+    if (procesamiento.cantidadEnLote >= muestreo.lote || estadoMuestreo.acelerado || !primeraPublicacion) {
+      programarTarea(&planificador, tareaPublicar, 0);
+    }
+  }
+
+#if PUBLICAR_RESUMENES
+  void publicarResumen(const Resumen& resumen) {
+    // Una ventana que empezó antes de tener hora no sirve para los dashboards
+    if (resumen.inicio <= HORA_VALIDA_MINIMA) return;
+
+    char payload[RESUMEN_LARGO_JSON];
+    if (codificarResumenJson(resumen, transporte.idDispositivo(), payload, sizeof(payload)) == 0) return;
+    if (mqttClient.publish(TOPICO_MQTT_RESUMEN, payload)) {
+      REG_DEPURACION("Resumen publicado: %s", payload);
+    } else {
+      REG_ERROR("Error publicando el resumen en MQTT");
+    }
+  }
+#endif
+
+  void publicarLote() {
+    if (procesamiento.cantidadEnLote == 0) return;
+
+    // Sin hora no se publica: Telegraf y el puente toman el timestamp como
+    // Unix. El lote espera a esperarHora(), y ahí se pasan a Unix los
+    // timestamps tomados antes (segundos desde el inicio).
+    if (!horaValida()) return;
+    corregirTimestampsLote(&procesamiento, (int64_t)time(nullptr) - (int64_t)(millis() / 1000), HORA_VALIDA_MINIMA);
+
+#if SALIDA_INFLUX
+    bool publicado = publicarEnInflux(procesamiento.lote, procesamiento.cantidadEnLote);
+#else
+    codificarLoteJson(procesamiento, payloadLote);
+    bool publicado = mqttClient.publish(TOPICO_MQTT, payloadLote);
+    if (publicado) {
+      REG_INFO("Publicado: %u mediciones", procesamiento.cantidadEnLote);
+      REG_DEPURACION("Payload: %s", payloadLote);
+    }
+#endif
+
+    publicaciones[publicado ? 0 : 1]++;
+    if (publicado) {
+      redAlcanzada();
+      if (!primeraPublicacion) {
+        // La imagen que corre llegó a publicar: ya no hace falta volver atrás
+        primeraPublicacion = true;
+        marcarFase(&arranque, FASE_PRIMERA_PUBLICACION, millis());
+        informarArranque();
+        char informe[OTA_LARGO_INFORME];
+        if (confirmarActualizacion(transporte.idDispositivo(), informe, sizeof(informe))) {
+#if !SALIDA_INFLUX
+          mqttClient.publish(TOPICO_MQTT_OTA, informe);
+#endif
+          REG_INFO("Informe de actualización: %s", informe);
+        }
+#if MEMORIA_ESTATICA >= 2
+        // Desde acá medir y publicar no piden memoria (InfluxDB sí: HTTPClient)
+        prohibirAsignaciones(tareaLectura);
+        prohibirAsignaciones(tareaSensores);
+        if (!SALIDA_INFLUX) prohibirAsignaciones(tareaPublicar);
+#endif
+      }
+    } else {
+      REG_ERROR(SALIDA_INFLUX ? "Error escribiendo en InfluxDB" : "Error publicando en MQTT");
+    }
+
+#if PUBLICAR_BINARIO
+    for (uint8_t i = 0; i < procesamiento.cantidadEnLote; i++) {
+      uint8_t binario[TAMANO_MAXIMO_BINARIO];
+      size_t largoBinario = codificarBinario(procesamiento.lote[i], binario);
+      mqttClient.publish(TOPICO_MQTT_BINARIO, binario, largoBinario);
+    }
+#endif
+
+#if PUBLICAR_SERIE
+    uint8_t serie[tamanoMaximoSerie(LOTE_MAXIMO)];
+    CompresorSerie compresor;
+    iniciarCompresor(&compresor, serie, sizeof(serie), transporte.idDispositivo());
+    for (uint8_t i = 0; i < procesamiento.cantidadEnLote; i++) agregarMedicion(&compresor, procesamiento.lote[i]);
+    mqttClient.publish(TOPICO_MQTT_SERIE, serie, largoSerie(compresor));
+#endif
+
+    procesamiento.cantidadEnLote = 0;
+  }
+
+  Transporte transporte;
+  Sensores sensores;
+
+  WebServer server;
+  PubSubClient mqttClient;
+
+  // Variables de configuración
+  String redWiFi = "";
+  String claveWiFi = "";
+  String servidorMqtt = "";
+  int puertoMqtt = 1883;
+  String servidorOta = "";  // Actualización pedida, vacío si no hay
+
+  // Flags y estado de conexión
+  bool configuracionRecibida = false;
+  bool transporteListo = false;
+  bool wifiConectado = false;
+  bool conectandoWiFi = false;
+  bool soltandoWiFi = false;  // Se desconectó a propósito para volver a asociarse
+  unsigned long inicioConexionWiFi = 0;
+  bool horaSincronizada = false;
+  int intentosReconexion = 0;
+  bool esperandoMqtt = false;
+  unsigned long inicioEsperaMqtt = 0;
+  bool primeraPublicacion = false;
+  Arranque arranque;
+
+  // Última lectura (su medición está en el procesamiento), para publicarla
+  // apenas se conecta por primera vez
+  Lectura ultimaLectura;
+  uint32_t msUltimaLectura = 0;
+  bool hayLectura = false;
+
+  // Contadores de /metrics
+  uint32_t lecturas = 0;
+  uint32_t conexionesWiFi = 0;
+  uint32_t desconexionesWiFi = 0;
+  uint32_t conexionesMqtt = 0;
+  uint32_t fallosMqtt = 0;
+  uint32_t publicaciones[2] = {};  // Lotes publicados bien y con error
+  uint32_t usUltimaConsulta = 0;
+  TablaPrometheus metricas;
+
+  // Historial, resúmenes, detector y lote pendiente de publicar
+  Procesamiento procesamiento;
+
+  Planificador planificador;
+  int tareaWeb, tareaWifi, tareaNtp, tareaSalida, tareaLectura, tareaSensores, tareaPublicar, tareaOta;
+
+  // Muestreo adaptivo
+  ConfiguracionMuestreo muestreo;
+  EstadoMuestreo estadoMuestreo;
+  uint32_t intervaloActual = INTERVALO_ENVIO_MS;
+  char payloadLote[TAMANO_LOTE_JSON];
+  char topicoControl[LARGO_TOPICO_EQUIPO];
+  char topicoEstadoControl[LARGO_TOPICO_EQUIPO];
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+// Planificador cooperativo para loop(): cada cosa que hace el firmware
+// (atender la web, conectar, leer, publicar...) es una tarea periódica o
+// de una vez, con su hora programada. loop() ejecuta las que vencieron y
+// duerme hasta la próxima.
+//
+// Las tareas están en una rueda de tiempo con PLANIFICADOR_RANURAS ranuras
+// de PLANIFICADOR_TICK_MS: cada tarea cuelga de la ranura de su hora
+// programada, así en cada pasada solo se miran las ranuras de los ticks
+// que pasaron. Una tarea que vence dentro de varias vueltas queda en su
+// ranura y se saltea hasta que le toca.
+//
+// Nada se interrumpe: una tarea que tarda más que su presupuesto solo se
+// cuenta (y atrasa a las que siguen, lo que se ve en su atraso). No
+// depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PLANIFICADOR_MAXIMO_TAREAS 12
+#define PLANIFICADOR_RANURAS 16  // Potencia de 2
+#define PLANIFICADOR_TICK_MS 4
+#define PLANIFICADOR_ESPERA_MAXIMA_MS 1000  // Lo más que devuelve ejecutarPendientes()
+
+#define TAREA_INVALIDA -1
+
+typedef void (*FuncionTarea)(void* contexto);
+typedef uint32_t (*RelojPlanificador)();  // Milisegundos, puede dar la vuelta
+
+struct EstadisticasTarea {
+  uint32_t ejecuciones;
+  uint32_t atrasoUltimoMs;    // De la hora programada al comienzo
+  uint32_t atrasoMaximoMs;
+  uint64_t atrasoTotalMs;
+  uint32_t duracionMaximaMs;
+  uint64_t duracionTotalMs;
+  uint32_t excesos;           // Veces que tardó más que su presupuesto
+};
+
+struct Tarea {
+  const char* nombre;
+  FuncionTarea funcion;
+  void* contexto;
+  uint32_t periodoMs;         // 0: se ejecuta una vez por cada programarTarea()
+  uint32_t presupuestoMs;     // 0: sin presupuesto
+  uint32_t proxima;           // Hora programada
+  bool activa;                // Colgada de la rueda
+  bool tocada;                // Se reprogramó o detuvo desde que venció
+  int8_t siguiente;           // Próxima tarea de la misma ranura
+  EstadisticasTarea estadisticas;
+};
+
+struct Planificador {
+  Tarea tareas[PLANIFICADOR_MAXIMO_TAREAS];
+  uint8_t cantidad;
+  int8_t ranuras[PLANIFICADOR_RANURAS];
+  uint32_t ultimoTick;        // Última ranura revisada
+  int8_t ejecutando;          // Tarea en curso, o TAREA_INVALIDA
+  RelojPlanificador reloj;
+};
+
+void iniciarPlanificador(Planificador* planificador, RelojPlanificador reloj);
+
+// Registra una tarea, sin programarla. Devuelve su número, o TAREA_INVALIDA
+// si no entran más.
+int agregarTarea(Planificador* planificador, const char* nombre, FuncionTarea funcion, void* contexto,
+                 uint32_t periodoMs, uint32_t presupuestoMs);
+
+// Programa la tarea para dentro de 'demoraMs' (0: en la próxima pasada).
+// Si ya estaba programada, la mueve.
+void programarTarea(Planificador* planificador, int tarea, uint32_t demoraMs);
+
+// Cambia el período. Si la tarea está programada, la próxima ejecución
+// pasa a ser un período nuevo después de la anterior.
+void cambiarPeriodo(Planificador* planificador, int tarea, uint32_t periodoMs);
+
+void detenerTarea(Planificador* planificador, int tarea);
+
+// Ejecuta las tareas vencidas, en orden de hora programada. Devuelve los
+// ms que faltan para la próxima (hasta PLANIFICADOR_ESPERA_MAXIMA_MS).
+uint32_t ejecutarPendientes(Planificador* planificador);
+
+// Una tarea en JSON, para /api/scheduler. Devuelve el largo.
+size_t describirTarea(const Tarea& tarea, char* destino, size_t largo);
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef PORTAL_H
+#define PORTAL_H
+
+#include <Arduino.h>
+
+// Página de configuración del punto de acceso. Se arma como
+// PORTAL_ANTES + campos propios del transporte + PORTAL_DESPUES,
+// así cada build muestra solo lo que necesita pedir.
+
+static const char PORTAL_ANTES[] PROGMEM = R"rawliteral(
+<!DOCTYPE html>
+<html lang="es">
+<head>
+    <meta charset="UTF-8">
+    <meta name="viewport" content="width=device-width, initial-scale=1.0">
+    <title>Configuracion ESP32 - Piletas</title>
+    <style>
+        * {
+            margin: 0;
+            padding: 0;
+            box-sizing: border-box;
+        }
+
+        body {
+            font-family: Arial, sans-serif;
+            min-height: 100vh;
+            background: linear-gradient(135deg, #1e3c72 0%, #2a5298 50%, #87ceeb 100%);
+            display: flex;
+            justify-content: center;
+            align-items: center;
+        }
+
+        .contenedor-principal {
+            background: rgba(255, 255, 255, 0.95);
+            padding: 2rem;
+            border-radius: 15px;
+            box-shadow: 0 8px 25px rgba(0, 0, 0, 0.2);
+            width: 100%;
+            max-width: 400px;
+            backdrop-filter: blur(10px);
+        }
+
+        .titulo {
+            text-align: center;
+            color: #1e3c72;
+            margin-bottom: 1.5rem;
+            font-size: 1.5rem;
+            font-weight: bold;
+        }
+
+        .grupo-campo {
+            margin-bottom: 1rem;
+        }
+
+        .etiqueta {
+            display: block;
+            margin-bottom: 0.5rem;
+            color: #2a5298;
+            font-weight: 500;
+        }
+
+        .campo-entrada {
+            width: 100%;
+            padding: 0.75rem;
+            border: 2px solid #87ceeb;
+            border-radius: 8px;
+            font-size: 1rem;
+            transition: all 0.3s ease;
+            background: rgba(255, 255, 255, 0.9);
+        }
+
+        .campo-entrada:focus {
+            outline: none;
+            border-color: #2a5298;
+            box-shadow: 0 0 10px rgba(42, 82, 152, 0.3);
+            background: white;
+        }
+
+        .boton-guardar {
+            width: 100%;
+            padding: 0.75rem;
+            background: linear-gradient(135deg, #2a5298, #1e3c72);
+            color: white;
+            border: none;
+            border-radius: 8px;
+            font-size: 1rem;
+            font-weight: bold;
+            cursor: pointer;
+            transition: all 0.3s ease;
+            margin-top: 1rem;
+        }
+
+        .boton-guardar:hover {
+            transform: translateY(-2px);
+            box-shadow: 0 5px 15px rgba(42, 82, 152, 0.4);
+        }
+
+        .boton-guardar:active {
+            transform: translateY(0);
+        }
+
+        .icono-agua {
+            text-align: center;
+            font-size: 3rem;
+            color: #2a5298;
+            margin-bottom: 1rem;
+        }
+
+        @media (max-width: 480px) {
+            .contenedor-principal {
+                margin: 1rem;
+                padding: 1.5rem;
+            }
+            
+            .titulo {
+                font-size: 1.3rem;
+            }
+        }
+    </style>
+</head>
+<body>
+    <div class="contenedor-principal">
+        <div class="icono-agua">💧</div>
+        <h1 class="titulo">Configuracion ESP32</h1>
+        
+        <form action="/guardar" method="POST">
+            <div class="grupo-campo">
+                <label class="etiqueta" for="ssid">SSID WiFi:</label>
+                <input type="text" id="ssid" name="ssid" class="campo-entrada" required>
+            </div>
+            
+            <div class="grupo-campo">
+                <label class="etiqueta" for="pass">Contrasena:</label>
+                <input type="password" id="pass" name="pass" class="campo-entrada" required>
+            </div>
+            
+)rawliteral";
+
+// Con SALIDA_INFLUX los campos del broker pasan a ser los de InfluxDB
+// (mismos nombres, así el portal se procesa igual)
+static const char PORTAL_CAMPOS_INFLUX[] PROGMEM = R"rawliteral(
+            <div class="grupo-campo">
+                <label class="etiqueta" for="broker">InfluxDB IP:</label>
+                <input type="text" id="broker" name="broker" class="campo-entrada" placeholder="192.168.1.100" required>
+            </div>
+            
+            <div class="grupo-campo">
+                <label class="etiqueta" for="port">InfluxDB Puerto:</label>
+                <input type="number" id="port" name="port" class="campo-entrada" value="8086" required>
+            </div>
+            
+)rawliteral";
+
+static const char PORTAL_DESPUES[] PROGMEM = R"rawliteral(
+            <button type="submit" class="boton-guardar">Guardar</button>
+        </form>
+    </div>
+</body>
+</html>
+)rawliteral";
+
+#endif
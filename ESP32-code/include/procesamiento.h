@@ -0,0 +1,66 @@
+#ifndef PROCESAMIENTO_H
+#define PROCESAMIENTO_H
+
+// Camino de cada lectura, de la política de sensores al lote: la medición
+// del esquema, el historial, los resúmenes por ventana, el detector de
+// anomalías y el lote pendiente con su JSON.
+//
+// Lo que sale del equipo (publicar el lote, los resúmenes y las alertas,
+// y cuándo) queda del lado del firmware: acá solo se arma. Así el
+// firmware (pileta.h) y el banco de memoria del replay (--memoria) pasan
+// cada lectura por el mismo código. No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "anomalias.h"
+#include "esquema.h"
+#include "historial.h"
+#include "muestreo.h"
+#include "resumen.h"
+#include "sensores.h"
+
+#define PROCESAMIENTO_RESUMENES 2  // Ventana corta y larga
+
+// Un lote de mediciones en JSON: "[{...},{...}]"
+constexpr size_t TAMANO_LOTE_JSON = LOTE_MAXIMO * TAMANO_MAXIMO_JSON + 2;
+
+struct Procesamiento {
+  Historial historial;
+  Resumen resumenes[PROCESAMIENTO_RESUMENES];
+  DetectorAnomalias detector;
+
+  Medicion ultimaMedicion;       // La de la última lectura
+  Medicion lote[LOTE_MAXIMO];    // Pendiente de publicar
+  uint8_t cantidadEnLote;
+};
+
+// Lo que dejó una lectura para publicar aparte
+struct ResultadoLectura {
+  Resumen cerrados[PROCESAMIENTO_RESUMENES];  // Ventanas que se cerraron
+  uint8_t resumenesCerrados;
+  Anomalia nuevas[CANTIDAD_METRICAS];         // Episodios que empiezan
+  uint8_t anomalias;
+};
+
+// Una ventana de 0 segundos no se resume
+void iniciarProcesamiento(Procesamiento* procesamiento, uint32_t ventanaCorta, uint32_t ventanaLarga);
+
+// Arma la medición de la lectura en ultimaMedicion, con 'timestamp' (el que
+// se publica), y la pasa por el historial, los resúmenes y el detector, que
+// mide el tiempo con 'ms'. No la agrega al lote.
+void procesarLectura(Procesamiento* procesamiento, const Lectura& lectura, uint32_t timestamp, uint32_t ms,
+                     const char* idDispositivo, ResultadoLectura* resultado);
+
+// Agrega la medición al lote. Si está lleno se pierde la más vieja: hay que
+// publicar antes.
+void agregarAlLote(Procesamiento* procesamiento, const Medicion& medicion);
+
+// Suma 'desfase' a los timestamps del lote anteriores a 'horaValida' (los
+// tomados sin hora, en segundos desde el inicio)
+void corregirTimestampsLote(Procesamiento* procesamiento, int64_t desfase, int64_t horaValida);
+
+// El lote en JSON (terminado en \0), en 'destino' de TAMANO_LOTE_JSON bytes:
+// una medición sola va como objeto, varias como arreglo. Devuelve el largo.
+size_t codificarLoteJson(const Procesamiento& procesamiento, char* destino);
+
+#endif
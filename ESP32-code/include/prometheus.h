@@ -0,0 +1,63 @@
+#ifndef PROMETHEUS_H
+#define PROMETHEUS_H
+
+// Métricas en el formato de texto de Prometheus, para GET /metrics.
+//
+// Cada métrica se agrega una vez a la tabla, en setup(), con una función
+// que lee su valor en el momento: lo último que quedó guardado, sin tocar
+// los sensores ni el planificador. escribirPrometheus() recorre la tabla y
+// va llenando un bloque de PROMETHEUS_LARGO_BLOQUE bytes; cada bloque lleno
+// sale por el escritor (en el firmware, un chunk de la respuesta HTTP), sin
+// armar la página entera.
+//
+// Una métrica puede tener varias series que se distinguen por una
+// etiqueta, p. ej. una por tarea del planificador. Los valores de las
+// etiquetas van tal cual: sin comillas ni barras. No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROMETHEUS_MAXIMO_METRICAS 40
+#define PROMETHEUS_LARGO_BLOQUE 512
+#define PROMETHEUS_LARGO_LINEA 160  // Una serie, o el HELP de una métrica
+
+enum TipoPrometheus : uint8_t { PROMETHEUS_GAUGE, PROMETHEUS_COUNTER };
+
+// Valor de una serie; NAN si todavía no hay
+typedef double (*LectorPrometheus)(const void* contexto, uint8_t serie);
+
+// Valor de la etiqueta de una serie
+typedef const char* (*EtiquetaPrometheus)(const void* contexto, uint8_t serie);
+
+struct MetricaPrometheus {
+  const char* nombre;
+  const char* ayuda;
+  TipoPrometheus tipo;
+  LectorPrometheus leer;
+  const void* contexto;
+  const char* etiqueta;              // nullptr: una sola serie, sin etiqueta
+  EtiquetaPrometheus valorEtiqueta;
+  uint8_t series;
+};
+
+struct TablaPrometheus {
+  MetricaPrometheus metricas[PROMETHEUS_MAXIMO_METRICAS];
+  uint8_t cantidad;
+};
+
+void iniciarTablaPrometheus(TablaPrometheus* tabla);
+
+// Devuelven false si la tabla está llena
+bool agregarMetrica(TablaPrometheus* tabla, const char* nombre, const char* ayuda, TipoPrometheus tipo,
+                    LectorPrometheus leer, const void* contexto);
+bool agregarMetricaPorSerie(TablaPrometheus* tabla, const char* nombre, const char* ayuda, TipoPrometheus tipo,
+                            LectorPrometheus leer, const void* contexto, const char* etiqueta,
+                            EtiquetaPrometheus valorEtiqueta, uint8_t series);
+
+typedef void (*EscritorPrometheus)(void* contexto, const char* texto, size_t largo);
+
+// Escribe todas las métricas. Una serie que no entra entera en
+// PROMETHEUS_LARGO_LINEA no sale. Devuelve los bytes escritos.
+size_t escribirPrometheus(const TablaPrometheus& tabla, EscritorPrometheus escribir, void* contexto);
+
+#endif
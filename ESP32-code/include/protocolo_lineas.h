@@ -0,0 +1,33 @@
+#ifndef PROTOCOLO_LINEAS_H
+#define PROTOCOLO_LINEAS_H
+
+// Mediciones en el protocolo de líneas de InfluxDB, tal como las escribe
+// Telegraf con telegraf/telegraf.conf, para que los dashboards no se
+// enteren de quién escribió:
+//
+//   Mediciones-Pileta,host=Pileta1,topic=pool/metrics ph=7.42,temperature_c=26.1,...,device_id="ESP32_Pileta" 1750000000
+//
+// Todos los números van como float (como los deja el parser JSON de
+// Telegraf) y el timestamp en segundos (precision=s). Lo usan la salida
+// directa a InfluxDB del firmware (salida_influx.h) y el puente de la PC
+// (influx-bridge/). No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esquema.h"
+
+#define MEDICION_INFLUX "Mediciones-Pileta"
+
+// Comienzo de cada línea: medición y tags, con el espacio final. Escapa lo
+// que haga falta. Devuelve el largo o 0 si no entra en 'capacidad'.
+size_t armarPrefijoLinea(const char* medicion, const char* host, const char* topico, char* destino,
+                         size_t capacidad);
+
+// Lo que puede ocupar una línea además del prefijo
+constexpr size_t TAMANO_MAXIMO_CAMPOS_LINEA = TAMANO_MAXIMO_JSON + 12;
+
+// Escribe la línea de una medición (con el \n) en un buffer de al menos
+// largoPrefijo + TAMANO_MAXIMO_CAMPOS_LINEA bytes. Devuelve el largo.
+size_t escribirLinea(const Medicion& medicion, const char* prefijo, size_t largoPrefijo, char* destino);
+
+#endif
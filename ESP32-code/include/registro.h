@@ -0,0 +1,99 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+// Registro (log) del firmware. Cada mensaje se formatea donde se llama, en
+// una ranura de una cola sin locks, y una tarea de baja prioridad lo manda
+// al puerto serie (registro_uart.cpp). Quien registra no espera a la UART,
+// que a 9600 baudios tarda un milisegundo por carácter, y no usa el heap.
+//
+// El nivel se elige al compilar con -DNIVEL_REGISTRO=...: los mensajes de
+// niveles más detallados desaparecen, junto con sus argumentos.
+//
+//   REG_ERROR(...)       algo falló y se perdió algo (una medición, una conexión)
+//   REG_AVISO(...)       algo falló y se sigue (valor anterior, reintento)
+//   REG_INFO(...)        cambios de estado (conectado, publicado, hora)
+//   REG_DEPURACION(...)  cada lectura y cada payload
+//
+// Con la cola llena el mensaje se descarta y se cuenta; lo que no entra en
+// REGISTRO_LARGO_MENSAJE se corta y también se cuenta.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define REGISTRO_NADA 0
+#define REGISTRO_ERROR 1
+#define REGISTRO_AVISO 2
+#define REGISTRO_INFO 3
+#define REGISTRO_DEPURACION 4
+
+#ifndef NIVEL_REGISTRO
+#define NIVEL_REGISTRO REGISTRO_INFO
+#endif
+
+#define REGISTRO_RANURAS 32  // Potencia de 2
+#define REGISTRO_LARGO_MENSAJE 120
+
+// Un mensaje formateado: "<ms> <E|A|I|D> <texto>\n"
+#define REGISTRO_LARGO_LINEA (REGISTRO_LARGO_MENSAJE + 16)
+
+struct MensajeRegistro {
+  uint32_t ms;
+  uint8_t nivel;
+  uint8_t largo;
+  char texto[REGISTRO_LARGO_MENSAJE];
+};
+
+// Cola sin locks de varios productores (cualquier tarea) y un consumidor.
+// Cada productor reserva una ranura, la llena y la marca lista; el
+// consumidor las saca en orden de reserva.
+struct ColaRegistro {
+  MensajeRegistro ranuras[REGISTRO_RANURAS];
+  std::atomic<bool> listas[REGISTRO_RANURAS];
+  std::atomic<uint32_t> reservadas;
+  std::atomic<uint32_t> leidas;
+  std::atomic<uint32_t> descartados;
+  std::atomic<uint32_t> cortados;
+};
+
+// Solo sin productores andando
+void reiniciarColaRegistro(ColaRegistro* cola);
+
+// Productor. Devuelve false si la cola estaba llena.
+bool encolarRegistro(ColaRegistro* cola, uint8_t nivel, uint32_t ms, const char* formato, va_list argumentos);
+
+// Consumidor. Devuelve false si no hay nada listo.
+bool desencolarRegistro(ColaRegistro* cola, MensajeRegistro* mensaje);
+
+// El mensaje como línea de texto. Devuelve el largo.
+size_t formatearRegistro(const MensajeRegistro& mensaje, char* destino, size_t largo);
+
+// Lo que usan las macros; registro_uart.cpp
+void registrar(uint8_t nivel, const char* formato, ...) __attribute__((format(printf, 2, 3)));
+
+#if NIVEL_REGISTRO >= REGISTRO_ERROR
+#define REG_ERROR(...) registrar(REGISTRO_ERROR, __VA_ARGS__)
+#else
+#define REG_ERROR(...) do {} while (0)
+#endif
+
+#if NIVEL_REGISTRO >= REGISTRO_AVISO
+#define REG_AVISO(...) registrar(REGISTRO_AVISO, __VA_ARGS__)
+#else
+#define REG_AVISO(...) do {} while (0)
+#endif
+
+#if NIVEL_REGISTRO >= REGISTRO_INFO
+#define REG_INFO(...) registrar(REGISTRO_INFO, __VA_ARGS__)
+#else
+#define REG_INFO(...) do {} while (0)
+#endif
+
+#if NIVEL_REGISTRO >= REGISTRO_DEPURACION
+#define REG_DEPURACION(...) registrar(REGISTRO_DEPURACION, __VA_ARGS__)
+#else
+#define REG_DEPURACION(...) do {} while (0)
+#endif
+
+#endif
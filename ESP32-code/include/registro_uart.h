@@ -0,0 +1,52 @@
+#ifndef REGISTRO_UART_H
+#define REGISTRO_UART_H
+
+// Salida del registro (registro.h): una tarea de FreeRTOS de baja prioridad
+// saca los mensajes de la cola y los manda por Serial.
+//
+// Con -DREGISTRO_FLASH=1 los mensajes de REGISTRO_NIVEL_FLASH para arriba
+// (por defecto errores y avisos) se guardan además en LittleFS, en binario
+// (ms, nivel, largo y texto), para verlos después de un reinicio en
+// /registro. Al pasar REGISTRO_FLASH_MAX_BYTES, el archivo pasa a ser el
+// anterior y se empieza otro: quedan como mucho dos.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "registro.h"
+
+#ifndef REGISTRO_FLASH
+#define REGISTRO_FLASH 0
+#endif
+#ifndef REGISTRO_NIVEL_FLASH
+#define REGISTRO_NIVEL_FLASH REGISTRO_AVISO
+#endif
+
+#define REGISTRO_ARCHIVO "/registro.bin"
+#define REGISTRO_ARCHIVO_ANTERIOR "/registro.old"
+#define REGISTRO_FLASH_MAX_BYTES (32 * 1024)
+
+#define REGISTRO_PERIODO_MS 20       // Cada cuánto mira la cola la tarea
+#define REGISTRO_PILA_TAREA 4096
+#define REGISTRO_PRIORIDAD_TAREA 1  // La de loop(), que casi siempre está en delay()
+
+// Largo máximo de un informe de describirRegistro()
+#define REGISTRO_LARGO_INFORME 160
+
+// Llamar en setup(), después de Serial.begin(). Lo registrado antes queda
+// en la cola.
+void iniciarRegistro();
+
+// Manda todo lo pendiente, desde la tarea que llama. Antes de reiniciar.
+void vaciarRegistro();
+
+// Contadores en JSON (GET /api/log). Devuelve el largo.
+size_t describirRegistro(char* destino, size_t largo);
+
+// Lo guardado en flash, del más viejo al más nuevo, de a una línea
+typedef void (*EscritorRegistro)(void* contexto, const char* linea, size_t largo);
+void leerRegistroFlash(EscritorRegistro escribir, void* contexto);
+
+// Borra lo guardado en flash
+void borrarRegistroFlash();
+
+#endif
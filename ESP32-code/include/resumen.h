@@ -0,0 +1,51 @@
+#ifndef RESUMEN_H
+#define RESUMEN_H
+
+// Resúmenes por ventana de tiempo (rollups): cantidad, mínimo, máximo,
+// promedio y desvío estándar de pH, temperatura y TDS. Cada medición se
+// suma en O(1), con el método de Welford para la varianza, sin guardar las
+// muestras. Un campo rechazado (el sensor no dio un valor válido y quedó el
+// anterior) no se suma a ese campo, así que cada campo lleva su cantidad.
+//
+// Las ventanas van alineadas al reloj (p. ej. de 10:15:00 a 10:30:00). Una
+// ventana se cierra con la primera medición de la siguiente; si la hora va
+// para atrás, lo acumulado se descarta. No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esquema.h"
+
+// Campos que se resumen
+constexpr IndiceCampo CAMPOS_RESUMEN[] = {CAMPO_PH, CAMPO_TEMPERATURA, CAMPO_TDS};
+constexpr size_t CANTIDAD_CAMPOS_RESUMEN = sizeof(CAMPOS_RESUMEN) / sizeof(CAMPOS_RESUMEN[0]);
+
+#define RESUMEN_LARGO_JSON 512
+
+struct AcumuladoCampo {
+  uint32_t cantidad;       // Mediciones no rechazadas de este campo
+  int64_t minimo, maximo;  // En el punto fijo del esquema
+  double media;            // Ídem, con decimales
+  double m2;               // Suma de los cuadrados de las diferencias con la media
+};
+
+struct Resumen {
+  uint32_t segundos;       // Largo de la ventana
+  uint32_t inicio;         // Timestamp del comienzo de la ventana en curso
+  uint32_t cantidad;       // Mediciones de la ventana, rechazadas o no. 0: vacía
+  AcumuladoCampo campos[CANTIDAD_CAMPOS_RESUMEN];
+};
+
+void iniciarResumen(Resumen* resumen, uint32_t segundos);
+
+// Suma la medición a su ventana. 'rechazadas' tiene un bit por campo de
+// CAMPOS_RESUMEN, en ese orden (el de Lectura::rechazadas): esos campos no
+// se suman. Si con eso se cerró la anterior, la copia en 'cerrado' y
+// devuelve true.
+bool agregarAResumen(Resumen* resumen, const Medicion& medicion, uint8_t rechazadas, Resumen* cerrado);
+
+// El resumen en JSON (terminado en \0), con el timestamp del comienzo de la
+// ventana. Un campo sin mediciones válidas va solo con su cantidad en 0.
+// Devuelve el largo sin el \0.
+size_t codificarResumenJson(const Resumen& resumen, const char* idDispositivo, char* destino, size_t capacidad);
+
+#endif
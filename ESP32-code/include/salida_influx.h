@@ -0,0 +1,88 @@
+#ifndef SALIDA_INFLUX_H
+#define SALIDA_INFLUX_H
+
+// Salida directa a InfluxDB (-DSALIDA_INFLUX=1): en lugar de publicar en
+// MQTT para que Telegraf lo pase a InfluxDB, cada lote se escribe con un
+// POST a /api/v2/write, en el protocolo de líneas (protocolo_lineas.h).
+// Para instalaciones de una sola pileta, sin mosquitto ni Telegraf.
+//
+// La conexión HTTP queda abierta entre escrituras. Si se puede, el cuerpo
+// va comprimido con gzip (gzip.h); si no achica o no entra, va plano.
+//
+// Si una escritura falla, las líneas se agregan al diario en LittleFS
+// (DIARIO_INFLUX_ARCHIVO). Cuando InfluxDB vuelve a responder, el diario se
+// reenvía de a DIARIO_INFLUX_TRAMO bytes y se borra. Reenviar una línea que
+// ya estaba no duplica nada: InfluxDB pisa el punto con el mismo timestamp.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esquema.h"
+
+#ifndef SALIDA_INFLUX
+#define SALIDA_INFLUX 0
+#endif
+
+// Los mismos valores por defecto que el .env del docker-compose
+#ifndef INFLUX_ORG
+#define INFLUX_ORG "mi-org"
+#endif
+#ifndef INFLUX_BUCKET
+#define INFLUX_BUCKET "pileta"
+#endif
+#ifndef INFLUX_TOKEN
+#define INFLUX_TOKEN "dev-token-1234567890"
+#endif
+
+// Tags de cada línea: los que pone Telegraf, así los dashboards no cambian
+#ifndef INFLUX_TAG_HOST
+#define INFLUX_TAG_HOST "Pileta1"
+#endif
+#define INFLUX_TAG_TOPICO "pool/metrics"
+
+#ifndef COMPRIMIR_INFLUX
+#define COMPRIMIR_INFLUX 1
+#endif
+
+#define INFLUX_PUERTO_POR_DEFECTO 8086
+#define INFLUX_TIMEOUT_MS 5000
+
+#define DIARIO_INFLUX_ARCHIVO "/diario_influx.txt"
+#define DIARIO_INFLUX_MAX_BYTES (256 * 1024)  // Lo que no entra se descarta (y se cuenta)
+#define DIARIO_INFLUX_TRAMO 2048              // Bytes del diario por escritura
+
+// Largo máximo de un informe de describirInflux()
+#define INFLUX_LARGO_INFORME 512
+
+struct EstadisticasInflux {
+  uint32_t escrituras;         // Exitosas (lotes y tramos del diario)
+  uint32_t fallos;
+  int ultimoCodigo;            // HTTP, o negativo si no hubo respuesta (HTTPClient)
+  uint32_t msUltima;           // Duración de la escritura, del POST a la respuesta
+  uint32_t msMaxima;
+  uint64_t msTotal;
+  uint64_t bytesEnviados;      // Lo que salió por la red
+  uint64_t bytesSinComprimir;  // Lo mismo antes de gzip
+  uint32_t lineasAlDiario;
+  uint32_t lineasDescartadas;  // Con el diario lleno
+  uint32_t lineasRecuperadas;  // Reenviadas desde el diario
+  uint32_t lineasRechazadas;   // InfluxDB respondió 4xx: no se reintentan
+};
+
+// Servidor y puerto que cargó el portal. Llamar antes de publicar y cada
+// vez que cambien.
+void configurarSalidaInflux(const char* servidor, uint16_t puerto);
+
+// Escribe las mediciones en InfluxDB. Si falla, quedan en el diario.
+// Devuelve true si se escribieron.
+bool publicarEnInflux(const Medicion* mediciones, uint8_t cantidad);
+
+// Llamar en cada loop(): si hay diario y la última escritura salió bien,
+// reenvía el próximo tramo.
+void vaciarDiarioInflux();
+
+const EstadisticasInflux& estadisticasInflux();
+
+// Estadísticas en JSON (GET /api/influx). Devuelve el largo.
+size_t describirInflux(char* destino, size_t largo);
+
+#endif
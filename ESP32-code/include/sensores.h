@@ -0,0 +1,66 @@
+#ifndef SENSORES_H
+#define SENSORES_H
+
+// Lógica de procesamiento de los sensores (pH, temperatura y TDS).
+// No depende de Arduino: la usa el firmware y también el replay nativo
+// (src/replay), así una traza grabada pasa exactamente por el mismo código.
+
+#include <stdint.h>
+#include "ezo.h"
+
+#define VREF 3.3      // Voltaje de referencia del ESP32
+#define SCOUNT 30     // Número de muestras para promedio
+
+// Bits de Lectura::rechazadas, en el orden de MetricaAnomalia (anomalias.h)
+#define RECHAZADO_PH (1 << 0)
+#define RECHAZADO_TEMPERATURA (1 << 1)
+#define RECHAZADO_TDS (1 << 2)
+
+// Lectura completa que entrega cada política de sensores al firmware
+struct Lectura {
+  float ph;
+  float temperatura;
+  float tds;
+  const char* tendencia;
+  int valorTendencia;
+  uint8_t rechazadas;  // Sensores que no dieron un valor válido (se usó el anterior)
+
+  // Lo que dio cada sensor, aunque se haya rechazado (NAN si no respondió
+  // con un número). Sin rechazo es el mismo valor de arriba.
+  float phCrudo;
+  float temperaturaCruda;
+  float tdsCrudo;
+};
+
+// Últimos valores válidos de cada sensor
+extern float valorPh;
+extern float temperaturaAnterior;
+extern float valorTdsAnterior;
+
+// Último valor que dio cada sensor, válido o no (NAN si no respondió con
+// un número): lo que va en la alerta de una lectura rechazada
+extern float phCrudo;
+extern float temperaturaCruda;
+extern float tdsCrudo;
+
+// Voltaje calculado en la última muestra de TDS (solo informativo)
+extern float ultimoVoltajeTds;
+
+// Vuelve todo el estado al valor de arranque
+void reiniciarSensores();
+
+// Cada función recibe el dato crudo (respuesta del EZO o código ADC),
+// actualiza el valor anterior si la lectura es válida y devuelve true.
+// Si la lectura se descarta, el valor anterior queda como está. Solo se
+// descarta lo que no es un número o está fuera del rango físico del
+// sensor: los saltos los ve el detector de anomalías (anomalias.h).
+bool procesarPh(const char* respuesta);
+bool procesarTemperatura(const char* respuesta);
+bool procesarTds(int codigoAdc);
+
+// Lo mismo con la respuesta que ya clasificó el lector del EZO, sin volver
+// a leer el texto: 'milesimas' es el valor si 'tipo' es EZO_VALOR
+bool procesarPhEzo(TipoRespuestaEzo tipo, int32_t milesimas);
+bool procesarTemperaturaEzo(TipoRespuestaEzo tipo, int32_t milesimas);
+
+#endif
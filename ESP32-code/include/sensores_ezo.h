@@ -0,0 +1,269 @@
+#ifndef SENSORES_EZO_H
+#define SENSORES_EZO_H
+
+#include <Arduino.h>
+#include "esquema.h"
+#include "ezo.h"
+#include "registro.h"
+#include "sensores.h"
+#include "traza.h"
+#include "uart_ezo.h"
+
+// Pines de hardware
+#define PH_PIN 34
+#define TDS_PIN 35
+
+// Tiempo máximo de espera de una respuesta del EZO (una lectura tarda ~900 ms)
+#define TIMEOUT_EZO_MS 1500
+
+// Modo continuo (-DEZO_CONTINUO=1): el EZO manda una lectura de pH por
+// segundo sola ("C,1") y leer() toma la última, sin esperar. Si dejan de
+// llegar por EZO_EDAD_MAXIMA_MS se vuelve a consultar con "R" y se prueba
+// reactivarlo cada EZO_REINTENTO_CONTINUO_MS.
+//
+// El modo continuo solo trae pH: la temperatura se sigue consultando con
+// "RT", con la salida pausada ("C,0") para que la respuesta no se mezcle
+// con las lecturas, cada EZO_PERIODO_TEMPERATURA_MS.
+#ifndef EZO_CONTINUO
+#define EZO_CONTINUO 0
+#endif
+#define EZO_EDAD_MAXIMA_MS 5000
+#define EZO_REINTENTO_CONTINUO_MS 60000
+#define EZO_PERIODO_TEMPERATURA_MS 60000
+
+// Política de sensores: Atlas Scientific EZO-pH + PT-1000 por Serial2 y
+// sensor TDS analógico. Es la configuración de la pileta real.
+class SensoresEzo {
+ public:
+  void iniciar() {
+    Serial2.begin(9600); // Para comunicación con Atlas Scientific EZO-pH
+    iniciarUartEzo();
+
+    // Configurar pines analógicos
+    pinMode(TDS_PIN, INPUT);
+
+    // Inicializar estado de los sensores
+    reiniciarSensores();
+    iniciarTraza();
+
+#if EZO_CONTINUO
+    activarContinuo();
+#endif
+  }
+
+  // Llamado seguido desde loop(), entre lecturas: en modo continuo toma lo
+  // que llegó, así la cola no se llena aunque las lecturas sean espaciadas
+  void atender() {
+#if EZO_CONTINUO
+    vigilarContinuo();
+#endif
+  }
+
+  Lectura leer() {
+    Lectura lectura;
+    rechazadas = 0;
+#if EZO_CONTINUO
+    vigilarContinuo();
+    lectura.ph = continuo ? phContinuo() : readPH();
+    lectura.temperatura = continuo ? temperaturaContinuo() : readTemperature();
+#else
+    lectura.ph = readPH();
+    lectura.temperatura = readTemperature();
+#endif
+    lectura.tds = readTDS();
+    lectura.tendencia = TENDENCIA_ESTABLE;
+    lectura.valorTendencia = 0;
+    lectura.rechazadas = rechazadas;
+    lectura.phCrudo = phCrudo;
+    lectura.temperaturaCruda = temperaturaCruda;
+    lectura.tdsCrudo = tdsCrudo;
+    return lectura;
+  }
+
+ private:
+  // Espera la próxima línea del EZO que no sea *OK (o que sea *OK, con
+  // 'aceptarOk'). Devuelve su clasificación, o EZO_INCOMPLETA si no llegó a
+  // tiempo. La línea queda en respuesta.linea.
+  TipoRespuestaEzo esperarEzo(bool aceptarOk) {
+    unsigned long inicio = millis();
+    while (millis() - inicio < TIMEOUT_EZO_MS) {
+      while (siguienteLineaEzo(&respuesta)) {
+        if (respuesta.tipo != EZO_OK || aceptarOk) return respuesta.tipo;
+      }
+      delay(10);
+    }
+
+    respuesta.linea[0] = '\0';
+    return EZO_INCOMPLETA;
+  }
+
+  // Envía un comando al EZO y espera su respuesta. Las líneas llegan por la
+  // cola de uart_ezo.h, sin usar heap.
+  TipoRespuestaEzo consultarEzo(const char* comando) {
+    // Descartar lo que haya quedado de respuestas anteriores
+    descartarLineasEzo();
+    Serial2.print(comando);
+    return esperarEzo(false);
+  }
+
+#if EZO_CONTINUO
+  // Manda "C,0" o "C,1" y espera el *OK. Las lecturas que lleguen antes son
+  // del modo continuo y se toman como pH.
+  bool cambiarContinuo(const char* comando) {
+    Serial2.print(comando);
+    TipoRespuestaEzo tipo;
+    while ((tipo = esperarEzo(true)) == EZO_VALOR) tomarPhContinuo();
+    return tipo == EZO_OK;
+  }
+
+  void activarContinuo() {
+    ultimoIntentoContinuo = millis();
+    phContinuoAceptado = false;
+    descartarLineasEzo();
+    if (!cambiarContinuo("C,1\r")) {
+      REG_AVISO("El EZO no aceptó el modo continuo, se sigue consultando");
+      return;
+    }
+    continuo = true;
+    ultimaLecturaContinua = millis();
+    REG_INFO("EZO en modo continuo");
+  }
+
+  // Toma todo lo que llegó desde la última vez y mira si el modo continuo
+  // sigue vivo
+  void vigilarContinuo() {
+    while (siguienteLineaEzo(&respuesta)) {
+      if (respuesta.tipo == EZO_VALOR) tomarPhContinuo();
+    }
+
+    if (continuo && millis() - ultimaLecturaContinua > EZO_EDAD_MAXIMA_MS) {
+      continuo = false;
+      caidasContinuo++;
+      ultimoIntentoContinuo = millis();
+      REG_AVISO("El EZO dejó de mandar lecturas (%u veces), se vuelve a consultar", (unsigned)caidasContinuo);
+    }
+    if (!continuo && millis() - ultimoIntentoContinuo >= EZO_REINTENTO_CONTINUO_MS) activarContinuo();
+  }
+
+  void tomarPhContinuo() {
+    ultimaLecturaContinua = respuesta.ms;
+    phContinuoAceptado = procesarPhEzo(respuesta.tipo, respuesta.valor);
+    if (phContinuoAceptado) lecturasContinuas++;
+    registrarTraza(TRAZA_PH, valorPh, respuesta.linea);
+  }
+
+  // Sin una línea aceptada desde que se activó, o si la última se descartó,
+  // el pH es el anterior y va como rechazado
+  float phContinuo() {
+    if (!phContinuoAceptado) {
+      REG_AVISO("Sin lectura de pH válida en modo continuo, usando valor anterior");
+      rechazadas |= RECHAZADO_PH;
+      return valorPh;
+    }
+    REG_DEPURACION("Lectura pH: %.2f (continuo, de hace %lu ms, %lu lecturas, %lu perdidas)", valorPh,
+                   millis() - ultimaLecturaContinua, (unsigned long)lecturasContinuas,
+                   (unsigned long)lineasPerdidasEzo());
+    return valorPh;
+  }
+
+  float temperaturaContinuo() {
+    if (hayTemperatura && millis() - ultimaTemperatura < EZO_PERIODO_TEMPERATURA_MS) return temperaturaAnterior;
+
+    if (!cambiarContinuo("C,0\r")) {
+      // Sin el *OK no se puede saber qué línea es la temperatura
+      REG_AVISO("No se pudo pausar el modo continuo, temperatura anterior");
+      rechazadas |= RECHAZADO_TEMPERATURA;
+      temperaturaCruda = NAN;
+      return temperaturaAnterior;
+    }
+    float temperatura = readTemperature();
+    hayTemperatura = true;
+    ultimaTemperatura = millis();
+    if (!cambiarContinuo("C,1\r")) {
+      continuo = false;
+      caidasContinuo++;
+      ultimoIntentoContinuo = millis();
+      REG_AVISO("El EZO no volvió al modo continuo, se vuelve a consultar");
+    }
+    return temperatura;
+  }
+#endif
+
+  static const char* describirRespuestaEzo(TipoRespuestaEzo tipo) {
+    switch (tipo) {
+      case EZO_INCOMPLETA: return "sin respuesta";
+      case EZO_VALOR: return "valor fuera de rango";
+      case EZO_ER: return "*ER";
+      case EZO_OV: return "*OV sobretensión";
+      case EZO_UV: return "*UV subtensión";
+      case EZO_RS: return "*RS reinicio";
+      case EZO_DESBORDE: return "línea demasiado larga";
+      default: return "respuesta inválida";
+    }
+  }
+
+  float readPH() {
+    // Enviar comando para leer pH
+    TipoRespuestaEzo tipo = consultarEzo("R\r");
+    // El valor ya viene en milésimas del lector de la UART
+    bool valida = procesarPhEzo(tipo, respuesta.valor);
+    registrarTraza(TRAZA_PH, valorPh, respuesta.linea);
+
+    if (valida) {
+      REG_DEPURACION("Lectura pH: %.2f", valorPh);
+    } else {
+      // Si no hay respuesta válida, mantener último valor conocido
+      REG_AVISO("Error leyendo pH (%s), usando valor anterior", describirRespuestaEzo(tipo));
+      rechazadas |= RECHAZADO_PH;
+    }
+    return valorPh;
+  }
+
+  float readTemperature() {
+    // Enviar comando para leer temperatura del PT-1000
+    TipoRespuestaEzo tipo = consultarEzo("RT\r");
+    bool valida = procesarTemperaturaEzo(tipo, respuesta.valor);
+    registrarTraza(TRAZA_TEMPERATURA, temperaturaAnterior, respuesta.linea);
+
+    if (valida) {
+      REG_DEPURACION("Lectura Temperatura: %.1f C", temperaturaAnterior);
+    } else {
+      // Si no hay respuesta válida, mantener último valor conocido
+      REG_AVISO("Error leyendo temperatura (%s), usando valor anterior", describirRespuestaEzo(tipo));
+      rechazadas |= RECHAZADO_TEMPERATURA;
+    }
+    return temperaturaAnterior;
+  }
+
+  float readTDS() {
+    // Leer valor analógico del sensor TDS
+    int codigoAdc = analogRead(TDS_PIN);
+    bool valida = procesarTds(codigoAdc);
+    registrarTraza(TRAZA_TDS, valorTdsAnterior, codigoAdc);
+
+    if (valida) {
+      REG_DEPURACION("Lectura TDS: %.0f ppm (Voltaje: %.3fV)", valorTdsAnterior, ultimoVoltajeTds);
+    } else {
+      // Si la lectura es inválida, mantener valor anterior
+      REG_AVISO("Error leyendo TDS, usando valor anterior");
+      rechazadas |= RECHAZADO_TDS;
+    }
+    return valorTdsAnterior;
+  }
+
+  LineaEzo respuesta;  // Última línea leída de la cola
+  uint8_t rechazadas = 0;  // De la lectura en curso (RECHAZADO_*)
+
+#if EZO_CONTINUO
+  bool continuo = false;
+  unsigned long ultimaLecturaContinua = 0;
+  unsigned long ultimoIntentoContinuo = 0;
+  bool hayTemperatura = false;
+  unsigned long ultimaTemperatura = 0;
+  bool phContinuoAceptado = false;  // La última línea del modo continuo
+  uint32_t lecturasContinuas = 0;
+  uint32_t caidasContinuo = 0;
+#endif
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SENSORES_REPLAY_H
+#define SENSORES_REPLAY_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "esquema.h"
+#include "registro.h"
+#include "sensores.h"
+#include "traza.h"
+
+// Política de sensores: reproduce en el equipo una traza grabada en
+// LittleFS (ver traza.h) pasándola por el mismo procesamiento que las
+// lecturas reales. Cada lectura consume un registro de pH, uno de
+// temperatura y uno de TDS; al llegar al final vuelve a empezar.
+class SensoresReplay {
+ public:
+  void iniciar() {
+    reiniciarSensores();
+
+    if (!LittleFS.begin(true) || !LittleFS.exists(TRAZA_ARCHIVO)) {
+      REG_AVISO("No hay traza en %s, se publicarán valores iniciales", TRAZA_ARCHIVO);
+      return;
+    }
+    archivo = LittleFS.open(TRAZA_ARCHIVO, "r");
+    REG_INFO("Reproduciendo traza %s", TRAZA_ARCHIVO);
+  }
+
+  // Nada que hacer entre lecturas
+  void atender() {}
+
+  Lectura leer() {
+    bool tienePh = false, tieneTemperatura = false, tieneTds = false;
+    bool volvioAlInicio = false;
+    uint8_t rechazadas = 0;
+
+    while (archivo && !(tienePh && tieneTemperatura && tieneTds)) {
+      if (!archivo.available()) {
+        // Traza sin registros útiles: no quedarse dando vueltas
+        if (volvioAlInicio) break;
+        archivo.seek(0);
+        volvioAlInicio = true;
+        continue;
+      }
+
+      char linea[TRAZA_LARGO_LINEA];
+      linea[archivo.readBytesUntil('\n', linea, sizeof(linea) - 1)] = '\0';
+      RegistroTraza registro;
+      if (!leerRegistroTraza(linea, &registro)) continue;
+
+      switch (registro.tipo) {
+        case TRAZA_PH:
+          if (!procesarPh(registro.crudo)) rechazadas |= RECHAZADO_PH;
+          tienePh = true;
+          break;
+        case TRAZA_TEMPERATURA:
+          if (!procesarTemperatura(registro.crudo)) rechazadas |= RECHAZADO_TEMPERATURA;
+          tieneTemperatura = true;
+          break;
+        case TRAZA_TDS:
+          if (!procesarTds(atoi(registro.crudo))) rechazadas |= RECHAZADO_TDS;
+          tieneTds = true;
+          break;
+      }
+    }
+
+    Lectura lectura;
+    lectura.ph = valorPh;
+    lectura.temperatura = temperaturaAnterior;
+    lectura.tds = valorTdsAnterior;
+    lectura.tendencia = TENDENCIA_ESTABLE;
+    lectura.valorTendencia = 0;
+    lectura.rechazadas = rechazadas;
+    lectura.phCrudo = phCrudo;
+    lectura.temperaturaCruda = temperaturaCruda;
+    lectura.tdsCrudo = tdsCrudo;
+
+    REG_DEPURACION("Lectura reproducida - pH: %.2f, Temp: %.1f C, TDS: %.0f ppm",
+                   lectura.ph, lectura.temperatura, lectura.tds);
+    return lectura;
+  }
+
+ private:
+  File archivo;
+};
+
+#endif
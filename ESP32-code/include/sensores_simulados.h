@@ -0,0 +1,66 @@
+#ifndef SENSORES_SIMULADOS_H
+#define SENSORES_SIMULADOS_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "esquema.h"
+#include "registro.h"
+#include "sensores.h"
+
+// Política de sensores: lecturas simuladas con senoidales + ruido, para
+// probar el resto del sistema sin hardware (misma idea que lecture-simulator).
+class SensoresSimulados {
+ public:
+  void iniciar() {}
+
+  // Nada que hacer entre lecturas
+  void atender() {}
+
+  Lectura leer() {
+    // Incrementar ángulo para variaciones suaves
+    anguloSimulacion += 0.2;
+
+    // Generar variaciones realistas usando funciones senoidales + ruido
+    float variacionPh = 0.15 * sin(anguloSimulacion) + random(-50, 51) / 1000.0; // ±0.05
+    float variacionTemp = 1.5 * sin(anguloSimulacion / 3.0) + random(-30, 31) / 100.0; // ±0.3
+    float variacionTds = 30.0 * sin(anguloSimulacion / 4.0) + random(-10, 11); // ±10
+
+    // Calcular valores actuales y asegurar rangos válidos
+    Lectura lectura;
+    lectura.ph = constrain(phBase + variacionPh, 6.0, 8.5);
+    lectura.temperatura = constrain(temperaturaBase + variacionTemp, 20.0, 35.0);
+    lectura.tds = constrain(tdsBase + variacionTds, 200, 1000);
+    lectura.rechazadas = 0;
+    lectura.phCrudo = lectura.ph;
+    lectura.temperaturaCruda = lectura.temperatura;
+    lectura.tdsCrudo = lectura.tds;
+
+    // Determinar tendencia basada en el ángulo de simulación
+    float deltaSeno = sin(anguloSimulacion) - sin(anguloSimulacion - 0.2);
+    if (deltaSeno > 0.01) {
+      lectura.tendencia = TENDENCIA_SUBIENDO;
+      lectura.valorTendencia = 1;
+    } else if (deltaSeno < -0.01) {
+      lectura.tendencia = TENDENCIA_BAJANDO;
+      lectura.valorTendencia = -1;
+    } else {
+      lectura.tendencia = TENDENCIA_ESTABLE;
+      lectura.valorTendencia = 0;
+    }
+
+    contadorLecturas++;
+    REG_DEPURACION("Lectura simulada #%lu - pH: %.2f, Temp: %.1f C, TDS: %.0f ppm",
+                   contadorLecturas, lectura.ph, lectura.temperatura, lectura.tds);
+    return lectura;
+  }
+
+ private:
+  float phBase = 7.4;
+  float temperaturaBase = 25.0;
+  float tdsBase = 500.0;
+
+  float anguloSimulacion = 0.0;
+  unsigned long contadorLecturas = 0;
+};
+
+#endif
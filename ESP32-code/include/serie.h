@@ -0,0 +1,91 @@
+#ifndef SERIE_H
+#define SERIE_H
+
+// Compresión de series de mediciones al estilo Gorilla, para lotes e
+// historial. Aprovecha que los valores de la pileta cambian poco de una
+// lectura a la otra:
+//
+//   - timestamp: diferencia entre deltas sucesivos (delta-of-delta), casi
+//     siempre 0 con un intervalo fijo
+//   - el resto de los campos numéricos del esquema: diferencia con la
+//     lectura anterior, en punto fijo (los decimales de esquema.h), así que
+//     no hay error de redondeo
+//
+// Formato:
+//
+//   versión (1)  cantidad (u16)  largo de device_id (1)  device_id
+//   bits, del más significativo al menos significativo:
+//     primera medición: cada campo numérico en 32 bits, en orden del esquema
+//     siguientes: cada campo con un código de largo variable
+//       '0'                  sin cambio
+//       '10'   + corto       diferencia chica (zigzag)
+//       '110'  + mediano
+//       '1110' + largo
+//       '1111' + 32 bits     el valor completo
+//
+// Los largos de cada código están en serie.cpp. La tendencia (texto) no se
+// guarda: el decodificador la arma desde trend_value. No depende de Arduino.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esquema.h"
+
+#define SERIE_VERSION 1
+#define SERIE_ENCABEZADO_MAXIMO (4 + 32)  // Con device_id de 32
+
+// Campos numéricos del esquema (el timestamp incluido)
+constexpr size_t contarCamposNumericos() {
+  size_t cantidad = 0;
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (CAMPOS_MEDICION[i].tipo == CAMPO_NUMERO) cantidad++;
+  }
+  return cantidad;
+}
+constexpr size_t CAMPOS_NUMERICOS_SERIE = contarCamposNumericos();
+
+// Peor caso para 'mediciones' mediciones: la primera en 32 bits por campo y
+// las demás con el código de escape (4 + 32 bits) en todos los campos
+constexpr size_t tamanoMaximoSerie(size_t mediciones) {
+  size_t bits = mediciones == 0 ? 0 : CAMPOS_NUMERICOS_SERIE * (32 + (mediciones - 1) * 36);
+  return SERIE_ENCABEZADO_MAXIMO + (bits + 7) / 8;
+}
+
+struct CompresorSerie {
+  uint8_t* datos;
+  size_t capacidad;
+  size_t bits;             // Escritos, encabezado incluido
+  uint16_t cantidad;
+  int64_t anteriores[CANTIDAD_CAMPOS];
+  int64_t deltaTiempo;
+};
+
+// Empieza una serie en 'datos'. Devuelve false si no entra ni el encabezado.
+bool iniciarCompresor(CompresorSerie* compresor, uint8_t* datos, size_t capacidad,
+                      const char* idDispositivo);
+
+// Agrega una medición. Si no entra devuelve false y la serie queda como
+// estaba (se puede mandar y empezar otra).
+bool agregarMedicion(CompresorSerie* compresor, const Medicion& medicion);
+
+// Bytes que ocupa la serie hasta ahora
+size_t largoSerie(const CompresorSerie& compresor);
+
+struct LectorSerie {
+  const uint8_t* datos;
+  size_t largo;
+  size_t bit;
+  uint16_t restantes;
+  bool primera;
+  int64_t anteriores[CANTIDAD_CAMPOS];
+  int64_t deltaTiempo;
+  char idDispositivo[33];
+};
+
+// Devuelve false si el encabezado no es válido
+bool iniciarLectorSerie(LectorSerie* lector, const uint8_t* datos, size_t largo);
+
+// Lee la siguiente medición. Los textos apuntan al lector. Devuelve false
+// al terminar o si los datos no son válidos (ver lector.restantes).
+bool leerMedicion(LectorSerie* lector, Medicion* medicion);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TRANSPORTE_PLANO_H
+#define TRANSPORTE_PLANO_H
+
+#include <WiFi.h>
+
+// Identificador que va en el campo device_id; cada pileta puede definir el suyo
+#ifndef ID_DISPOSITIVO
+#define ID_DISPOSITIVO "ESP32_Pileta"
+#endif
+
+// Política de transporte: MQTT sin cifrar contra un broker local
+// (Mosquitto del docker-compose). IP y puerto del broker se cargan
+// desde el portal de configuración.
+class TransportePlano {
+ public:
+  static constexpr bool pideBroker = true;     // El portal pide IP y puerto
+  static constexpr bool necesitaHora = false;  // No valida certificados
+
+  static constexpr const char* camposPortal = R"rawliteral(
+            <div class="grupo-campo">
+                <label class="etiqueta" for="broker">MQTT Broker IP:</label>
+                <input type="text" id="broker" name="broker" class="campo-entrada" placeholder="192.168.1.100" required>
+            </div>
+            
+            <div class="grupo-campo">
+                <label class="etiqueta" for="port">MQTT Broker Puerto:</label>
+                <input type="number" id="port" name="port" class="campo-entrada" value="1883" required>
+            </div>
+            
+)rawliteral";
+
+  bool iniciar() { return true; }
+
+  Client& cliente() { return espClient; }
+
+  const char* idCliente() const { return "ESP32Client"; }
+
+  const char* idDispositivo() const { return ID_DISPOSITIVO; }
+
+  // Sin broker fijo: lo define el portal
+  const char* servidor() const { return nullptr; }
+  int puerto() const { return 1883; }
+
+ private:
+  WiFiClient espClient;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TRANSPORTE_TLS_H
+#define TRANSPORTE_TLS_H
+
+#include <WiFiClientSecure.h>
+#include "registro.h"
+#include "secretidirigillo.h"
+
+// Política de transporte: MQTT sobre TLS contra AWS IoT Core, autenticado
+// con los certificados X.509 de secretidirigillo.h. El broker es fijo, así
+// que el portal solo pide la red WiFi.
+class TransporteTls {
+ public:
+  static constexpr bool pideBroker = false;
+  static constexpr bool necesitaHora = true;  // Validar certificados
+
+  static constexpr const char* camposPortal = R"rawliteral(
+            <p class="etiqueta">Broker: AWS IoT Core (SSL/TLS con certificados)</p>
+
+)rawliteral";
+
+  bool iniciar() {
+    REG_INFO("Configurando certificados para AWS IoT...");
+
+    // Root CA, certificado del cliente y clave privada
+    clienteSeguro.setCACert(cacert);
+    clienteSeguro.setCertificate(client_cert);
+    clienteSeguro.setPrivateKey(privkey);
+
+    // Configurar timeout para conexiones
+    clienteSeguro.setTimeout(10);
+
+    REG_INFO("Certificados configurados");
+    return true;
+  }
+
+  Client& cliente() { return clienteSeguro; }
+
+  const char* idCliente() const { return THINGNAME; }
+  const char* idDispositivo() const { return THINGNAME; }
+
+  const char* servidor() const { return MQTT_HOST; }
+  int puerto() const { return MQTT_PORT; }
+
+ private:
+  WiFiClientSecure clienteSeguro;
+};
+
+#endif
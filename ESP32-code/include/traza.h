@@ -0,0 +1,88 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+// Grabación de trazas de sensores para el replay nativo (src/replay).
+//
+// Cada lectura se guarda como una línea de texto:
+//
+//   @t,<millis>,<tipo>,<salida>,<dato crudo>
+//
+//   tipo  'p' = respuesta del EZO a "R"   (pH)
+//         't' = respuesta del EZO a "RT"  (temperatura)
+//         'a' = código ADC del sensor TDS
+//   salida = valor que devolvió el firmware para esa lectura
+//
+// El dato crudo va al final porque la respuesta del EZO puede traer comas.
+// Las líneas empiezan con "@t," para poder separarlas del resto del log serie.
+//
+// El modo se elige al compilar con -DMODO_TRAZA=...:
+//   TRAZA_NINGUNA  no se graba nada y las llamadas desaparecen (por defecto)
+//   TRAZA_SERIAL   se imprimen por el puerto serie
+//   TRAZA_FLASH    se agregan a /traza.txt en LittleFS (se baja desde /traza)
+
+#define TRAZA_NINGUNA 0
+#define TRAZA_SERIAL 1
+#define TRAZA_FLASH 2
+
+#ifndef MODO_TRAZA
+#define MODO_TRAZA TRAZA_NINGUNA
+#endif
+
+#define TRAZA_PREFIJO "@t,"
+#define TRAZA_ARCHIVO "/traza.txt"
+#define TRAZA_MAX_BYTES (1024 * 1024) // Tope del archivo en flash
+#define TRAZA_LARGO_LINEA 128         // Al leerla en el equipo; lo que sobra se descarta
+
+#define TRAZA_PH 'p'
+#define TRAZA_TEMPERATURA 't'
+#define TRAZA_TDS 'a'
+
+#include <stdlib.h>
+#include <string.h>
+
+struct RegistroTraza {
+  unsigned long ms;
+  char tipo;
+  float salida;
+  char crudo[64];
+};
+
+// Interpreta una línea "@t,<ms>,<tipo>,<salida>,<crudo>". El prefijo puede
+// estar en cualquier parte (capturas del monitor serie con marca de tiempo).
+// La usan el replay nativo y la política de sensores SensoresReplay.
+inline bool leerRegistroTraza(const char* linea, RegistroTraza* registro) {
+  const char* inicio = strstr(linea, TRAZA_PREFIJO);
+  if (inicio == nullptr) return false;
+  inicio += strlen(TRAZA_PREFIJO);
+
+  char* fin;
+  registro->ms = strtoul(inicio, &fin, 10);
+  if (*fin != ',' || fin[1] == '\0' || fin[2] != ',') return false;
+  registro->tipo = fin[1];
+
+  registro->salida = strtof(fin + 3, &fin);
+  if (*fin != ',') return false;
+
+  // Copiar el dato crudo sin el fin de línea
+  size_t largo = strcspn(fin + 1, "\r\n");
+  if (largo >= sizeof(registro->crudo)) largo = sizeof(registro->crudo) - 1;
+  memcpy(registro->crudo, fin + 1, largo);
+  registro->crudo[largo] = '\0';
+  return true;
+}
+
+#if MODO_TRAZA == TRAZA_NINGUNA
+
+inline void iniciarTraza() {}
+inline void registrarTraza(char, float, const char*) {}
+inline void registrarTraza(char, float, int) {}
+
+#else
+
+void iniciarTraza();
+void registrarTraza(char tipo, float salida, const char* crudo);
+void registrarTraza(char tipo, float salida, int crudo);
+
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef UART_EZO_H
+#define UART_EZO_H
+
+// Recepción del EZO en segundo plano. Serial2.onReceive() corre en la tarea
+// que atiende la cola de eventos de la UART del core: arma cada línea con
+// el LectorEzo y la pasa a una ColaEzo. loop() las toma sin esperar.
+//
+// Desde iniciarUartEzo() nadie más lee Serial2: todo lo que manda el EZO,
+// respuestas a comandos o lecturas del modo continuo, sale de acá.
+
+#include "ezo.h"
+
+// Llamar después de Serial2.begin()
+void iniciarUartEzo();
+
+// La próxima línea recibida, si hay. No bloquea.
+bool siguienteLineaEzo(LineaEzo* linea);
+
+// Descarta todo lo recibido hasta ahora
+void descartarLineasEzo();
+
+// Líneas perdidas porque loop() no las leyó a tiempo
+uint32_t lineasPerdidasEzo();
+
+#endif
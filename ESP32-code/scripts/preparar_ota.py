@@ -0,0 +1,176 @@
+"""Prepara una actualización OTA para servir desde cualquier servidor HTTP.
+
+Uso (desde ESP32-code):
+
+    pio run -e esp32dev
+    python scripts/preparar_ota.py .pio/build/esp32dev/firmware.bin ota/ \\
+        --version 1.3.0 --base firmware-1.2.0.bin
+    cd ota && python -m http.server 8000
+
+    # Con el servidor ya sirviendo, pedirle la actualización a un equipo
+    python scripts/preparar_ota.py --pedir http://192.168.1.50 --servidor http://192.168.1.10:8000
+
+La clave es la misma OTA_CLAVE con la que se compiló el firmware; se pasa
+con --clave o en la variable de entorno OTA_CLAVE.
+
+Genera en el directorio de salida:
+    firmware.bin.z    imagen completa comprimida (zlib)
+    firmware.delta.z  delta contra --base, comprimido (solo si se pasa --base)
+    manifest.txt      versión, MD5 y tamaño de la imagen final, firmado
+
+El equipo baja manifest.txt y, si la imagen que corre coincide con base_md5,
+usa el delta; si no, la imagen completa. El formato del delta está en
+include/delta.h.
+
+El equipo solo instala una versión más nueva que la que corre.
+
+--pedir le pide al equipo un desafío (GET /actualizar), firma el id del
+equipo, el desafío y --servidor, y manda el pedido (POST /actualizar). El
+desafío vale una sola vez y por un minuto, así que cada pedido se firma de
+nuevo.
+"""
+import argparse, hashlib, hmac, json, os, re, struct, sys, urllib.error, urllib.parse, urllib.request, zlib
+
+BLOQUE = 32  # Largo mínimo de una coincidencia con la imagen base
+
+
+def calcular_delta(base, nueva):
+    """Devuelve el delta (sin comprimir) que convierte base en nueva"""
+    # Índice de los bloques alineados de la imagen base
+    indice = {}
+    for origen in range(0, len(base) - BLOQUE + 1, BLOQUE):
+        indice.setdefault(base[origen:origen + BLOQUE], origen)
+
+    salida = bytearray(b"PDL1" + struct.pack("<I", len(nueva)))
+    literal_desde = 0
+    i = 0
+
+    def agregar_literal(hasta):
+        if hasta > literal_desde:
+            salida.extend(b"A" + struct.pack("<I", hasta - literal_desde))
+            salida.extend(nueva[literal_desde:hasta])
+
+    while i + BLOQUE <= len(nueva):
+        origen = indice.get(nueva[i:i + BLOQUE])
+        if origen is None:
+            i += 1
+            continue
+
+        # Extender la coincidencia hacia adelante
+        largo = BLOQUE
+        while i + largo < len(nueva) and origen + largo < len(base) and nueva[i + largo] == base[origen + largo]:
+            largo += 1
+
+        agregar_literal(i)
+        salida.extend(b"C" + struct.pack("<II", origen, largo))
+        i += largo
+        literal_desde = i
+
+    agregar_literal(len(nueva))
+    salida.extend(b"F")
+    return bytes(salida)
+
+
+def aplicar_delta(base, delta):
+    """Aplica el delta como lo hace el firmware, para verificarlo antes de publicarlo"""
+    assert delta[:4] == b"PDL1"
+    (tamano,) = struct.unpack_from("<I", delta, 4)
+    resultado = bytearray()
+    i = 8
+    while delta[i:i + 1] != b"F":
+        operacion = delta[i:i + 1]
+        if operacion == b"C":
+            origen, largo = struct.unpack_from("<II", delta, i + 1)
+            resultado.extend(base[origen:origen + largo])
+            i += 9
+        elif operacion == b"A":
+            (largo,) = struct.unpack_from("<I", delta, i + 1)
+            resultado.extend(delta[i + 5:i + 5 + largo])
+            i += 5 + largo
+        else:
+            raise ValueError(f"Operación inválida en {i}")
+    assert len(resultado) == tamano
+    return bytes(resultado)
+
+
+def firmar(clave, texto):
+    """HMAC-SHA256 en hexadecimal, como lo verifica firmaOtaValida() (include/ota.h)"""
+    return hmac.new(clave.encode(), texto.encode(), hashlib.sha256).hexdigest()
+
+
+def pedir_actualizacion(equipo, servidor, clave):
+    """Pide el desafío al equipo y le manda el pedido firmado, como lo verifica pedidoOtaValido()"""
+    equipo = equipo.rstrip("/")
+    with urllib.request.urlopen(f"{equipo}/actualizar", timeout=10) as respuesta:
+        desafio = json.load(respuesta)
+    firma = firmar(clave, f"{desafio['device_id']}\n{desafio['nonce']}\n{servidor}")
+    datos = urllib.parse.urlencode({"servidor": servidor, "firma": firma}).encode()
+    try:
+        with urllib.request.urlopen(f"{equipo}/actualizar", data=datos, timeout=10) as respuesta:
+            print(f"{desafio['device_id']}: {respuesta.read().decode()}")
+    except urllib.error.HTTPError as error:
+        sys.exit(f"{desafio['device_id']}: {error.code} {error.read().decode()}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("firmware", nargs="?", help="firmware.bin nuevo")
+    parser.add_argument("salida", nargs="?", help="directorio a servir por HTTP")
+    parser.add_argument("--version", help="VERSION_FIRMWARE de la imagen nueva, p. ej. 1.3.0")
+    parser.add_argument("--base", help="firmware.bin que tienen hoy los equipos, para generar el delta")
+    parser.add_argument("--clave", default=os.environ.get("OTA_CLAVE"), help="OTA_CLAVE del firmware")
+    parser.add_argument("--servidor", help="URL desde donde se sirve, p. ej. http://192.168.1.10:8000")
+    parser.add_argument("--pedir", metavar="EQUIPO", help="URL del equipo a actualizar, p. ej. http://192.168.1.50")
+    args = parser.parse_args()
+    if not args.clave:
+        sys.exit("Falta la clave: --clave o la variable OTA_CLAVE")
+
+    if args.pedir:
+        if not args.servidor:
+            sys.exit("--pedir necesita --servidor")
+        pedir_actualizacion(args.pedir, args.servidor.rstrip("/"), args.clave)
+        return
+
+    if not args.firmware or not args.salida or not args.version:
+        parser.error("hacen falta firmware, salida y --version")
+    # El equipo compara las versiones número por número
+    if not re.fullmatch(r"\d+(\.\d+)*", args.version):
+        sys.exit(f"--version {args.version}: tiene que ser como 1.3.0")
+
+    nueva = open(args.firmware, "rb").read()
+    os.makedirs(args.salida, exist_ok=True)
+
+    completa = zlib.compress(nueva, 9)
+    open(os.path.join(args.salida, "firmware.bin.z"), "wb").write(completa)
+
+    manifest = [
+        f"version={args.version}",
+        f"md5={hashlib.md5(nueva).hexdigest()}",
+        f"tamano={len(nueva)}",
+        "completa=firmware.bin.z",
+    ]
+    print(f"Imagen: {len(nueva)} bytes, comprimida {len(completa)} ({100 * len(completa) / len(nueva):.1f}%)")
+
+    if args.base:
+        base = open(args.base, "rb").read()
+        delta = calcular_delta(base, nueva)
+        if aplicar_delta(base, delta) != nueva:
+            sys.exit("El delta generado no reproduce la imagen nueva")
+        delta_z = zlib.compress(delta, 9)
+        open(os.path.join(args.salida, "firmware.delta.z"), "wb").write(delta_z)
+        manifest += [
+            "delta=firmware.delta.z",
+            f"base_md5={hashlib.md5(base).hexdigest()}",
+        ]
+        print(f"Delta: {len(delta)} bytes, comprimido {len(delta_z)} ({100 * len(delta_z) / len(nueva):.1f}% de la imagen)")
+
+    # La firma cubre exactamente los bytes anteriores, así que no se dejan
+    # convertir los saltos de línea
+    texto = "\n".join(manifest) + "\n"
+    with open(os.path.join(args.salida, "manifest.txt"), "w", newline="\n") as archivo:
+        archivo.write(texto + f"firma={firmar(args.clave, texto)}\n")
+    print(f"Listo: python scripts/preparar_ota.py --pedir http://<ip del equipo> --servidor http://<este equipo>:8000")
+
+
+if __name__ == "__main__":
+    main()
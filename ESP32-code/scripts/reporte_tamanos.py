@@ -0,0 +1,40 @@
+"""Compila cada env del ESP32 e informa cuánta flash y RAM usa.
+
+Uso (desde ESP32-code):  python scripts/reporte_tamanos.py [env ...]
+"""
+import re, subprocess, sys
+
+ENVS = ["esp32dev", "esp32dev_sim", "esp32dev_replay", "esp32dev_influx", "esp32dev_estatica", "aws"]
+
+# Líneas que imprime PlatformIO al terminar de compilar, por ejemplo:
+# RAM:   [=         ]  13.9% (used 45432 bytes from 327680 bytes)
+PATRON = re.compile(r"^(RAM|Flash):.*?([\d.]+)% \(used (\d+) bytes from (\d+) bytes\)", re.M)
+
+
+def medir(env):
+    """Devuelve {'RAM': (usado, total), 'Flash': (usado, total)} o None si falla"""
+    resultado = subprocess.run(["pio", "run", "-e", env], capture_output=True, text=True)
+    if resultado.returncode != 0:
+        print(resultado.stdout[-2000:], resultado.stderr[-2000:], file=sys.stderr)
+        return None
+    return {m.group(1): (int(m.group(3)), int(m.group(4))) for m in PATRON.finditer(resultado.stdout)}
+
+
+def main():
+    envs = sys.argv[1:] or ENVS
+    print(f"{'env':<18}{'flash (bytes)':>15}{'flash %':>9}{'RAM (bytes)':>13}{'RAM %':>8}")
+    fallo = False
+    for env in envs:
+        tamanos = medir(env)
+        if not tamanos or "RAM" not in tamanos or "Flash" not in tamanos:
+            print(f"{env:<18}  error de compilación")
+            fallo = True
+            continue
+        flash, flash_total = tamanos["Flash"]
+        ram, ram_total = tamanos["RAM"]
+        print(f"{env:<18}{flash:>15}{100 * flash / flash_total:>8.1f}%{ram:>13}{100 * ram / ram_total:>7.1f}%")
+    sys.exit(1 if fallo else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,158 @@
+#include "anomalias.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+const LimitesMetrica LIMITES_METRICAS[CANTIDAD_METRICAS] = {
+    {"ph", 0.02f, 0.5f},
+    {"temperature_c", 0.1f, 2.0f},
+    {"tds_ppm", 5.0f, 100.0f},
+};
+
+static const char* const NOMBRES_TIPOS[CANTIDAD_TIPOS_ANOMALIA] = {"none", "rejected", "control_limit", "rate"};
+
+void iniciarDetector(DetectorAnomalias* detector) {
+  memset(detector, 0, sizeof(*detector));
+}
+
+const char* nombreTipoAnomalia(TipoAnomalia tipo) {
+  return tipo < CANTIDAD_TIPOS_ANOMALIA ? NOMBRES_TIPOS[tipo] : "unknown";
+}
+
+static void reiniciarLineaDeBase(DetectorMetrica* d) {
+  d->muestras = 0;
+  d->media = 0;
+  d->varianza = 0;
+}
+
+static void agregarALineaDeBase(DetectorMetrica* d, float valor) {
+  double delta = valor - d->media;
+  if (d->muestras < ANOMALIA_CALENTAMIENTO) {
+    d->muestras++;
+    d->media += delta / d->muestras;
+    d->varianza += delta * (valor - d->media);
+    // Al terminar el calentamiento, de la suma de Welford a la varianza muestral
+    if (d->muestras == ANOMALIA_CALENTAMIENTO) d->varianza /= ANOMALIA_CALENTAMIENTO - 1;
+    return;
+  }
+  d->media += ANOMALIA_ALFA * delta;
+  d->varianza = (1 - ANOMALIA_ALFA) * (d->varianza + ANOMALIA_ALFA * delta * delta);
+}
+
+// Devuelve el tipo de anomalía de la muestra, y en 'anomalia' el detalle
+static TipoAnomalia clasificar(const DetectorMetrica& d, const LimitesMetrica& limites, float valor, bool rechazada,
+                               uint32_t ms, Anomalia* anomalia) {
+  anomalia->valor = valor;
+  anomalia->esperado = d.media;
+  anomalia->limite = 0;
+  if (rechazada) return ANOMALIA_RECHAZADA;
+
+  // En el calentamiento todavía no hay varianza: se usa el piso
+  float sigma = d.muestras >= ANOMALIA_CALENTAMIENTO ? sqrtf((float)d.varianza) : 0;
+  if (sigma < limites.sigmaMinima) sigma = limites.sigmaMinima;
+  float banda = ANOMALIA_K_SIGMAS * sigma;
+
+  // El cambio permitido es lo que puede moverse en ese tiempo más el ruido,
+  // para que con muestras seguidas el ruido no parezca velocidad
+  if (d.hayAnterior) {
+    float maximo = limites.maximoPorMinuto * (ms - d.msAnterior) / 60000.0f + banda;
+    if (fabsf(valor - d.anterior) > maximo) {
+      anomalia->esperado = d.anterior;
+      anomalia->limite = maximo;
+      return ANOMALIA_VELOCIDAD;
+    }
+  }
+
+  if (d.muestras >= ANOMALIA_CALENTAMIENTO) {
+    anomalia->limite = banda;
+    if (fabsf(valor - (float)d.media) > banda) return ANOMALIA_LIMITE;
+  }
+  return ANOMALIA_NINGUNA;
+}
+
+uint8_t evaluarMuestra(DetectorAnomalias* detector, const float valores[CANTIDAD_METRICAS], uint8_t rechazadas,
+                       uint32_t ms, Anomalia nuevas[CANTIDAD_METRICAS]) {
+  uint8_t cantidad = 0;
+
+  for (uint8_t m = 0; m < CANTIDAD_METRICAS; m++) {
+    DetectorMetrica& d = detector->metricas[m];
+    float valor = valores[m];
+    // Un valor que no es un número tampoco se puede evaluar, aunque no venga
+    // marcado: en la línea de base la dejaría en NAN para siempre
+    bool rechazada = (rechazadas & (1u << m)) || !isfinite(valor);
+
+    Anomalia anomalia;
+    anomalia.metrica = (MetricaAnomalia)m;
+    anomalia.tipo = clasificar(d, LIMITES_METRICAS[m], valor, rechazada, ms, &anomalia);
+    d.evaluadas++;
+    d.anomalas[anomalia.tipo]++;
+
+    // La velocidad se mide contra la última muestra normal: un pico que
+    // vuelve enseguida es un episodio de una sola muestra
+    if (anomalia.tipo == ANOMALIA_NINGUNA) {
+      if (d.seguidas == 1) d.transitorios++;
+      d.seguidas = 0;
+      agregarALineaDeBase(&d, valor);
+      d.anterior = valor;
+      d.msAnterior = ms;
+      d.hayAnterior = true;
+    } else {
+      if (d.seguidas == 0) {
+        d.episodios++;
+        nuevas[cantidad++] = anomalia;
+      }
+      if (d.seguidas < UINT8_MAX) d.seguidas++;
+
+      // Demasiado tiempo fuera: es el nivel nuevo. Un sensor que no lee no
+      // cambia la línea de base.
+      if (!rechazada && d.seguidas >= ANOMALIA_PERSISTENCIA) {
+        d.cambiosNivel++;
+        d.seguidas = 0;
+        reiniciarLineaDeBase(&d);
+        agregarALineaDeBase(&d, valor);
+        d.anterior = valor;
+        d.msAnterior = ms;
+      }
+    }
+  }
+  return cantidad;
+}
+
+// Un número del JSON, o null
+static const char* numeroJson(float valor, char* destino, size_t largo) {
+  if (isnan(valor)) return "null";
+  snprintf(destino, largo, "%.3f", valor);
+  return destino;
+}
+
+size_t codificarAlertaJson(const Anomalia& anomalia, uint32_t timestamp, const char* idDispositivo, char* destino,
+                           size_t capacidad) {
+  char valor[24];
+  int largo = snprintf(destino, capacidad,
+                       "{\"metric\":\"%s\",\"kind\":\"%s\",\"value\":%s,\"expected\":%.3f,\"limit\":%.3f,"
+                       "\"timestamp\":%lu,\"device_id\":\"%s\"}",
+                       LIMITES_METRICAS[anomalia.metrica].nombre, nombreTipoAnomalia(anomalia.tipo),
+                       numeroJson(anomalia.valor, valor, sizeof(valor)), anomalia.esperado, anomalia.limite,
+                       (unsigned long)timestamp, idDispositivo);
+  if (largo < 0 || (size_t)largo >= capacidad) return 0;
+  return largo;
+}
+
+size_t describirDetector(const DetectorAnomalias& detector, char* destino, size_t largo) {
+  int escrito = snprintf(destino, largo, "{");
+  for (uint8_t m = 0; m < CANTIDAD_METRICAS && escrito >= 0 && (size_t)escrito < largo; m++) {
+    const DetectorMetrica& d = detector.metricas[m];
+    escrito += snprintf(destino + escrito, largo - escrito,
+                        "%s\"%s\":{\"samples\":%lu,\"rejected\":%lu,\"control_limit\":%lu,\"rate\":%lu,"
+                        "\"episodes\":%lu,\"single_sample\":%lu,\"level_shifts\":%lu,\"mean\":%.3f,\"stddev\":%.3f}",
+                        m == 0 ? "" : ",", LIMITES_METRICAS[m].nombre, (unsigned long)d.evaluadas,
+                        (unsigned long)d.anomalas[ANOMALIA_RECHAZADA], (unsigned long)d.anomalas[ANOMALIA_LIMITE],
+                        (unsigned long)d.anomalas[ANOMALIA_VELOCIDAD], (unsigned long)d.episodios,
+                        (unsigned long)d.transitorios, (unsigned long)d.cambiosNivel, d.media,
+                        d.muestras >= ANOMALIA_CALENTAMIENTO ? sqrt(d.varianza) : 0.0);
+  }
+  if (escrito >= 0 && (size_t)escrito < largo) escrito += snprintf(destino + escrito, largo - escrito, "}");
+  if (escrito < 0) return 0;
+  return (size_t)escrito < largo ? escrito : largo - 1;
+}
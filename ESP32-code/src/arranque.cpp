@@ -0,0 +1,38 @@
+#include "arranque.h"
+
+#include <stdio.h>
+
+static const char* const NOMBRES_FASES[CANTIDAD_FASES] = {
+    "setup", "transport", "portal", "config", "sensors", "first_reading",
+    "wifi", "ntp", "output_start", "output", "first_publish",
+};
+
+void iniciarArranque(Arranque* arranque) {
+  arranque->marcadas = 0;
+}
+
+void marcarFase(Arranque* arranque, FaseArranque fase, uint32_t ms) {
+  if (faseMarcada(*arranque, fase)) return;
+  arranque->ms[fase] = ms;
+  arranque->marcadas |= 1u << fase;
+}
+
+bool faseMarcada(const Arranque& arranque, FaseArranque fase) {
+  return arranque.marcadas & (1u << fase);
+}
+
+size_t describirArranque(const Arranque& arranque, const char* idDispositivo, const char* version,
+                         const char* motivoReinicio, char* destino, size_t largo) {
+  int escrito = snprintf(destino, largo, "{\"device_id\":\"%s\",\"version\":\"%s\",\"reset_reason\":\"%s\",\"phases_ms\":{",
+                         idDispositivo, version, motivoReinicio);
+  bool primera = true;
+  for (uint8_t f = 0; f < CANTIDAD_FASES && escrito >= 0 && (size_t)escrito < largo; f++) {
+    if (!faseMarcada(arranque, (FaseArranque)f)) continue;
+    escrito += snprintf(destino + escrito, largo - escrito, "%s\"%s\":%lu", primera ? "" : ",", NOMBRES_FASES[f],
+                        (unsigned long)arranque.ms[f]);
+    primera = false;
+  }
+  if (escrito >= 0 && (size_t)escrito < largo) escrito += snprintf(destino + escrito, largo - escrito, "}}");
+  if (escrito < 0) return 0;
+  return (size_t)escrito < largo ? escrito : largo - 1;
+}
@@ -0,0 +1,231 @@
+#include "asociacion.h"
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <algorithm>
+#include <lwip/etharp.h>
+#include <lwip/netif.h>
+#include <lwip/tcpip.h>
+#include <string.h>
+#include "registro.h"
+
+#define ASOCIACION_MAGICO 0x41534f31  // "ASO1"
+#define ASOCIACION_ESPACIO "asociacion"
+#define ASOCIACION_CLAVE "red"
+
+// Lo que se guarda en NVS de la última conexión
+struct RedConocida {
+  uint32_t magico;
+  char ssid[33];
+  uint8_t bssid[6];
+  uint8_t canal;
+  uint32_t ip, puerta, mascara, dns1, dns2;  // 0 si no se reusa la IP
+};
+
+static Preferences nvs;
+static RedConocida conocida;
+static bool hayConocida = false;
+static bool enCursoRapida = false;
+static bool conIpFija = false;      // El intento en curso (o la conexión) usa la IP guardada
+static bool pedirDhcp = false;      // El próximo rápido pide la IP igual
+static bool verificada = false;     // La red respondió con la IP fija
+static uint32_t inicioIntento = 0;
+static uint32_t inicioConexion = 0;
+static uint32_t ultimaPrueba = 0;
+static EstadisticasAsociacion estadisticas;
+
+// Prueba de la puerta de enlace por ARP: corre en la tarea de lwIP, que es
+// la única que puede tocar la tabla ARP. El mensaje se pide una vez y se
+// reusa, para no pedir memoria en cada prueba.
+static struct tcpip_callback_msg* mensajePrueba = nullptr;
+static ip4_addr_t puertaPrueba;
+static volatile bool puertaRespondio = false;
+
+void iniciarAsociacion() {
+  if (!nvs.begin(ASOCIACION_ESPACIO, false)) {
+    REG_ERROR("Error abriendo NVS, sin reconexión rápida");
+    return;
+  }
+  hayConocida = nvs.getBytes(ASOCIACION_CLAVE, &conocida, sizeof(conocida)) == sizeof(conocida) &&
+                conocida.magico == ASOCIACION_MAGICO;
+}
+
+void empezarAsociacion(const char* ssid, const char* clave) {
+  // Lo que haya quedado del intento anterior
+  WiFi.disconnect(false, false);
+
+  enCursoRapida = ASOCIACION_RAPIDA && hayConocida && strcmp(conocida.ssid, ssid) == 0;
+  conIpFija = enCursoRapida && conocida.ip != 0 && !pedirDhcp;
+  inicioIntento = millis();
+
+  if (enCursoRapida) {
+    estadisticas.rapida.intentos++;
+    if (conIpFija) {
+      WiFi.config(IPAddress(conocida.ip), IPAddress(conocida.puerta), IPAddress(conocida.mascara),
+                  IPAddress(conocida.dns1), IPAddress(conocida.dns2));
+    } else {
+      WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    }
+    REG_INFO("Asociación rápida: canal %u, AP %02x:%02x:%02x:%02x:%02x:%02x", conocida.canal,
+             conocida.bssid[0], conocida.bssid[1], conocida.bssid[2], conocida.bssid[3], conocida.bssid[4],
+             conocida.bssid[5]);
+    WiFi.begin(ssid, clave, conocida.canal, conocida.bssid);
+    return;
+  }
+
+  // Sin IP fija: DHCP
+  estadisticas.completa.intentos++;
+  WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+  WiFi.begin(ssid, clave);
+}
+
+uint32_t plazoAsociacion() {
+  return enCursoRapida ? ASOCIACION_PLAZO_RAPIDO_MS : ASOCIACION_PLAZO_COMPLETO_MS;
+}
+
+static void contar(EstadisticasCamino* camino, uint32_t ms) {
+  if (camino->exitos == 0 || ms < camino->msMinima) camino->msMinima = ms;
+  camino->exitos++;
+  camino->msUltima = ms;
+  camino->msMaxima = std::max(camino->msMaxima, ms);
+  camino->msTotal += ms;
+}
+
+// En la tarea de lwIP: si la puerta ya contestó el ARP, la red anda con
+// esta IP; si no, se le vuelve a preguntar
+static void probarPuerta(void*) {
+  struct netif* interfaz;
+  NETIF_FOREACH(interfaz) {
+    if (!netif_is_up(interfaz) || !netif_is_link_up(interfaz) ||
+        !ip4_addr_netcmp(&puertaPrueba, netif_ip4_addr(interfaz), netif_ip4_netmask(interfaz))) {
+      continue;
+    }
+    struct eth_addr* mac;
+    const ip4_addr_t* ip;
+    if (etharp_find_addr(interfaz, &puertaPrueba, &mac, &ip) >= 0) {
+      puertaRespondio = true;
+    } else {
+      etharp_request(interfaz, &puertaPrueba);
+    }
+  }
+}
+
+void asociacionLograda() {
+  uint32_t ms = millis() - inicioIntento;
+  contar(enCursoRapida ? &estadisticas.rapida : &estadisticas.completa, ms);
+  REG_INFO("Asociación %s en %lu ms", enCursoRapida ? "rápida" : "completa", (unsigned long)ms);
+  inicioConexion = millis();
+  verificada = false;
+  puertaRespondio = false;
+
+  // La IP fija no se vuelve a guardar: lo guardado es siempre lo último que
+  // dio el DHCP
+  if (conIpFija) return;
+  pedirDhcp = false;
+
+  RedConocida red = {};
+  red.magico = ASOCIACION_MAGICO;
+  strncpy(red.ssid, WiFi.SSID().c_str(), sizeof(red.ssid) - 1);
+  memcpy(red.bssid, WiFi.BSSID(), sizeof(red.bssid));
+  red.canal = WiFi.channel();
+#if ASOCIACION_REUSAR_IP
+  red.ip = WiFi.localIP();
+  red.puerta = WiFi.gatewayIP();
+  red.mascara = WiFi.subnetMask();
+  red.dns1 = WiFi.dnsIP(0);
+  red.dns2 = WiFi.dnsIP(1);
+#endif
+
+  // NVS se gasta: solo si cambió algo
+  if (hayConocida && memcmp(&red, &conocida, sizeof(red)) == 0) return;
+  conocida = red;
+  hayConocida = true;
+  if (nvs.putBytes(ASOCIACION_CLAVE, &conocida, sizeof(conocida)) == sizeof(conocida)) estadisticas.escriturasNvs++;
+}
+
+void asociacionFallida() {
+  if (!enCursoRapida) return;
+  REG_AVISO("La asociación rápida no anduvo, se descarta el AP guardado");
+  hayConocida = false;
+  conIpFija = false;
+  nvs.remove(ASOCIACION_CLAVE);
+}
+
+// Con la IP fija, pregunta por la puerta de enlace cada
+// ASOCIACION_PERIODO_PRUEBA_MS hasta que contesta
+static void probarRed() {
+  if (puertaRespondio) {
+    verificada = true;
+    return;
+  }
+  if (millis() - ultimaPrueba < ASOCIACION_PERIODO_PRUEBA_MS) return;
+  ultimaPrueba = millis();
+
+  if (mensajePrueba == nullptr) mensajePrueba = tcpip_callbackmsg_new(probarPuerta, nullptr);
+  if (mensajePrueba == nullptr) return;
+  puertaPrueba.addr = conocida.puerta;
+  tcpip_callbackmsg_trycallback(mensajePrueba);
+}
+
+void redAlcanzada() {
+  verificada = true;
+}
+
+bool asociacionVigente() {
+  if (!conIpFija) return true;
+
+  if (!verificada) probarRed();
+
+  // El AP y el canal anduvieron: solo se deja de usar la IP. Una caída del
+  // broker no llega acá, porque la puerta de enlace igual contesta.
+  uint32_t ms = millis() - inicioConexion;
+  if (!verificada && ms >= ASOCIACION_PLAZO_VERIFICACION_MS) {
+    REG_AVISO("Sin respuesta de la red con la IP fija %s, se pide por DHCP", WiFi.localIP().toString().c_str());
+    estadisticas.ipsDescartadas++;
+    pedirDhcp = true;
+    conIpFija = false;
+    return false;
+  }
+  if (ms >= ASOCIACION_RENOVAR_MS) {
+    REG_INFO("Renovando la IP por DHCP");
+    estadisticas.renovaciones++;
+    pedirDhcp = true;
+    conIpFija = false;
+    return false;
+  }
+  return true;
+}
+
+const EstadisticasAsociacion& estadisticasAsociacion() {
+  return estadisticas;
+}
+
+static int describirCamino(const EstadisticasCamino& c, char* destino, size_t largo) {
+  return snprintf(destino, largo,
+                  "{\"attempts\":%lu,\"successes\":%lu,\"last_ms\":%lu,\"min_ms\":%lu,\"max_ms\":%lu,\"mean_ms\":%lu}",
+                  (unsigned long)c.intentos, (unsigned long)c.exitos, (unsigned long)c.msUltima,
+                  (unsigned long)c.msMinima, (unsigned long)c.msMaxima,
+                  (unsigned long)(c.exitos > 0 ? c.msTotal / c.exitos : 0));
+}
+
+size_t describirAsociacion(char* destino, size_t largo) {
+  int escrito = snprintf(destino, largo, "{\"cached\":%s,\"fast\":", hayConocida ? "true" : "false");
+  if (escrito >= 0 && (size_t)escrito < largo) {
+    escrito += describirCamino(estadisticas.rapida, destino + escrito, largo - escrito);
+  }
+  if (escrito >= 0 && (size_t)escrito < largo) {
+    escrito += snprintf(destino + escrito, largo - escrito, ",\"full\":");
+  }
+  if (escrito >= 0 && (size_t)escrito < largo) {
+    escrito += describirCamino(estadisticas.completa, destino + escrito, largo - escrito);
+  }
+  if (escrito >= 0 && (size_t)escrito < largo) {
+    escrito += snprintf(destino + escrito, largo - escrito,
+                        ",\"nvs_writes\":%lu,\"static_ip_dropped\":%lu,\"dhcp_renewals\":%lu}",
+                        (unsigned long)estadisticas.escriturasNvs, (unsigned long)estadisticas.ipsDescartadas,
+                        (unsigned long)estadisticas.renovaciones);
+  }
+  if (escrito < 0) return 0;
+  return std::min((size_t)escrito, largo - 1);
+}
@@ -0,0 +1,114 @@
+#include "delta.h"
+
+#include <string.h>
+
+static uint32_t leerU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void iniciarDelta(AplicadorDelta* delta, LeerBaseDelta leerBase, EscribirDelta escribir,
+                  void* contexto, uint32_t tamanoBase) {
+  delta->leerBase = leerBase;
+  delta->escribir = escribir;
+  delta->contexto = contexto;
+  delta->tamanoBase = tamanoBase;
+  delta->estado = DELTA_ENCABEZADO;
+  delta->operacion = 0;
+  delta->cantidadAcumulada = 0;
+  delta->restante = 0;
+  delta->tamanoFinal = 0;
+  delta->escritos = 0;
+}
+
+static bool fallar(AplicadorDelta* delta) {
+  delta->estado = DELTA_ERROR;
+  return false;
+}
+
+// Copia un tramo de la imagen actual a la nueva, de a bloques
+static bool copiarDeBase(AplicadorDelta* delta, uint32_t origen, uint32_t largo) {
+  if (origen > delta->tamanoBase || largo > delta->tamanoBase - origen) return false;
+  if (delta->escritos + largo > delta->tamanoFinal) return false;
+
+  uint8_t bloque[DELTA_BLOQUE_COPIA];
+  while (largo > 0) {
+    size_t tramo = largo < sizeof(bloque) ? largo : sizeof(bloque);
+    if (!delta->leerBase(origen, bloque, tramo, delta->contexto)) return false;
+    if (!delta->escribir(bloque, tramo, delta->contexto)) return false;
+    origen += tramo;
+    largo -= tramo;
+    delta->escritos += tramo;
+  }
+  return true;
+}
+
+bool agregarDelta(AplicadorDelta* delta, const uint8_t* datos, size_t largo) {
+  while (largo > 0) {
+    switch (delta->estado) {
+      case DELTA_ENCABEZADO: {
+        delta->acumulado[delta->cantidadAcumulada++] = *datos++;
+        largo--;
+        if (delta->cantidadAcumulada < 8) break;
+
+        if (memcmp(delta->acumulado, DELTA_MAGICO, 4) != 0) return fallar(delta);
+        delta->tamanoFinal = leerU32(delta->acumulado + 4);
+        delta->cantidadAcumulada = 0;
+        delta->estado = DELTA_OPERACION;
+        break;
+      }
+
+      case DELTA_OPERACION:
+        delta->operacion = *datos++;
+        largo--;
+        if (delta->operacion == 'F') {
+          delta->estado = DELTA_TERMINADO;
+        } else if (delta->operacion == 'C' || delta->operacion == 'A') {
+          delta->estado = DELTA_ARGUMENTOS;
+        } else {
+          return fallar(delta);
+        }
+        break;
+
+      case DELTA_ARGUMENTOS: {
+        size_t necesarios = delta->operacion == 'C' ? 8 : 4;
+        delta->acumulado[delta->cantidadAcumulada++] = *datos++;
+        largo--;
+        if (delta->cantidadAcumulada < necesarios) break;
+        delta->cantidadAcumulada = 0;
+
+        if (delta->operacion == 'C') {
+          if (!copiarDeBase(delta, leerU32(delta->acumulado), leerU32(delta->acumulado + 4))) {
+            return fallar(delta);
+          }
+          delta->estado = DELTA_OPERACION;
+        } else {
+          delta->restante = leerU32(delta->acumulado);
+          if (delta->escritos + delta->restante > delta->tamanoFinal) return fallar(delta);
+          delta->estado = delta->restante > 0 ? DELTA_AGREGANDO : DELTA_OPERACION;
+        }
+        break;
+      }
+
+      case DELTA_AGREGANDO: {
+        size_t tramo = largo < delta->restante ? largo : delta->restante;
+        if (!delta->escribir(datos, tramo, delta->contexto)) return fallar(delta);
+        datos += tramo;
+        largo -= tramo;
+        delta->restante -= tramo;
+        delta->escritos += tramo;
+        if (delta->restante == 0) delta->estado = DELTA_OPERACION;
+        break;
+      }
+
+      case DELTA_TERMINADO:
+        // No puede haber nada después de la 'F'
+      case DELTA_ERROR:
+        return fallar(delta);
+    }
+  }
+  return true;
+}
+
+bool deltaCompleto(const AplicadorDelta& delta) {
+  return delta.estado == DELTA_TERMINADO && delta.escritos == delta.tamanoFinal;
+}
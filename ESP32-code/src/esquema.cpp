@@ -0,0 +1,175 @@
+#include "esquema.h"
+
+// Decodificadores del esquema de telemetría. El firmware solo codifica;
+// esto lo usan las herramientas de la PC (src/esquema) para verificar lo
+// que llega al broker.
+
+static const char* saltarEspacios(const char* p, const char* fin) {
+  while (p < fin && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+  return p;
+}
+
+// Lee un número decimal directo a punto fijo con 'decimales' decimales,
+// redondeando los que sobran. No acepta exponentes.
+static const char* leerFijo(const char* p, const char* fin, uint8_t decimales, int64_t* valor) {
+  bool negativo = false;
+  if (p < fin && *p == '-') {
+    negativo = true;
+    p++;
+  }
+  if (p >= fin || *p < '0' || *p > '9') return nullptr;
+
+  int64_t entero = 0;
+  while (p < fin && *p >= '0' && *p <= '9') {
+    entero = entero * 10 + (*p - '0');
+    if (entero > 1000000000000000LL) return nullptr;
+    p++;
+  }
+
+  uint8_t leidos = 0;
+  bool redondearArriba = false;
+  if (p < fin && *p == '.') {
+    p++;
+    while (p < fin && *p >= '0' && *p <= '9') {
+      if (leidos < decimales) {
+        entero = entero * 10 + (*p - '0');
+        leidos++;
+      } else if (leidos == decimales) {
+        redondearArriba = *p >= '5';
+        leidos++;
+      }
+      p++;
+    }
+    if (leidos > decimales) leidos = decimales;
+  }
+  if (p < fin && (*p == 'e' || *p == 'E')) return nullptr;
+
+  for (; leidos < decimales; leidos++) entero *= 10;
+  if (redondearArriba) entero++;
+
+  *valor = negativo ? -entero : entero;
+  return p;
+}
+
+static int buscarCampo(const char* nombre, size_t largo) {
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (strlen(CAMPOS_MEDICION[i].nombre) == largo && memcmp(CAMPOS_MEDICION[i].nombre, nombre, largo) == 0) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+// Reparte el buffer de textos entre los campos de texto, en orden
+static void prepararTextos(Medicion* medicion, char* textos) {
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    medicion->numeros[i] = 0;
+    medicion->textos[i] = nullptr;
+    if (CAMPOS_MEDICION[i].tipo == CAMPO_TEXTO) {
+      textos[0] = '\0';
+      medicion->textos[i] = textos;
+      textos += CAMPOS_MEDICION[i].largoMaximo + 1;
+    }
+  }
+}
+
+static bool valorEnRango(const Campo& campo, int64_t valor) {
+  return valor >= campo.minimo && valor <= campo.maximo;
+}
+
+bool decodificarJson(const char* json, size_t largo, Medicion* medicion, char* textos) {
+  const char* p = json;
+  const char* fin = json + largo;
+  bool presentes[CANTIDAD_CAMPOS] = {};
+
+  prepararTextos(medicion, textos);
+
+  p = saltarEspacios(p, fin);
+  if (p >= fin || *p++ != '{') return false;
+
+  while (true) {
+    p = saltarEspacios(p, fin);
+    if (p < fin && *p == '}') break;
+
+    // Clave
+    if (p >= fin || *p++ != '"') return false;
+    const char* clave = p;
+    while (p < fin && *p != '"') p++;
+    if (p >= fin) return false;
+    int indice = buscarCampo(clave, p - clave);
+    p = saltarEspacios(p + 1, fin);
+    if (p >= fin || *p++ != ':') return false;
+    p = saltarEspacios(p, fin);
+    if (p >= fin) return false;
+
+    if (*p == '"') {
+      // Texto: no se admiten secuencias de escape
+      const char* inicio = ++p;
+      while (p < fin && *p != '"' && *p != '\\') p++;
+      if (p >= fin || *p != '"') return false;
+      size_t largoTexto = p - inicio;
+      p++;
+
+      if (indice >= 0) {
+        const Campo& campo = CAMPOS_MEDICION[indice];
+        if (campo.tipo != CAMPO_TEXTO || largoTexto > campo.largoMaximo) return false;
+        char* destino = (char*)medicion->textos[indice];
+        memcpy(destino, inicio, largoTexto);
+        destino[largoTexto] = '\0';
+        presentes[indice] = true;
+      }
+    } else if (indice >= 0) {
+      const Campo& campo = CAMPOS_MEDICION[indice];
+      if (campo.tipo != CAMPO_NUMERO) return false;
+      p = leerFijo(p, fin, campo.decimales, &medicion->numeros[indice]);
+      if (p == nullptr || !valorEnRango(campo, medicion->numeros[indice])) return false;
+      presentes[indice] = true;
+    } else {
+      // Campo desconocido: saltear el valor
+      while (p < fin && *p != ',' && *p != '}') p++;
+    }
+
+    p = saltarEspacios(p, fin);
+    if (p < fin && *p == ',') {
+      p++;
+      continue;
+    }
+    if (p < fin && *p == '}') break;
+    return false;
+  }
+
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (!presentes[i]) return false;
+  }
+  return true;
+}
+
+bool decodificarBinario(const uint8_t* datos, size_t largo, Medicion* medicion, char* textos) {
+  prepararTextos(medicion, textos);
+
+  if (largo < 1 || datos[0] != ESQUEMA_VERSION) return false;
+  size_t posicion = 1;
+
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    const Campo& campo = CAMPOS_MEDICION[i];
+
+    if (campo.tipo == CAMPO_TEXTO) {
+      if (posicion >= largo) return false;
+      size_t largoTexto = datos[posicion++];
+      if (largoTexto > campo.largoMaximo || posicion + largoTexto > largo) return false;
+      char* destino = (char*)medicion->textos[i];
+      memcpy(destino, datos + posicion, largoTexto);
+      destino[largoTexto] = '\0';
+      posicion += largoTexto;
+    } else {
+      size_t bytes = bytesCampoBinario(campo);
+      if (posicion + bytes > largo) return false;
+      uint64_t desplazado = 0;
+      for (size_t b = 0; b < bytes; b++) desplazado |= (uint64_t)datos[posicion + b] << (8 * b);
+      posicion += bytes;
+      medicion->numeros[i] = (int64_t)desplazado + campo.minimo;
+      if (!valorEnRango(campo, medicion->numeros[i])) return false;
+    }
+  }
+  return posicion == largo;
+}
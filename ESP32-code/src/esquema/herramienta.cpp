@@ -0,0 +1,125 @@
+// Herramienta de la PC para el esquema de telemetría (ver include/esquema.h).
+//
+//   pio run -e native_esquema
+//   mosquitto_sub -t pool/metrics | .pio/build/native_esquema/program
+//   mosquitto_sub -t pool/metrics/bin -F %x | .pio/build/native_esquema/program
+//   .pio/build/native_esquema/program --python > ../lecture-simulator/esquema_pileta.py
+//   .pio/build/native_esquema/program --tamanos
+//
+// Sin opciones lee mensajes de la entrada estándar (JSON, o binario en
+// hexadecimal), los decodifica con el esquema e informa los que no lo cumplen.
+
+#include <cstdio>
+#include <cstring>
+
+#include "esquema.h"
+
+static void imprimirPython() {
+  printf("# Generado por ESP32-code/src/esquema/herramienta.cpp --python a partir de\n");
+  printf("# ESP32-code/include/esquema.h. No editar a mano.\n\n");
+  printf("import math\n\n");
+  printf("ESQUEMA_VERSION = %d\n\n", ESQUEMA_VERSION);
+  printf("# (nombre, tipo, decimales, minimo, maximo, largo_maximo)\n");
+  printf("CAMPOS = [\n");
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    const Campo& campo = CAMPOS_MEDICION[i];
+    printf("    (\"%s\", \"%s\", %u, %lld, %lld, %u),\n", campo.nombre,
+           campo.tipo == CAMPO_TEXTO ? "texto" : "numero", campo.decimales,
+           (long long)campo.minimo, (long long)campo.maximo, campo.largoMaximo);
+  }
+  printf("]\n\n");
+  printf("TENDENCIA_SUBIENDO = \"%s\"\n", TENDENCIA_SUBIENDO);
+  printf("TENDENCIA_ESTABLE = \"%s\"\n", TENDENCIA_ESTABLE);
+  printf("TENDENCIA_BAJANDO = \"%s\"\n\n", TENDENCIA_BAJANDO);
+  printf("\n"
+         "def armar_payload(**valores):\n"
+         "    \"\"\"Arma el diccionario a publicar con el mismo redondeo y rango que el firmware\"\"\"\n"
+         "    payload = {}\n"
+         "    for nombre, tipo, decimales, minimo, maximo, largo_maximo in CAMPOS:\n"
+         "        valor = valores[nombre]\n"
+         "        if tipo == \"texto\":\n"
+         "            payload[nombre] = str(valor)[:largo_maximo]\n"
+         "        else:\n"
+         "            # Como fijarNumero(): la mitad se aleja del cero (round() va al par)\n"
+         "            escalado = valor * 10 ** decimales\n"
+         "            entero = int(math.copysign(math.floor(abs(escalado) + 0.5), escalado))\n"
+         "            escalado = min(max(entero, minimo), maximo)\n"
+         "            payload[nombre] = escalado / 10 ** decimales if decimales else escalado\n"
+         "    return payload\n");
+}
+
+static void imprimirTamanos() {
+  printf("JSON peor caso:    %zu bytes (con \\0)\n", TAMANO_MAXIMO_JSON);
+  printf("Binario peor caso: %zu bytes\n", TAMANO_MAXIMO_BINARIO);
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    printf("  %-14s json %2zu  binario %2zu\n", CAMPOS_MEDICION[i].nombre,
+           largoMaximoValorJson(CAMPOS_MEDICION[i]), bytesCampoBinario(CAMPOS_MEDICION[i]));
+  }
+}
+
+static int valorHex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static void imprimirMedicion(const Medicion& medicion) {
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (CAMPOS_MEDICION[i].tipo == CAMPO_TEXTO) {
+      printf("%s%s=%s", i ? " " : "", CAMPOS_MEDICION[i].nombre, medicion.textos[i]);
+    } else {
+      printf("%s%s=%.*f", i ? " " : "", CAMPOS_MEDICION[i].nombre, CAMPOS_MEDICION[i].decimales,
+             leerNumero(medicion, (IndiceCampo)i));
+    }
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--python") == 0) {
+    imprimirPython();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "--tamanos") == 0) {
+    imprimirTamanos();
+    return 0;
+  }
+
+  char linea[1024];
+  uint8_t binario[sizeof(linea) / 2];
+  char textos[TAMANO_TEXTOS_MEDICION];
+  Medicion medicion;
+  unsigned long validos = 0, invalidos = 0;
+
+  while (fgets(linea, sizeof(linea), stdin) != nullptr) {
+    size_t largo = strcspn(linea, "\r\n");
+    linea[largo] = '\0';
+    if (largo == 0) continue;
+
+    bool ok;
+    if (linea[0] == '{') {
+      ok = decodificarJson(linea, largo, &medicion, textos);
+    } else {
+      size_t bytes = 0;
+      ok = largo % 2 == 0;
+      for (size_t i = 0; ok && i < largo; i += 2) {
+        int alto = valorHex(linea[i]), bajo = valorHex(linea[i + 1]);
+        ok = alto >= 0 && bajo >= 0;
+        binario[bytes++] = (uint8_t)(alto * 16 + bajo);
+      }
+      ok = ok && decodificarBinario(binario, bytes, &medicion, textos);
+    }
+
+    if (ok) {
+      validos++;
+      imprimirMedicion(medicion);
+    } else {
+      invalidos++;
+      printf("INVALIDO: %s\n", linea);
+    }
+  }
+
+  fprintf(stderr, "%lu mensajes válidos, %lu inválidos\n", validos, invalidos);
+  return invalidos > 0 ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+#include "ezo.h"
+
+void reiniciarLectorEzo(LectorEzo* lector) {
+  lector->linea[0] = '\0';
+  lector->largo = 0;
+  lector->desbordado = false;
+  lector->conBasura = false;
+  lector->valor = 0;
+}
+
+// Convierte "[-]digitos[.digitos]" a milésimas, redondeando el cuarto
+// decimal. Devuelve false si sobra algo o el número no entra en 32 bits.
+static bool leerMilesimas(const char* p, const char* fin, int32_t* valor) {
+  bool negativo = false;
+  if (p < fin && *p == '-') {
+    negativo = true;
+    p++;
+  }
+
+  int64_t entero = 0;
+  int digitos = 0;
+  while (p < fin && *p >= '0' && *p <= '9') {
+    entero = entero * 10 + (*p - '0');
+    if (entero > 2000000) return false;
+    digitos++;
+    p++;
+  }
+
+  int decimales = 0;
+  bool redondearArriba = false;
+  if (p < fin && *p == '.') {
+    p++;
+    while (p < fin && *p >= '0' && *p <= '9') {
+      if (decimales < EZO_DECIMALES) {
+        entero = entero * 10 + (*p - '0');
+      } else if (decimales == EZO_DECIMALES) {
+        redondearArriba = *p >= '5';
+      }
+      decimales++;
+      digitos++;
+      p++;
+    }
+  }
+
+  if (digitos == 0 || p != fin) return false;
+
+  for (int i = decimales; i < EZO_DECIMALES; i++) entero *= 10;
+  if (redondearArriba) entero++;
+
+  *valor = (int32_t)(negativo ? -entero : entero);
+  return true;
+}
+
+TipoRespuestaEzo clasificarLineaEzo(const char* linea, size_t largo, int32_t* valor) {
+  const char* p = linea;
+  const char* fin = linea + largo;
+  while (p < fin && (*p == ' ' || *p == '\t')) p++;
+  while (fin > p && (fin[-1] == ' ' || fin[-1] == '\t' || fin[-1] == '\n')) fin--;
+
+  if (p == fin) return EZO_MALFORMADA;
+
+  if (*p == '*') {
+    size_t largoCodigo = fin - p - 1;
+    if (largoCodigo == 2) {
+      char a = p[1], b = p[2];
+      if (a == 'O' && b == 'K') return EZO_OK;
+      if (a == 'E' && b == 'R') return EZO_ER;
+      if (a == 'O' && b == 'V') return EZO_OV;
+      if (a == 'U' && b == 'V') return EZO_UV;
+      if (a == 'R' && b == 'S') return EZO_RS;
+    }
+    return EZO_OTRO_ESTADO;
+  }
+
+  // Con varios valores separados por coma se toma el primero
+  const char* finNumero = p;
+  while (finNumero < fin && *finNumero != ',') finNumero++;
+
+  int32_t leido;
+  if (!leerMilesimas(p, finNumero, &leido)) return EZO_MALFORMADA;
+  *valor = leido;
+  return EZO_VALOR;
+}
+
+TipoRespuestaEzo agregarByteEzo(LectorEzo* lector, uint8_t byte) {
+  if (byte == '\r') {
+    lector->linea[lector->largo] = '\0';
+
+    TipoRespuestaEzo tipo;
+    if (lector->desbordado) {
+      tipo = EZO_DESBORDE;
+    } else if (lector->conBasura) {
+      tipo = EZO_MALFORMADA;
+    } else {
+      tipo = clasificarLineaEzo(lector->linea, lector->largo, &lector->valor);
+    }
+
+    // La línea queda disponible; la próxima empieza de cero
+    lector->largo = 0;
+    lector->desbordado = false;
+    lector->conBasura = false;
+    return tipo;
+  }
+
+  // Línea nueva: se borra la anterior
+  if (lector->largo == 0) lector->linea[0] = '\0';
+
+  // Algunos adaptadores agregan '\n' después del '\r'
+  if (byte == '\n' && lector->largo == 0) return EZO_INCOMPLETA;
+
+  if (byte < 0x20 || byte > 0x7e) {
+    lector->conBasura = true;
+    return EZO_INCOMPLETA;
+  }
+
+  if (lector->largo >= EZO_LARGO_MAXIMO) {
+    lector->desbordado = true;
+    return EZO_INCOMPLETA;
+  }
+
+  lector->linea[lector->largo++] = (char)byte;
+  return EZO_INCOMPLETA;
+}
+
+void reiniciarColaEzo(ColaEzo* cola) {
+  cola->escritas.store(0);
+  cola->leidas.store(0);
+  cola->descartadas.store(0);
+}
+
+bool encolarEzo(ColaEzo* cola, const LineaEzo& linea) {
+  uint32_t escritas = cola->escritas.load(std::memory_order_relaxed);
+  if (escritas - cola->leidas.load(std::memory_order_acquire) >= EZO_CAPACIDAD_COLA) {
+    cola->descartadas.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  cola->lineas[escritas & (EZO_CAPACIDAD_COLA - 1)] = linea;
+  // La línea queda escrita antes de que el consumidor vea el contador
+  cola->escritas.store(escritas + 1, std::memory_order_release);
+  return true;
+}
+
+bool desencolarEzo(ColaEzo* cola, LineaEzo* linea) {
+  uint32_t leidas = cola->leidas.load(std::memory_order_relaxed);
+  if (leidas == cola->escritas.load(std::memory_order_acquire)) return false;
+  *linea = cola->lineas[leidas & (EZO_CAPACIDAD_COLA - 1)];
+  // Recién ahora el productor puede volver a usar el lugar
+  cola->leidas.store(leidas + 1, std::memory_order_release);
+  return true;
+}
@@ -0,0 +1,148 @@
+#include "gzip.h"
+
+#include <string.h>
+
+#define GZIP_VENTANA 32768
+#define GZIP_COINCIDENCIA_MINIMA 3
+#define GZIP_COINCIDENCIA_MAXIMA 258
+#define GZIP_SIN_POSICION 0xFFFF
+
+// Códigos de largo (257..285) y de distancia (0..29) de deflate: base y bits extra
+static const uint16_t BASE_LARGO[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t EXTRA_LARGO[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t BASE_DISTANCIA[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                                            33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                                            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t EXTRA_DISTANCIA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+struct EscritorBits {
+  uint8_t* destino;
+  size_t capacidad;
+  size_t largo;
+  uint32_t bits;
+  uint8_t cantidad;
+  bool lleno;
+};
+
+static void escribirByte(EscritorBits* escritor, uint8_t byte) {
+  if (escritor->largo >= escritor->capacidad) {
+    escritor->lleno = true;
+    return;
+  }
+  escritor->destino[escritor->largo++] = byte;
+}
+
+// Deflate guarda los valores desde el bit menos significativo
+static void escribirBits(EscritorBits* escritor, uint32_t valor, uint8_t cantidad) {
+  escritor->bits |= valor << escritor->cantidad;
+  escritor->cantidad += cantidad;
+  while (escritor->cantidad >= 8) {
+    escribirByte(escritor, escritor->bits & 0xFF);
+    escritor->bits >>= 8;
+    escritor->cantidad -= 8;
+  }
+}
+
+// ... pero los códigos Huffman van desde el más significativo
+static void escribirCodigo(EscritorBits* escritor, uint32_t codigo, uint8_t cantidad) {
+  uint32_t invertido = 0;
+  for (uint8_t i = 0; i < cantidad; i++) {
+    invertido = (invertido << 1) | (codigo & 1);
+    codigo >>= 1;
+  }
+  escribirBits(escritor, invertido, cantidad);
+}
+
+// Literales, fin de bloque y códigos de largo con la tabla fija de deflate
+static void escribirSimbolo(EscritorBits* escritor, uint16_t simbolo) {
+  if (simbolo < 144) escribirCodigo(escritor, 0x30 + simbolo, 8);
+  else if (simbolo < 256) escribirCodigo(escritor, 0x190 + simbolo - 144, 9);
+  else if (simbolo < 280) escribirCodigo(escritor, simbolo - 256, 7);
+  else escribirCodigo(escritor, 0xC0 + simbolo - 280, 8);
+}
+
+static void escribirCoincidencia(EscritorBits* escritor, size_t largo, size_t distancia) {
+  uint8_t codigo = 28;
+  while (BASE_LARGO[codigo] > largo) codigo--;
+  escribirSimbolo(escritor, 257 + codigo);
+  escribirBits(escritor, largo - BASE_LARGO[codigo], EXTRA_LARGO[codigo]);
+
+  codigo = 29;
+  while (BASE_DISTANCIA[codigo] > distancia) codigo--;
+  escribirCodigo(escritor, codigo, 5);
+  escribirBits(escritor, distancia - BASE_DISTANCIA[codigo], EXTRA_DISTANCIA[codigo]);
+}
+
+static uint32_t hashTres(const uint8_t* p) {
+  uint32_t clave = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+  return (clave * 2654435761u) >> (32 - GZIP_BITS_HASH);
+}
+
+static uint32_t calcularCrc32(const uint8_t* datos, size_t largo) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < largo; i++) {
+    crc ^= datos[i];
+    for (uint8_t bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+size_t comprimirGzip(const uint8_t* datos, size_t largo, uint8_t* destino, size_t capacidad) {
+  if (largo > GZIP_LARGO_MAXIMO) return 0;
+
+  EscritorBits escritor = {destino, capacidad, 0, 0, 0, false};
+
+  // Encabezado: deflate, sin nombre ni fecha, sistema desconocido
+  static const uint8_t ENCABEZADO[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+  for (uint8_t byte : ENCABEZADO) escribirByte(&escritor, byte);
+
+  // Un solo bloque final con códigos fijos
+  escribirBits(&escritor, 1, 1);
+  escribirBits(&escritor, 1, 2);
+
+  // Última posición en la que apareció cada hash de tres bytes
+  uint16_t ultima[1 << GZIP_BITS_HASH];
+  memset(ultima, 0xFF, sizeof(ultima));
+
+  size_t i = 0;
+  while (i < largo && !escritor.lleno) {
+    size_t mejor = 0;
+    size_t distancia = 0;
+    if (largo - i >= GZIP_COINCIDENCIA_MINIMA) {
+      uint32_t hash = hashTres(datos + i);
+      uint16_t candidata = ultima[hash];
+      ultima[hash] = i;
+      if (candidata != GZIP_SIN_POSICION && i - candidata <= GZIP_VENTANA) {
+        size_t maximo = largo - i < GZIP_COINCIDENCIA_MAXIMA ? largo - i : GZIP_COINCIDENCIA_MAXIMA;
+        while (mejor < maximo && datos[candidata + mejor] == datos[i + mejor]) mejor++;
+        distancia = i - candidata;
+      }
+    }
+
+    if (mejor < GZIP_COINCIDENCIA_MINIMA) {
+      escribirSimbolo(&escritor, datos[i++]);
+      continue;
+    }
+
+    escribirCoincidencia(&escritor, mejor, distancia);
+    for (size_t j = i + 1; j < i + mejor && largo - j >= GZIP_COINCIDENCIA_MINIMA; j++) {
+      ultima[hashTres(datos + j)] = j;
+    }
+    i += mejor;
+  }
+
+  // Fin de bloque y lo que quede del último byte
+  escribirSimbolo(&escritor, 256);
+  if (escritor.cantidad > 0) escribirBits(&escritor, 0, 8 - escritor.cantidad);
+
+  // Cola: CRC32 y largo original, en little endian
+  uint32_t cola[2] = {calcularCrc32(datos, largo), (uint32_t)largo};
+  for (uint32_t valor : cola) {
+    for (uint8_t b = 0; b < 4; b++) escribirByte(&escritor, (valor >> (8 * b)) & 0xFF);
+  }
+
+  return escritor.lleno ? 0 : escritor.largo;
+}
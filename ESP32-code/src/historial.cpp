@@ -0,0 +1,300 @@
+#include "historial.h"
+
+#include "serie.h"
+
+static_assert(tamanoMaximoSerie(60) <= HISTORIAL_BYTES_SERIES, "Una hora de minutos tiene que entrar siempre");
+
+static void vaciar(PuntoGuardado* punto) {
+  for (int16_t& valor : punto->valores) valor = HISTORIAL_VACIO;
+}
+
+static bool estaVacio(const PuntoGuardado& punto) {
+  for (int16_t valor : punto.valores) {
+    if (valor != HISTORIAL_VACIO) return false;
+  }
+  return true;
+}
+
+static int16_t promedio(int32_t suma, int32_t cantidad) {
+  // Redondeo al más cercano, también con negativos
+  int32_t resultado = suma >= 0 ? (suma + cantidad / 2) / cantidad : (suma - cantidad / 2) / cantidad;
+  return (int16_t)resultado;
+}
+
+// Suma de los puntos con datos, campo por campo, para promediarlos
+struct Suma {
+  int32_t valores[CANTIDAD_CAMPOS_HISTORIAL] = {};
+  int32_t cantidades[CANTIDAD_CAMPOS_HISTORIAL] = {};
+};
+
+static void sumar(Suma* suma, const PuntoGuardado& punto) {
+  for (size_t i = 0; i < CANTIDAD_CAMPOS_HISTORIAL; i++) {
+    if (punto.valores[i] == HISTORIAL_VACIO) continue;
+    suma->valores[i] += punto.valores[i];
+    suma->cantidades[i]++;
+  }
+}
+
+// Promedia cada campo en 'destino' (vacío si no tuvo datos). Devuelve si
+// algún campo tuvo.
+template <typename T>
+static bool promediarSuma(const Suma& suma, T* destino) {
+  bool hayDatos = false;
+  for (size_t i = 0; i < CANTIDAD_CAMPOS_HISTORIAL; i++) {
+    if (suma.cantidades[i] == 0) {
+      destino[i] = HISTORIAL_VACIO;
+      continue;
+    }
+    destino[i] = promedio(suma.valores[i], suma.cantidades[i]);
+    hayDatos = true;
+  }
+  return hayDatos;
+}
+
+static void reiniciarMinuto(Historial* historial) {
+  for (size_t i = 0; i < CANTIDAD_CAMPOS_HISTORIAL; i++) {
+    historial->sumas[i] = 0;
+    historial->muestras[i] = 0;
+  }
+}
+
+void iniciarHistorial(Historial* historial) {
+  for (PuntoGuardado& punto : historial->minutos) vaciar(&punto);
+  for (BloqueHora& bloque : historial->bloques) bloque.largo = 0;
+  for (PuntoGuardado& punto : historial->horas) vaciar(&punto);
+  historial->escritura = 0;
+  historial->primeraHoraMinutos = 0;
+  historial->ultimoMinuto = 0;
+  historial->hayDatos = false;
+  reiniciarMinuto(historial);
+}
+
+// ---- Series de las horas cerradas ----
+
+// Suelta las series que se superponen con [inicio, fin) del anillo. Como se
+// escribe en orden, son siempre las más viejas.
+static void soltarSeries(Historial* historial, size_t inicio, size_t fin) {
+  for (BloqueHora& bloque : historial->bloques) {
+    if (bloque.largo == 0 || bloque.inicio >= fin || bloque.inicio + bloque.largo <= inicio) continue;
+    bloque.largo = 0;
+    if (bloque.hora >= historial->primeraHoraMinutos) historial->primeraHoraMinutos = bloque.hora + 1;
+  }
+}
+
+// Comprime los minutos de la hora en curso ('hora') a partir de 'inicio'.
+// Devuelve false si no entran antes del final del anillo.
+//
+// La serie no tiene campos vacíos: un campo sin datos va con el valor del
+// minuto anterior (un bit) y con su bit prendido en los segundos del
+// timestamp, que en un minuto son siempre 0.
+static bool comprimirMinutos(Historial* historial, uint32_t hora, size_t inicio, CompresorSerie* compresor) {
+  if (!iniciarCompresor(compresor, historial->series + inicio, HISTORIAL_BYTES_SERIES - inicio, "")) return false;
+
+  Medicion medicion = {};
+  for (uint32_t i = 0; i < 60; i++) {
+    const PuntoGuardado& punto = historial->minutos[i];
+    if (estaVacio(punto)) continue;
+
+    uint32_t vacios = 0;
+    for (size_t c = 0; c < CANTIDAD_CAMPOS_HISTORIAL; c++) {
+      if (punto.valores[c] == HISTORIAL_VACIO) {
+        vacios |= 1u << c;  // Queda el anterior, o 0 en el primero: entra en el rango de los tres
+      } else {
+        medicion.numeros[CAMPOS_HISTORIAL[c]] = punto.valores[c];
+      }
+    }
+    medicion.numeros[CAMPO_TIMESTAMP] = (int64_t)(hora * 60 + i) * 60 + vacios;
+    if (!agregarMedicion(compresor, medicion)) return false;
+  }
+  return true;
+}
+
+// Guarda los minutos de la hora en curso como una serie
+static void guardarMinutos(Historial* historial, uint32_t hora, bool hayDatos) {
+  BloqueHora* bloque = &historial->bloques[hora % HISTORIAL_BLOQUES];
+  bloque->largo = 0;  // La de hace HISTORIAL_BLOQUES horas
+  if (!hayDatos) return;
+
+  CompresorSerie compresor;
+  size_t inicio = historial->escritura;
+  if (!comprimirMinutos(historial, hora, inicio, &compresor)) {
+    // No entra hasta el final: lo que quedaba ahí se pierde y se da la vuelta
+    soltarSeries(historial, inicio, HISTORIAL_BYTES_SERIES);
+    inicio = 0;
+    comprimirMinutos(historial, hora, inicio, &compresor);
+  }
+
+  size_t largo = largoSerie(compresor);
+  soltarSeries(historial, inicio, inicio + largo);
+  bloque->hora = hora;
+  bloque->inicio = (uint16_t)inicio;
+  bloque->largo = (uint16_t)largo;
+  historial->escritura = (uint16_t)(inicio + largo);
+}
+
+// Promedia los minutos de 'hora' (los de la hora en curso) y los guarda
+static void cerrarHora(Historial* historial, uint32_t hora) {
+  Suma suma;
+  for (const PuntoGuardado& punto : historial->minutos) sumar(&suma, punto);
+
+  bool hayDatos = promediarSuma(suma, historial->horas[hora % HISTORIAL_HORAS].valores);
+  guardarMinutos(historial, hora, hayDatos);
+}
+
+// Pasa al minuto 'minuto': cierra la hora terminada y vacía las horas que
+// quedaron sin datos en el medio
+static void avanzar(Historial* historial, uint32_t minuto) {
+  uint32_t horaAnterior = historial->ultimoMinuto / 60;
+  uint32_t horaNueva = minuto / 60;
+
+  if (horaNueva > horaAnterior) {
+    cerrarHora(historial, horaAnterior);
+    for (PuntoGuardado& punto : historial->minutos) vaciar(&punto);
+  }
+  for (uint32_t hora = horaAnterior + 1; hora < horaNueva && hora - horaAnterior <= HISTORIAL_HORAS; hora++) {
+    vaciar(&historial->horas[hora % HISTORIAL_HORAS]);
+  }
+
+  historial->ultimoMinuto = minuto;
+  reiniciarMinuto(historial);
+}
+
+void registrarHistorial(Historial* historial, const Medicion& medicion, uint8_t rechazadas) {
+  uint32_t minuto = (uint32_t)(medicion.numeros[CAMPO_TIMESTAMP] / 60);
+
+  // La hora fue para atrás (se sincronizó el reloj): lo guardado no sirve
+  if (historial->hayDatos && minuto < historial->ultimoMinuto) iniciarHistorial(historial);
+
+  if (!historial->hayDatos) {
+    historial->hayDatos = true;
+    historial->ultimoMinuto = minuto;
+    historial->primeraHoraMinutos = minuto / 60;
+  } else if (minuto > historial->ultimoMinuto) {
+    avanzar(historial, minuto);
+  }
+
+  // Un campo rechazado repite el valor anterior: no suma al promedio
+  PuntoGuardado* punto = &historial->minutos[minuto % 60];
+  for (size_t i = 0; i < CANTIDAD_CAMPOS_HISTORIAL; i++) {
+    if (rechazadas & (1u << i)) continue;
+    historial->sumas[i] += (int32_t)medicion.numeros[CAMPOS_HISTORIAL[i]];
+    historial->muestras[i]++;
+    punto->valores[i] = promedio(historial->sumas[i], historial->muestras[i]);
+  }
+}
+
+// ---- Consultas ----
+
+void iniciarConsulta(ConsultaHistorial* consulta, const Historial* historial, uint32_t desde,
+                     uint32_t hasta, uint32_t paso) {
+  paso -= paso % 60;
+  if (paso == 0) paso = 60;
+
+  consulta->historial = historial;
+  consulta->paso = paso;
+  consulta->siguiente = desde - desde % paso;
+  consulta->hasta = hasta;
+  consulta->hayDescomprimida = false;
+}
+
+// Los minutos de 'hora', o nullptr si ya no están. Los de una hora cerrada
+// se descomprimen en la consulta, que guarda la última.
+static const PuntoGuardado* minutosDeHora(ConsultaHistorial* consulta, uint32_t hora) {
+  const Historial* historial = consulta->historial;
+  if (hora == historial->ultimoMinuto / 60) return historial->minutos;
+  if (consulta->hayDescomprimida && consulta->horaDescomprimida == hora) return consulta->minutos;
+
+  const BloqueHora& bloque = historial->bloques[hora % HISTORIAL_BLOQUES];
+  if (bloque.largo == 0 || bloque.hora != hora) return nullptr;
+
+  for (PuntoGuardado& punto : consulta->minutos) vaciar(&punto);
+  LectorSerie lector;
+  Medicion medicion;
+  if (iniciarLectorSerie(&lector, historial->series + bloque.inicio, bloque.largo)) {
+    while (leerMedicion(&lector, &medicion)) {
+      uint32_t timestamp = (uint32_t)medicion.numeros[CAMPO_TIMESTAMP];
+      uint32_t minuto = timestamp / 60 - hora * 60;
+      if (minuto >= 60) continue;
+
+      // Los segundos marcan los campos vacíos (ver comprimirMinutos())
+      for (size_t c = 0; c < CANTIDAD_CAMPOS_HISTORIAL; c++) {
+        bool vacio = (timestamp % 60) & (1u << c);
+        consulta->minutos[minuto].valores[c] = vacio ? HISTORIAL_VACIO : (int16_t)medicion.numeros[CAMPOS_HISTORIAL[c]];
+      }
+    }
+  }
+  consulta->horaDescomprimida = hora;
+  consulta->hayDescomprimida = true;
+  return consulta->minutos;
+}
+
+// Promedia los minutos [primero, ultimo]
+static bool promediarMinutos(ConsultaHistorial* consulta, uint32_t primero, uint32_t ultimo, PuntoHistorial* punto) {
+  Suma suma;
+  for (uint32_t hora = primero / 60; hora <= ultimo / 60; hora++) {
+    const PuntoGuardado* minutos = minutosDeHora(consulta, hora);
+    if (minutos == nullptr) continue;
+
+    uint32_t desde = hora == primero / 60 ? primero % 60 : 0;
+    uint32_t hasta = hora == ultimo / 60 ? ultimo % 60 : 59;
+    for (uint32_t i = desde; i <= hasta; i++) sumar(&suma, minutos[i]);
+  }
+  return promediarSuma(suma, punto->valores);
+}
+
+// Promedia las horas [primera, ultima] del anillo de horas
+static bool promediarHoras(const Historial* historial, uint32_t primera, uint32_t ultima, PuntoHistorial* punto) {
+  Suma suma;
+  for (uint32_t hora = primera; hora <= ultima; hora++) sumar(&suma, historial->horas[hora % HISTORIAL_HORAS]);
+  return promediarSuma(suma, punto->valores);
+}
+
+bool siguientePunto(ConsultaHistorial* consulta, PuntoHistorial* punto) {
+  const Historial* historial = consulta->historial;
+  if (!historial->hayDatos) return false;
+
+  uint32_t ultimoMinuto = historial->ultimoMinuto;
+  uint32_t horaActual = ultimoMinuto / 60;
+
+  // Quedan los minutos de las últimas HISTORIAL_BLOQUES horas cerradas,
+  // salvo las series que ya se pisaron por falta de lugar
+  uint32_t primeraHoraMinutos = horaActual >= HISTORIAL_BLOQUES ? horaActual - HISTORIAL_BLOQUES : 0;
+  if (historial->primeraHoraMinutos > primeraHoraMinutos) primeraHoraMinutos = historial->primeraHoraMinutos;
+  uint32_t primerMinuto = primeraHoraMinutos * 60;
+
+  // La hora en curso no está cerrada y su casillero todavía tiene la de
+  // hace HISTORIAL_HORAS horas
+  uint32_t primeraHora = horaActual >= HISTORIAL_HORAS - 1 ? horaActual - (HISTORIAL_HORAS - 1) : 0;
+
+  // Nada antes de lo más viejo que se guarda
+  uint32_t masViejo = primeraHora * 3600 < primerMinuto * 60 ? primeraHora * 3600 : primerMinuto * 60;
+  if (consulta->siguiente < masViejo) {
+    consulta->siguiente = masViejo - masViejo % consulta->paso;
+  }
+
+  while (consulta->siguiente < consulta->hasta && consulta->siguiente / 60 <= ultimoMinuto) {
+    uint32_t inicio = consulta->siguiente;
+    bool hayPunto;
+
+    if (inicio / 60 >= primerMinuto) {
+      uint32_t ultimo = (inicio + consulta->paso) / 60 - 1;
+      if (ultimo > ultimoMinuto) ultimo = ultimoMinuto;
+      hayPunto = promediarMinutos(consulta, inicio / 60, ultimo, punto);
+      punto->paso = consulta->paso;
+    } else {
+      // Solo quedan horas: el paso es de al menos una hora
+      inicio -= inicio % 3600;
+      uint32_t largo = consulta->paso > 3600 ? consulta->paso - consulta->paso % 3600 : 3600;
+      uint32_t primera = inicio / 3600 > primeraHora ? inicio / 3600 : primeraHora;
+      uint32_t ultima = (inicio + largo) / 3600 - 1;
+      if (ultima >= horaActual) ultima = horaActual - 1;
+      hayPunto = promediarHoras(historial, primera, ultima, punto);
+      punto->paso = largo;
+    }
+
+    punto->timestamp = inicio;
+    consulta->siguiente = inicio + punto->paso;
+    if (hayPunto) return true;
+  }
+  return false;
+}
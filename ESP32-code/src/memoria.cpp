@@ -0,0 +1,119 @@
+#include "memoria.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Solo se anota lo que pide la tarea de loop(), así que los contadores los
+// toca una sola tarea y no necesitan ser atómicos
+static const Planificador* planificador = nullptr;
+static TaskHandle_t tareaLoop = nullptr;
+static bool enSetup = false;
+static AsignacionesMemoria deSetup;
+static AsignacionesMemoria fueraDeTareas;
+static AsignacionesMemoria porTarea[PLANIFICADOR_MAXIMO_TAREAS];
+static uint32_t prohibidas = 0;  // Un bit por tarea
+
+static_assert(PLANIFICADOR_MAXIMO_TAREAS <= 32, "prohibidas tiene un bit por tarea");
+
+#if MEMORIA_ESTATICA
+static void anotar(size_t bytes) {
+  if (planificador == nullptr || xTaskGetCurrentTaskHandle() != tareaLoop) return;
+
+  int tarea = planificador->ejecutando;
+  AsignacionesMemoria& a = enSetup ? deSetup : tarea == TAREA_INVALIDA ? fueraDeTareas : porTarea[tarea];
+  a.cantidad++;
+  a.bytes += bytes;
+
+#if MEMORIA_ESTATICA >= 2
+  if (!enSetup && tarea != TAREA_INVALIDA && (prohibidas & (1u << tarea))) abort();
+#endif
+}
+
+// El linker manda acá las llamadas a malloc() y compañía (-Wl,--wrap=...).
+// new y String terminan en ellas.
+extern "C" {
+void* __real_malloc(size_t bytes);
+void* __real_calloc(size_t cantidad, size_t bytes);
+void* __real_realloc(void* anterior, size_t bytes);
+
+void* __wrap_malloc(size_t bytes) {
+  anotar(bytes);
+  return __real_malloc(bytes);
+}
+
+void* __wrap_calloc(size_t cantidad, size_t bytes) {
+  anotar(cantidad * bytes);
+  return __real_calloc(cantidad, bytes);
+}
+
+void* __wrap_realloc(void* anterior, size_t bytes) {
+  anotar(bytes);
+  return __real_realloc(anterior, bytes);
+}
+}
+#endif
+
+void iniciarMemoria(const Planificador* p) {
+  tareaLoop = xTaskGetCurrentTaskHandle();
+  enSetup = true;
+  planificador = p;
+}
+
+void terminarSetupMemoria() {
+  enSetup = false;
+}
+
+void prohibirAsignaciones(int tarea) {
+  if (tarea >= 0 && tarea < PLANIFICADOR_MAXIMO_TAREAS) prohibidas |= 1u << tarea;
+}
+
+EstadoHeap estadoHeap() {
+  return {ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap()};
+}
+
+AsignacionesMemoria asignacionesSetup() {
+  return deSetup;
+}
+
+AsignacionesMemoria asignacionesFueraDeTareas() {
+  return fueraDeTareas;
+}
+
+AsignacionesMemoria asignacionesTarea(int tarea) {
+  if (tarea < 0 || tarea >= PLANIFICADOR_MAXIMO_TAREAS) return {0, 0};
+  return porTarea[tarea];
+}
+
+size_t describirMemoria(char* destino, size_t largo) {
+  EstadoHeap heap = estadoHeap();
+  int escrito = snprintf(destino, largo,
+                         "{\"static_mode\":%d,\"heap_free\":%lu,\"heap_min_free\":%lu,\"heap_max_block\":%lu",
+                         MEMORIA_ESTATICA, (unsigned long)heap.libre, (unsigned long)heap.minimoLibre,
+                         (unsigned long)heap.bloqueMaximo);
+
+#if MEMORIA_ESTATICA
+  // Lo de setup(), lo de loop() fuera de las tareas y cada tarea
+  if (escrito >= 0 && (size_t)escrito < largo) {
+    escrito += snprintf(destino + escrito, largo - escrito,
+                        ",\"setup\":{\"allocations\":%lu,\"bytes\":%lu},\"loop\":{\"allocations\":%lu,\"bytes\":%lu}"
+                        ",\"tasks\":[",
+                        (unsigned long)deSetup.cantidad, (unsigned long)deSetup.bytes,
+                        (unsigned long)fueraDeTareas.cantidad, (unsigned long)fueraDeTareas.bytes);
+  }
+  uint8_t cantidad = planificador != nullptr ? planificador->cantidad : 0;
+  for (uint8_t i = 0; i < cantidad && escrito >= 0 && (size_t)escrito < largo; i++) {
+    escrito += snprintf(destino + escrito, largo - escrito,
+                        "%s{\"name\":\"%s\",\"allocations\":%lu,\"bytes\":%lu,\"forbidden\":%s}", i == 0 ? "" : ",",
+                        planificador->tareas[i].nombre, (unsigned long)porTarea[i].cantidad,
+                        (unsigned long)porTarea[i].bytes, prohibidas & (1u << i) ? "true" : "false");
+  }
+  if (escrito >= 0 && (size_t)escrito < largo) escrito += snprintf(destino + escrito, largo - escrito, "]");
+#endif
+
+  if (escrito >= 0 && (size_t)escrito < largo) escrito += snprintf(destino + escrito, largo - escrito, "}");
+  if (escrito < 0) return 0;
+  return (size_t)escrito < largo ? escrito : largo - 1;
+}
@@ -0,0 +1,162 @@
+#include "muestreo.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+ConfiguracionMuestreo configuracionMuestreoInicial() {
+  ConfiguracionMuestreo configuracion;
+  configuracion.intervaloRapidoMs = INTERVALO_ENVIO_MS;
+  configuracion.intervaloLentoMs = INTERVALO_LENTO_MS;
+  configuracion.bandaPh = 0.05;
+  configuracion.bandaTemperatura = 0.3;
+  configuracion.bandaTds = 15;
+  configuracion.phMinimo = 7.2;
+  configuracion.phMaximo = 7.8;
+  configuracion.temperaturaMinima = 10;
+  configuracion.temperaturaMaxima = 32;
+  configuracion.tdsMinimo = 0;
+  configuracion.tdsMaximo = 1500;
+  configuracion.lote = 1;
+  return configuracion;
+}
+
+void iniciarMuestreo(EstadoMuestreo* estado, const ConfiguracionMuestreo& configuracion) {
+  estado->hayAnterior = false;
+  estado->ph = estado->temperatura = estado->tds = 0;
+  estado->intervaloMs = configuracion.intervaloRapidoMs;
+  estado->acelerado = true;
+}
+
+static bool fueraDeRango(float valor, float minimo, float maximo) {
+  return valor < minimo || valor > maximo;
+}
+
+uint32_t planificarMuestreo(EstadoMuestreo* estado, const ConfiguracionMuestreo& configuracion,
+                            const Lectura& lectura) {
+  bool moviendose = !estado->hayAnterior ||
+                    fabsf(lectura.ph - estado->ph) > configuracion.bandaPh ||
+                    fabsf(lectura.temperatura - estado->temperatura) > configuracion.bandaTemperatura ||
+                    fabsf(lectura.tds - estado->tds) > configuracion.bandaTds;
+
+  bool fuera = fueraDeRango(lectura.ph, configuracion.phMinimo, configuracion.phMaximo) ||
+               fueraDeRango(lectura.temperatura, configuracion.temperaturaMinima, configuracion.temperaturaMaxima) ||
+               fueraDeRango(lectura.tds, configuracion.tdsMinimo, configuracion.tdsMaximo);
+
+  estado->hayAnterior = true;
+  estado->ph = lectura.ph;
+  estado->temperatura = lectura.temperatura;
+  estado->tds = lectura.tds;
+  estado->acelerado = moviendose || fuera;
+
+  if (estado->acelerado) {
+    estado->intervaloMs = configuracion.intervaloRapidoMs;
+  } else {
+    // Quieto: se va espaciando de a poco
+    uint32_t siguiente = estado->intervaloMs * 2;
+    if (siguiente < configuracion.intervaloRapidoMs) siguiente = configuracion.intervaloRapidoMs;
+    if (siguiente > configuracion.intervaloLentoMs) siguiente = configuracion.intervaloLentoMs;
+    estado->intervaloMs = siguiente;
+  }
+  return estado->intervaloMs;
+}
+
+// ---- Mensajes de control ----
+
+enum TipoClave : uint8_t { CLAVE_ENTERO, CLAVE_REAL, CLAVE_LOTE };
+
+struct ClaveControl {
+  const char* nombre;
+  TipoClave tipo;
+  uint32_t ConfiguracionMuestreo::*entero;
+  float ConfiguracionMuestreo::*real;
+};
+
+static const ClaveControl CLAVES[] = {
+  {"intervalo_rapido_ms", CLAVE_ENTERO, &ConfiguracionMuestreo::intervaloRapidoMs, nullptr},
+  {"intervalo_lento_ms", CLAVE_ENTERO, &ConfiguracionMuestreo::intervaloLentoMs, nullptr},
+  {"banda_ph", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::bandaPh},
+  {"banda_temperatura", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::bandaTemperatura},
+  {"banda_tds", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::bandaTds},
+  {"ph_min", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::phMinimo},
+  {"ph_max", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::phMaximo},
+  {"temperatura_min", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::temperaturaMinima},
+  {"temperatura_max", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::temperaturaMaxima},
+  {"tds_min", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::tdsMinimo},
+  {"tds_max", CLAVE_REAL, nullptr, &ConfiguracionMuestreo::tdsMaximo},
+  {"lote", CLAVE_LOTE, nullptr, nullptr},
+};
+
+static bool configuracionValida(const ConfiguracionMuestreo& c) {
+  return c.intervaloRapidoMs >= INTERVALO_MINIMO_PERMITIDO_MS &&
+         c.intervaloLentoMs >= c.intervaloRapidoMs &&
+         c.intervaloLentoMs <= INTERVALO_MAXIMO_PERMITIDO_MS &&
+         c.bandaPh >= 0 && c.bandaTemperatura >= 0 && c.bandaTds >= 0 &&
+         c.phMinimo <= c.phMaximo && c.temperaturaMinima <= c.temperaturaMaxima &&
+         c.tdsMinimo <= c.tdsMaximo &&
+         c.lote >= 1 && c.lote <= LOTE_MAXIMO;
+}
+
+static bool aplicarPar(ConfiguracionMuestreo* c, const char* clave, const char* valor) {
+  for (const ClaveControl& definicion : CLAVES) {
+    if (strcmp(clave, definicion.nombre) != 0) continue;
+
+    char* fin;
+    if (definicion.tipo == CLAVE_REAL) {
+      float numero = strtof(valor, &fin);
+      if (fin == valor || *fin != '\0' || !isfinite(numero)) return false;
+      c->*definicion.real = numero;
+    } else {
+      if (*valor == '-') return false;
+      unsigned long numero = strtoul(valor, &fin, 10);
+      if (fin == valor || *fin != '\0' || numero > INTERVALO_MAXIMO_PERMITIDO_MS) return false;
+      if (definicion.tipo == CLAVE_LOTE) {
+        c->lote = numero > LOTE_MAXIMO ? 0 : (uint8_t)numero;
+      } else {
+        c->*definicion.entero = numero;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+bool aplicarControlMuestreo(ConfiguracionMuestreo* configuracion, const char* texto, size_t largo) {
+  if (largo >= LARGO_MAXIMO_CONTROL) return false;
+
+  char copia[LARGO_MAXIMO_CONTROL];
+  memcpy(copia, texto, largo);
+  copia[largo] = '\0';
+
+  // Se trabaja sobre una copia para aplicar todo o nada
+  ConfiguracionMuestreo nueva = *configuracion;
+  bool algunaClave = false;
+
+  char* resto;
+  for (char* par = strtok_r(copia, " ,\r\n\t", &resto); par; par = strtok_r(nullptr, " ,\r\n\t", &resto)) {
+    char* igual = strchr(par, '=');
+    if (!igual) return false;
+    *igual = '\0';
+    if (!aplicarPar(&nueva, par, igual + 1)) return false;
+    algunaClave = true;
+  }
+
+  if (!algunaClave || !configuracionValida(nueva)) return false;
+  *configuracion = nueva;
+  return true;
+}
+
+size_t describirMuestreo(const ConfiguracionMuestreo& c, char* destino, size_t largo) {
+  int escritos = snprintf(destino, largo,
+                          "intervalo_rapido_ms=%lu intervalo_lento_ms=%lu lote=%u "
+                          "banda_ph=%g banda_temperatura=%g banda_tds=%g "
+                          "ph_min=%g ph_max=%g temperatura_min=%g temperatura_max=%g "
+                          "tds_min=%g tds_max=%g",
+                          (unsigned long)c.intervaloRapidoMs, (unsigned long)c.intervaloLentoMs,
+                          (unsigned)c.lote, c.bandaPh, c.bandaTemperatura, c.bandaTds,
+                          c.phMinimo, c.phMaximo, c.temperaturaMinima, c.temperaturaMaxima,
+                          c.tdsMinimo, c.tdsMaximo);
+  if (escritos < 0) return 0;
+  return (size_t)escritos < largo ? escritos : largo - 1;
+}
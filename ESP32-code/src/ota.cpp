@@ -0,0 +1,391 @@
+#include "ota.h"
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <Update.h>
+#include <esp_attr.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+#include <mbedtls/md.h>
+#include <string.h>
+#include "delta.h"
+#include "esp32/rom/miniz.h"
+#include "registro_uart.h"
+
+#define OTA_MAGICO 0x4f544131  // "OTA1"
+#define OTA_LARGO_MANIFEST 512
+#define OTA_LARGO_PEDIDO 256  // Lo que se firma en el pedido
+
+static_assert(sizeof(VERSION_FIRMWARE) <= OTA_LARGO_VERSION, "VERSION_FIRMWARE es demasiado larga");
+
+// Lo que tiene que sobrevivir al reinicio después de instalar
+struct EstadoOta {
+  uint32_t magico;
+  RedGuardada red;
+  char version[OTA_LARGO_VERSION];
+  char versionAnterior[OTA_LARGO_VERSION];
+  bool porDelta;
+  uint32_t bytesDescargados;
+  uint32_t msDescarga;
+  uint32_t msAplicacion;
+};
+
+RTC_NOINIT_ATTR static EstadoOta estadoOta;
+
+// La imagen que corre quedó a prueba (recién instalada, sin confirmar)
+static bool aPrueba() {
+  esp_ota_img_states_t estado;
+  if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &estado) != ESP_OK) return false;
+  return estado == ESP_OTA_IMG_PENDING_VERIFY;
+}
+
+// Con la imagen nueva a prueba, el core de Arduino no la confirma al
+// arrancar: lo hace confirmarActualizacion()
+extern "C" bool verifyRollbackLater() {
+  return true;
+}
+
+bool firmaOtaValida(const char* texto, size_t largo, const char* firma) {
+  if (sizeof(OTA_CLAVE) <= 1 || strlen(firma) != 64) return false;
+
+  uint8_t hmac[32];
+  if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), (const uint8_t*)OTA_CLAVE,
+                      sizeof(OTA_CLAVE) - 1, (const uint8_t*)texto, largo, hmac) != 0) {
+    return false;
+  }
+
+  // Se recorre entera aunque difiera al principio, para no dar pistas por
+  // el tiempo de respuesta
+  static const char HEXA[] = "0123456789abcdef";
+  uint8_t diferencia = 0;
+  for (size_t i = 0; i < sizeof(hmac); i++) {
+    diferencia |= (uint8_t)(firma[2 * i] ^ HEXA[hmac[i] >> 4]) | (uint8_t)(firma[2 * i + 1] ^ HEXA[hmac[i] & 0xf]);
+  }
+  return diferencia == 0;
+}
+
+// ---- Pedido de actualización ----
+
+static char desafio[OTA_LARGO_DESAFIO];
+static unsigned long msDesafio = 0;
+
+void nuevoDesafioOta(char* destino) {
+  snprintf(desafio, sizeof(desafio), "%08lx%08lx", (unsigned long)esp_random(), (unsigned long)esp_random());
+  msDesafio = millis();
+  strcpy(destino, desafio);
+}
+
+bool pedidoOtaValido(const char* idDispositivo, const char* servidor, const char* firma) {
+  bool vigente = desafio[0] != '\0' && millis() - msDesafio < OTA_VIGENCIA_DESAFIO_MS;
+  char texto[OTA_LARGO_PEDIDO];
+  int largo = snprintf(texto, sizeof(texto), "%s\n%s\n%s", idDispositivo, desafio, servidor);
+  desafio[0] = '\0';  // De un solo uso, salga bien o mal
+  return vigente && largo > 0 && (size_t)largo < sizeof(texto) && firmaOtaValida(texto, largo, firma);
+}
+
+// ---- manifest.txt ----
+
+struct Manifest {
+  char version[OTA_LARGO_VERSION];
+  char md5[33];
+  uint32_t tamano;
+  char completa[64];
+  char delta[64];
+  char baseMd5[33];
+};
+
+// Devuelve false si el valor no entra
+static bool copiarValor(char* destino, size_t largo, const char* valor) {
+  if (strlen(valor) >= largo) return false;
+  strcpy(destino, valor);
+  return true;
+}
+
+// Líneas "clave=valor"; las claves desconocidas se ignoran
+static bool leerManifest(char* texto, Manifest* manifest) {
+  memset(manifest, 0, sizeof(*manifest));
+
+  bool ok = true;
+  for (char* linea = strtok(texto, "\r\n"); linea; linea = strtok(nullptr, "\r\n")) {
+    char* igual = strchr(linea, '=');
+    if (!igual) continue;
+    *igual = '\0';
+    const char* valor = igual + 1;
+
+    if (strcmp(linea, "version") == 0) ok &= copiarValor(manifest->version, sizeof(manifest->version), valor);
+    else if (strcmp(linea, "md5") == 0) ok &= copiarValor(manifest->md5, sizeof(manifest->md5), valor);
+    else if (strcmp(linea, "tamano") == 0) manifest->tamano = strtoul(valor, nullptr, 10);
+    else if (strcmp(linea, "completa") == 0) ok &= copiarValor(manifest->completa, sizeof(manifest->completa), valor);
+    else if (strcmp(linea, "delta") == 0) ok &= copiarValor(manifest->delta, sizeof(manifest->delta), valor);
+    else if (strcmp(linea, "base_md5") == 0) ok &= copiarValor(manifest->baseMd5, sizeof(manifest->baseMd5), valor);
+  }
+
+  return ok && manifest->version[0] && strlen(manifest->md5) == 32 && manifest->tamano > 0 && manifest->completa[0];
+}
+
+static bool bajarManifest(const char* servidor, Manifest* manifest) {
+  HTTPClient http;
+  http.begin(String(servidor) + "/manifest.txt");
+
+  int codigo = http.GET();
+  if (codigo != HTTP_CODE_OK) {
+    REG_ERROR("OTA: no se pudo bajar manifest.txt (%d)", codigo);
+    http.end();
+    return false;
+  }
+
+  char texto[OTA_LARGO_MANIFEST];
+  WiFiClient* flujo = http.getStreamPtr();
+  size_t largo = 0;
+  unsigned long inicio = millis();
+  while (largo < sizeof(texto) - 1 && (http.connected() || flujo->available()) &&
+         millis() - inicio < OTA_TIMEOUT_DESCARGA_MS) {
+    if (flujo->available()) {
+      largo += flujo->readBytes((uint8_t*)texto + largo, sizeof(texto) - 1 - largo);
+    } else {
+      delay(1);
+    }
+  }
+  texto[largo] = '\0';
+  http.end();
+
+  // La línea "firma=" cubre todo lo anterior; lo que venga después no se lee
+  char* lineaFirma = strstr(texto, "\nfirma=");
+  if (lineaFirma == nullptr) {
+    REG_ERROR("OTA: manifest.txt sin firma");
+    return false;
+  }
+  char* firma = lineaFirma + 7;
+  firma[strcspn(firma, "\r\n")] = '\0';
+  if (!firmaOtaValida(texto, lineaFirma + 1 - texto, firma)) {
+    REG_ERROR("OTA: la firma de manifest.txt no coincide con OTA_CLAVE");
+    return false;
+  }
+  lineaFirma[1] = '\0';
+
+  if (!leerManifest(texto, manifest)) {
+    REG_ERROR("OTA: manifest.txt inválido");
+    return false;
+  }
+  return true;
+}
+
+// ---- Destino de los bytes descomprimidos ----
+
+static bool escribirImagen(const uint8_t* datos, size_t largo, void* contexto) {
+  return Update.write(const_cast<uint8_t*>(datos), largo) == largo;
+}
+
+static bool leerImagenActual(uint32_t origen, uint8_t* destino, size_t largo, void* contexto) {
+  const esp_partition_t* actual = (const esp_partition_t*)contexto;
+  return esp_partition_read(actual, origen, destino, largo) == ESP_OK;
+}
+
+static bool agregarAlDelta(const uint8_t* datos, size_t largo, void* contexto) {
+  return agregarDelta((AplicadorDelta*)contexto, datos, largo);
+}
+
+// ---- Descompresión zlib ----
+
+// tinfl (en la ROM del ESP32) necesita como salida un buffer circular del
+// tamaño de la ventana de deflate. Se pide solo durante la actualización.
+struct Descompresor {
+  tinfl_decompressor tinfl;
+  uint8_t ventana[TINFL_LZ_DICT_SIZE];
+  size_t posicion;
+  bool terminado;
+};
+
+static bool descomprimir(Descompresor* d, const uint8_t* entrada, size_t largo,
+                         EscribirDelta consumir, void* contexto) {
+  while (!d->terminado) {
+    size_t leidos = largo;
+    size_t producidos = TINFL_LZ_DICT_SIZE - d->posicion;
+    tinfl_status estado = tinfl_decompress(&d->tinfl, entrada, &leidos, d->ventana,
+                                           d->ventana + d->posicion, &producidos,
+                                           TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+    entrada += leidos;
+    largo -= leidos;
+
+    if (producidos > 0 && !consumir(d->ventana + d->posicion, producidos, contexto)) return false;
+    d->posicion = (d->posicion + producidos) & (TINFL_LZ_DICT_SIZE - 1);
+
+    if (estado < TINFL_STATUS_DONE) return false;
+    if (estado == TINFL_STATUS_DONE) d->terminado = true;
+    else if (estado == TINFL_STATUS_NEEDS_MORE_INPUT && largo == 0) break;
+  }
+
+  // Datos después del final del flujo comprimido
+  return largo == 0;
+}
+
+// ---- Actualización ----
+
+// Compara versiones "1.2.10" número por número (lo que siga a un número
+// dentro de una parte, como "-rc1", no cuenta). Devuelve <0, 0 o >0.
+static int compararVersiones(const char* a, const char* b) {
+  while (*a != '\0' || *b != '\0') {
+    char* finA;
+    char* finB;
+    unsigned long numeroA = strtoul(a, &finA, 10);
+    unsigned long numeroB = strtoul(b, &finB, 10);
+    if (numeroA != numeroB) return numeroA < numeroB ? -1 : 1;
+    a = strchr(finA, '.') ? strchr(finA, '.') + 1 : finA + strlen(finA);
+    b = strchr(finB, '.') ? strchr(finB, '.') + 1 : finB + strlen(finB);
+  }
+  return 0;
+}
+
+// Baja 'archivo' y lo pasa, descomprimido, a 'consumir'. Separa el tiempo
+// de aplicación (descomprimir, armar y grabar) del resto, que es esperar a
+// la red.
+static bool bajarYAplicar(const char* servidor, const char* archivo, EscribirDelta consumir,
+                          void* contexto, uint32_t* bytes, uint32_t* msAplicacion) {
+  Descompresor* d = (Descompresor*)malloc(sizeof(Descompresor));
+  if (!d) {
+    REG_ERROR("OTA: sin memoria para el descompresor");
+    return false;
+  }
+  tinfl_init(&d->tinfl);
+  d->posicion = 0;
+  d->terminado = false;
+
+  HTTPClient http;
+  http.begin(String(servidor) + "/" + archivo);
+  int codigo = http.GET();
+  bool ok = codigo == HTTP_CODE_OK;
+  if (!ok) REG_ERROR("OTA: no se pudo bajar %s (%d)", archivo, codigo);
+
+  WiFiClient* flujo = http.getStreamPtr();
+  uint8_t bloque[OTA_BLOQUE_DESCARGA];
+  unsigned long ultimoDato = millis();
+  unsigned long usAplicacion = 0;
+  *bytes = 0;
+
+  while (ok && !d->terminado && (http.connected() || flujo->available())) {
+    size_t disponibles = flujo->available();
+    if (disponibles == 0) {
+      if (millis() - ultimoDato > OTA_TIMEOUT_DESCARGA_MS) {
+        REG_ERROR("OTA: se cortó la descarga");
+        ok = false;
+      }
+      delay(1);
+      continue;
+    }
+
+    size_t leidos = flujo->readBytes(bloque, disponibles < sizeof(bloque) ? disponibles : sizeof(bloque));
+    ultimoDato = millis();
+    *bytes += leidos;
+
+    unsigned long inicioAplicacion = micros();
+    ok = descomprimir(d, bloque, leidos, consumir, contexto);
+    usAplicacion += micros() - inicioAplicacion;
+    if (!ok) REG_ERROR("OTA: error al descomprimir o aplicar");
+  }
+
+  ok = ok && d->terminado;
+  *msAplicacion = usAplicacion / 1000;
+  http.end();
+  free(d);
+  return ok;
+}
+
+bool actualizarFirmware(const char* servidor, const RedGuardada& red) {
+  Manifest manifest;
+  if (!bajarManifest(servidor, &manifest)) return false;
+
+  // Un manifest viejo también está firmado: volver atrás se hace con el cable
+  if (compararVersiones(manifest.version, VERSION_FIRMWARE) <= 0) {
+    REG_INFO("OTA: el servidor tiene la versión %s y corre la %s, no se actualiza", manifest.version,
+             VERSION_FIRMWARE);
+    return false;
+  }
+
+  // El delta solo sirve si se armó contra esta misma imagen
+  const esp_partition_t* actual = esp_ota_get_running_partition();
+  bool porDelta = manifest.delta[0] && ESP.getSketchMD5() == manifest.baseMd5;
+
+  REG_INFO("OTA: %s -> %s, %s", VERSION_FIRMWARE, manifest.version,
+           porDelta ? manifest.delta : manifest.completa);
+
+  if (!Update.begin(manifest.tamano) || !Update.setMD5(manifest.md5)) {
+    REG_ERROR("OTA: %s", Update.errorString());
+    return false;
+  }
+
+  unsigned long inicio = millis();
+  uint32_t bytes, msAplicacion;
+  bool ok;
+  if (porDelta) {
+    AplicadorDelta delta;
+    iniciarDelta(&delta, leerImagenActual, escribirImagen, (void*)actual, ESP.getSketchSize());
+    ok = bajarYAplicar(servidor, manifest.delta, agregarAlDelta, &delta, &bytes, &msAplicacion) &&
+         deltaCompleto(delta);
+  } else {
+    ok = bajarYAplicar(servidor, manifest.completa, escribirImagen, nullptr, &bytes, &msAplicacion);
+  }
+  unsigned long total = millis() - inicio;
+
+  // end() verifica tamaño y MD5 y recién ahí cambia la partición de arranque
+  if (!ok || !Update.end()) {
+    REG_ERROR("OTA: falló (%s), se sigue con la imagen actual", Update.errorString());
+    Update.abort();
+    return false;
+  }
+
+  estadoOta.magico = OTA_MAGICO;
+  estadoOta.red = red;
+  strcpy(estadoOta.version, manifest.version);
+  strcpy(estadoOta.versionAnterior, VERSION_FIRMWARE);
+  estadoOta.porDelta = porDelta;
+  estadoOta.bytesDescargados = bytes;
+  estadoOta.msAplicacion = msAplicacion;
+  estadoOta.msDescarga = total - msAplicacion;
+
+  REG_INFO("OTA: %u bytes bajados (imagen de %u) en %lu ms, %u ms aplicando; reiniciando",
+           bytes, manifest.tamano, total, msAplicacion);
+  vaciarRegistro();
+  ESP.restart();
+  return true;
+}
+
+bool recuperarRedGuardada(RedGuardada* red) {
+  if (estadoOta.magico != OTA_MAGICO) return false;
+  *red = estadoOta.red;
+  return true;
+}
+
+bool confirmarActualizacion(const char* idDispositivo, char* destino, size_t largo) {
+  if (aPrueba()) {
+    esp_ota_mark_app_valid_cancel_rollback();
+    REG_INFO("OTA: versión %s confirmada", VERSION_FIRMWARE);
+  }
+
+  if (estadoOta.magico != OTA_MAGICO) return false;
+  estadoOta.magico = 0;
+
+  // Si el bootloader volvió a la imagen anterior, VERSION_FIRMWARE no es la
+  // que se instaló
+  bool aplicada = strcmp(estadoOta.version, VERSION_FIRMWARE) == 0;
+  snprintf(destino, largo,
+           "{\"device_id\":\"%s\",\"version\":\"%s\",\"previous\":\"%s\",\"result\":\"%s\","
+           "\"kind\":\"%s\",\"bytes\":%u,\"download_ms\":%u,\"apply_ms\":%u}",
+           idDispositivo, estadoOta.version, estadoOta.versionAnterior,
+           aplicada ? "applied" : "rolled_back", estadoOta.porDelta ? "delta" : "full",
+           estadoOta.bytesDescargados, estadoOta.msDescarga, estadoOta.msAplicacion);
+  return true;
+}
+
+void vigilarActualizacion() {
+  static bool vigilando = aPrueba();
+  if (!vigilando || millis() < OTA_PLAZO_CONFIRMACION_MS) return;
+
+  if (!aPrueba()) {
+    vigilando = false;
+    return;
+  }
+  REG_ERROR("OTA: la versión nueva no publicó a tiempo, volviendo a la anterior");
+  vaciarRegistro();
+  esp_ota_mark_app_invalid_rollback_and_reboot();
+}
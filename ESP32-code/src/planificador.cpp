@@ -0,0 +1,191 @@
+#include "planificador.h"
+
+#include <stdio.h>
+
+// Diferencia con signo entre dos horas del reloj, aunque haya dado la vuelta
+static int32_t diferencia(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b);
+}
+
+static uint32_t ranura(uint32_t hora) {
+  return (hora / PLANIFICADOR_TICK_MS) & (PLANIFICADOR_RANURAS - 1);
+}
+
+static bool valida(const Planificador* planificador, int tarea) {
+  return tarea >= 0 && tarea < planificador->cantidad;
+}
+
+static void colgar(Planificador* planificador, int tarea, uint32_t hora) {
+  Tarea& t = planificador->tareas[tarea];
+  uint32_t r = ranura(hora);
+  t.proxima = hora;
+  t.siguiente = planificador->ranuras[r];
+  planificador->ranuras[r] = tarea;
+  t.activa = true;
+}
+
+static void descolgar(Planificador* planificador, int tarea) {
+  Tarea& t = planificador->tareas[tarea];
+  if (!t.activa) return;
+
+  int8_t* enlace = &planificador->ranuras[ranura(t.proxima)];
+  while (*enlace != tarea) enlace = &planificador->tareas[*enlace].siguiente;
+  *enlace = t.siguiente;
+  t.activa = false;
+}
+
+void iniciarPlanificador(Planificador* planificador, RelojPlanificador reloj) {
+  planificador->cantidad = 0;
+  for (int8_t& r : planificador->ranuras) r = TAREA_INVALIDA;
+  planificador->reloj = reloj;
+  planificador->ultimoTick = reloj() / PLANIFICADOR_TICK_MS;
+  planificador->ejecutando = TAREA_INVALIDA;
+}
+
+int agregarTarea(Planificador* planificador, const char* nombre, FuncionTarea funcion, void* contexto,
+                 uint32_t periodoMs, uint32_t presupuestoMs) {
+  if (planificador->cantidad >= PLANIFICADOR_MAXIMO_TAREAS) return TAREA_INVALIDA;
+
+  int tarea = planificador->cantidad++;
+  Tarea& t = planificador->tareas[tarea];
+  t = Tarea{};
+  t.nombre = nombre;
+  t.funcion = funcion;
+  t.contexto = contexto;
+  t.periodoMs = periodoMs;
+  t.presupuestoMs = presupuestoMs;
+  t.siguiente = TAREA_INVALIDA;
+  return tarea;
+}
+
+void programarTarea(Planificador* planificador, int tarea, uint32_t demoraMs) {
+  if (!valida(planificador, tarea)) return;
+  descolgar(planificador, tarea);
+  colgar(planificador, tarea, planificador->reloj() + demoraMs);
+  planificador->tareas[tarea].tocada = true;
+}
+
+void cambiarPeriodo(Planificador* planificador, int tarea, uint32_t periodoMs) {
+  if (!valida(planificador, tarea)) return;
+  Tarea& t = planificador->tareas[tarea];
+  uint32_t anterior = t.periodoMs;
+  t.periodoMs = periodoMs;
+
+  // Mientras se ejecuta, ejecutarPendientes() la vuelve a programar con el
+  // período nuevo
+  if (!t.activa || tarea == planificador->ejecutando) return;
+
+  uint32_t ahora = planificador->reloj();
+  uint32_t hora = t.proxima - anterior + periodoMs;
+  descolgar(planificador, tarea);
+  colgar(planificador, tarea, diferencia(hora, ahora) > 0 ? hora : ahora);
+}
+
+void detenerTarea(Planificador* planificador, int tarea) {
+  if (!valida(planificador, tarea)) return;
+  descolgar(planificador, tarea);
+  planificador->tareas[tarea].tocada = true;
+}
+
+static void ejecutar(Planificador* planificador, int tarea) {
+  Tarea& t = planificador->tareas[tarea];
+  uint32_t programada = t.proxima;
+
+  planificador->ejecutando = tarea;
+  uint32_t inicio = planificador->reloj();
+  t.funcion(t.contexto);
+  uint32_t fin = planificador->reloj();
+  planificador->ejecutando = TAREA_INVALIDA;
+
+  EstadisticasTarea& e = t.estadisticas;
+  uint32_t atraso = diferencia(inicio, programada) > 0 ? inicio - programada : 0;
+  uint32_t duracion = fin - inicio;
+  e.ejecuciones++;
+  e.atrasoUltimoMs = atraso;
+  if (atraso > e.atrasoMaximoMs) e.atrasoMaximoMs = atraso;
+  e.atrasoTotalMs += atraso;
+  if (duracion > e.duracionMaximaMs) e.duracionMaximaMs = duracion;
+  e.duracionTotalMs += duracion;
+  if (t.presupuestoMs > 0 && duracion > t.presupuestoMs) e.excesos++;
+
+  // Las periódicas siguen un período después de la hora programada, sin
+  // acumular deriva; si quedaron más de un período atrás, no se recuperan
+  // las vueltas perdidas
+  if (t.tocada || t.periodoMs == 0) return;
+  uint32_t hora = programada + t.periodoMs;
+  colgar(planificador, tarea, diferencia(hora, fin) > 0 ? hora : fin + t.periodoMs);
+}
+
+uint32_t ejecutarPendientes(Planificador* planificador) {
+  uint32_t ahora = planificador->reloj();
+  uint32_t tick = ahora / PLANIFICADOR_TICK_MS;
+
+  // Se revisan las ranuras desde la última revisada (inclusive: puede haber
+  // tareas nuevas que vencen en ese mismo tick) hasta la actual, como mucho
+  // una vuelta
+  uint32_t pasados = tick - planificador->ultimoTick;
+  uint32_t desde = pasados >= PLANIFICADOR_RANURAS ? tick - (PLANIFICADOR_RANURAS - 1) : planificador->ultimoTick;
+  planificador->ultimoTick = tick;
+
+  int8_t vencidas[PLANIFICADOR_MAXIMO_TAREAS];
+  uint8_t cantidad = 0;
+  for (uint32_t t = desde; t != tick + 1; t++) {
+    int8_t* enlace = &planificador->ranuras[t & (PLANIFICADOR_RANURAS - 1)];
+    while (*enlace != TAREA_INVALIDA) {
+      Tarea& tarea = planificador->tareas[*enlace];
+      if (diferencia(tarea.proxima, ahora) > 0) {
+        enlace = &tarea.siguiente;
+        continue;
+      }
+      vencidas[cantidad++] = *enlace;
+      *enlace = tarea.siguiente;
+      tarea.activa = false;
+      tarea.tocada = false;
+    }
+  }
+
+  // Por hora programada: la más atrasada primero
+  for (uint8_t i = 1; i < cantidad; i++) {
+    int8_t tarea = vencidas[i];
+    uint8_t j = i;
+    for (; j > 0 && diferencia(planificador->tareas[vencidas[j - 1]].proxima, planificador->tareas[tarea].proxima) > 0;
+         j--) {
+      vencidas[j] = vencidas[j - 1];
+    }
+    vencidas[j] = tarea;
+  }
+
+  for (uint8_t i = 0; i < cantidad; i++) {
+    // Una tarea anterior pudo haberla reprogramado o detenido
+    if (planificador->tareas[vencidas[i]].tocada) continue;
+    ejecutar(planificador, vencidas[i]);
+  }
+
+  // Hasta la próxima
+  ahora = planificador->reloj();
+  uint32_t espera = PLANIFICADOR_ESPERA_MAXIMA_MS;
+  for (uint8_t i = 0; i < planificador->cantidad; i++) {
+    const Tarea& t = planificador->tareas[i];
+    if (!t.activa) continue;
+    int32_t falta = diferencia(t.proxima, ahora);
+    if (falta <= 0) return 0;
+    if ((uint32_t)falta < espera) espera = falta;
+  }
+  return espera;
+}
+
+size_t describirTarea(const Tarea& tarea, char* destino, size_t largo) {
+  const EstadisticasTarea& e = tarea.estadisticas;
+  uint32_t ejecuciones = e.ejecuciones > 0 ? e.ejecuciones : 1;
+  int escrito = snprintf(destino, largo,
+                         "{\"name\":\"%s\",\"period_ms\":%lu,\"budget_ms\":%lu,\"runs\":%lu,"
+                         "\"late_last_ms\":%lu,\"late_max_ms\":%lu,\"late_mean_ms\":%.2f,"
+                         "\"run_max_ms\":%lu,\"run_mean_ms\":%.2f,\"over_budget\":%lu}",
+                         tarea.nombre, (unsigned long)tarea.periodoMs, (unsigned long)tarea.presupuestoMs,
+                         (unsigned long)e.ejecuciones, (unsigned long)e.atrasoUltimoMs,
+                         (unsigned long)e.atrasoMaximoMs, (double)e.atrasoTotalMs / ejecuciones,
+                         (unsigned long)e.duracionMaximaMs, (double)e.duracionTotalMs / ejecuciones,
+                         (unsigned long)e.excesos);
+  if (escrito < 0) return 0;
+  return (size_t)escrito < largo ? escrito : largo - 1;
+}
@@ -0,0 +1,76 @@
+#include "procesamiento.h"
+
+#include <string.h>
+
+// Los bits de Lectura::rechazadas valen tal cual para el historial y los resúmenes
+static_assert(CAMPOS_HISTORIAL[0] == CAMPO_PH && CAMPOS_HISTORIAL[1] == CAMPO_TEMPERATURA &&
+                  CAMPOS_HISTORIAL[2] == CAMPO_TDS, "CAMPOS_HISTORIAL en el orden de RECHAZADO_*");
+static_assert(CAMPOS_RESUMEN[0] == CAMPO_PH && CAMPOS_RESUMEN[1] == CAMPO_TEMPERATURA && CAMPOS_RESUMEN[2] == CAMPO_TDS,
+              "CAMPOS_RESUMEN en el orden de RECHAZADO_*");
+static_assert(RECHAZADO_PH == 1 << 0 && RECHAZADO_TEMPERATURA == 1 << 1 && RECHAZADO_TDS == 1 << 2,
+              "RECHAZADO_* en el orden de los campos");
+
+void iniciarProcesamiento(Procesamiento* procesamiento, uint32_t ventanaCorta, uint32_t ventanaLarga) {
+  iniciarHistorial(&procesamiento->historial);
+  iniciarResumen(&procesamiento->resumenes[0], ventanaCorta);
+  iniciarResumen(&procesamiento->resumenes[1], ventanaLarga);
+  iniciarDetector(&procesamiento->detector);
+  procesamiento->cantidadEnLote = 0;
+}
+
+void procesarLectura(Procesamiento* procesamiento, const Lectura& lectura, uint32_t timestamp, uint32_t ms,
+                     const char* idDispositivo, ResultadoLectura* resultado) {
+  Medicion& medicion = procesamiento->ultimaMedicion;
+  fijarNumero(&medicion, CAMPO_PH, lectura.ph);
+  fijarNumero(&medicion, CAMPO_TEMPERATURA, lectura.temperatura);
+  fijarNumero(&medicion, CAMPO_TDS, lectura.tds);
+  medicion.textos[CAMPO_TENDENCIA] = lectura.tendencia;
+  fijarNumero(&medicion, CAMPO_VALOR_TENDENCIA, lectura.valorTendencia);
+  fijarNumero(&medicion, CAMPO_TIMESTAMP, timestamp);
+  medicion.textos[CAMPO_ID_DISPOSITIVO] = idDispositivo;
+
+  // Los campos rechazados llevan el valor anterior: no cuentan para los promedios
+  registrarHistorial(&procesamiento->historial, medicion, lectura.rechazadas);
+
+  resultado->resumenesCerrados = 0;
+  for (Resumen& resumen : procesamiento->resumenes) {
+    if (resumen.segundos > 0 &&
+        agregarAResumen(&resumen, medicion, lectura.rechazadas, &resultado->cerrados[resultado->resumenesCerrados])) {
+      resultado->resumenesCerrados++;
+    }
+  }
+
+  // Lo que dio el sensor: en una rechazada, el valor que se descartó
+  const float valores[CANTIDAD_METRICAS] = {lectura.phCrudo, lectura.temperaturaCruda, lectura.tdsCrudo};
+  resultado->anomalias = evaluarMuestra(&procesamiento->detector, valores, lectura.rechazadas, ms, resultado->nuevas);
+}
+
+void agregarAlLote(Procesamiento* procesamiento, const Medicion& medicion) {
+  if (procesamiento->cantidadEnLote == LOTE_MAXIMO) {
+    memmove(procesamiento->lote, procesamiento->lote + 1, (LOTE_MAXIMO - 1) * sizeof(Medicion));
+    procesamiento->cantidadEnLote--;
+  }
+  procesamiento->lote[procesamiento->cantidadEnLote++] = medicion;
+}
+
+void corregirTimestampsLote(Procesamiento* procesamiento, int64_t desfase, int64_t horaValida) {
+  for (uint8_t i = 0; i < procesamiento->cantidadEnLote; i++) {
+    int64_t& timestamp = procesamiento->lote[i].numeros[CAMPO_TIMESTAMP];
+    if (timestamp <= horaValida) timestamp += desfase;
+  }
+}
+
+size_t codificarLoteJson(const Procesamiento& procesamiento, char* destino) {
+  // Telegraf toma cada objeto del arreglo como una medición
+  if (procesamiento.cantidadEnLote == 1) return codificarJson(procesamiento.lote[0], destino);
+
+  size_t largo = 0;
+  destino[largo++] = '[';
+  for (uint8_t i = 0; i < procesamiento.cantidadEnLote; i++) {
+    if (i > 0) destino[largo++] = ',';
+    largo += codificarJson(procesamiento.lote[i], destino + largo);
+  }
+  destino[largo++] = ']';
+  destino[largo] = '\0';
+  return largo;
+}
@@ -0,0 +1,95 @@
+#include "prometheus.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* const NOMBRES_TIPOS[] = {"gauge", "counter"};
+
+// Bloque que se va llenando y sale entero por el escritor
+struct SalidaPrometheus {
+  char bloque[PROMETHEUS_LARGO_BLOQUE];
+  size_t largo;
+  size_t total;
+  EscritorPrometheus escribir;
+  void* contexto;
+};
+
+static void vaciar(SalidaPrometheus* salida) {
+  if (salida->largo == 0) return;
+  salida->escribir(salida->contexto, salida->bloque, salida->largo);
+  salida->total += salida->largo;
+  salida->largo = 0;
+}
+
+static void agregar(SalidaPrometheus* salida, const char* texto, size_t largo) {
+  if (salida->largo + largo > sizeof(salida->bloque)) vaciar(salida);
+  memcpy(salida->bloque + salida->largo, texto, largo);
+  salida->largo += largo;
+}
+
+// Agrega lo que dejó snprintf(); si no entró entera, nada (una línea
+// cortada rompería el formato)
+static void agregarLinea(SalidaPrometheus* salida, const char* linea, int escrito) {
+  if (escrito > 0 && escrito < PROMETHEUS_LARGO_LINEA) agregar(salida, linea, escrito);
+}
+
+// Los enteros van enteros (contadores grandes, bytes); el resto con la
+// precisión de un float, que es de donde vienen las lecturas
+static int escribirValor(char* destino, size_t largo, double valor) {
+  if (isnan(valor)) return snprintf(destino, largo, "NaN");
+  if (isinf(valor)) return snprintf(destino, largo, valor > 0 ? "+Inf" : "-Inf");
+  if (valor == floor(valor) && fabs(valor) < 1e15) return snprintf(destino, largo, "%.0f", valor);
+  return snprintf(destino, largo, "%.7g", valor);
+}
+
+void iniciarTablaPrometheus(TablaPrometheus* tabla) {
+  tabla->cantidad = 0;
+}
+
+bool agregarMetrica(TablaPrometheus* tabla, const char* nombre, const char* ayuda, TipoPrometheus tipo,
+                    LectorPrometheus leer, const void* contexto) {
+  return agregarMetricaPorSerie(tabla, nombre, ayuda, tipo, leer, contexto, nullptr, nullptr, 1);
+}
+
+bool agregarMetricaPorSerie(TablaPrometheus* tabla, const char* nombre, const char* ayuda, TipoPrometheus tipo,
+                            LectorPrometheus leer, const void* contexto, const char* etiqueta,
+                            EtiquetaPrometheus valorEtiqueta, uint8_t series) {
+  if (tabla->cantidad >= PROMETHEUS_MAXIMO_METRICAS) return false;
+  tabla->metricas[tabla->cantidad++] = {nombre, ayuda, tipo, leer, contexto, etiqueta, valorEtiqueta, series};
+  return true;
+}
+
+size_t escribirPrometheus(const TablaPrometheus& tabla, EscritorPrometheus escribir, void* contexto) {
+  SalidaPrometheus salida;
+  salida.largo = 0;
+  salida.total = 0;
+  salida.escribir = escribir;
+  salida.contexto = contexto;
+
+  char linea[PROMETHEUS_LARGO_LINEA];
+  for (uint8_t i = 0; i < tabla.cantidad; i++) {
+    const MetricaPrometheus& m = tabla.metricas[i];
+    agregarLinea(&salida, linea, snprintf(linea, sizeof(linea), "# HELP %s %s\n", m.nombre, m.ayuda));
+    agregarLinea(&salida, linea, snprintf(linea, sizeof(linea), "# TYPE %s %s\n", m.nombre, NOMBRES_TIPOS[m.tipo]));
+
+    for (uint8_t s = 0; s < m.series; s++) {
+      int escrito = m.etiqueta == nullptr
+                        ? snprintf(linea, sizeof(linea), "%s ", m.nombre)
+                        : snprintf(linea, sizeof(linea), "%s{%s=\"%s\"} ", m.nombre, m.etiqueta,
+                                   m.valorEtiqueta(m.contexto, s));
+      if (escrito < 0 || (size_t)escrito >= sizeof(linea) - 2) continue;
+
+      // Lugar para el '\n': si el valor no entra entero, la serie no sale
+      size_t capacidad = sizeof(linea) - escrito - 1;
+      int valor = escribirValor(linea + escrito, capacidad, m.leer(m.contexto, s));
+      if (valor < 0 || (size_t)valor >= capacidad) continue;
+      escrito += valor;
+      linea[escrito++] = '\n';
+      agregar(&salida, linea, escrito);
+    }
+  }
+
+  vaciar(&salida);
+  return salida.total;
+}
@@ -0,0 +1,80 @@
+#include "protocolo_lineas.h"
+
+// Copia 'texto' escapando los caracteres que pide 'escapar'
+static size_t copiarEscapado(const char* texto, const char* escapar, char* destino, size_t capacidad) {
+  size_t largo = 0;
+  for (; *texto != '\0'; texto++) {
+    bool conBarra = strchr(escapar, *texto) != nullptr;
+    if (largo + (conBarra ? 2 : 1) > capacidad) return SIZE_MAX;
+    if (conBarra) destino[largo++] = '\\';
+    destino[largo++] = *texto;
+  }
+  return largo;
+}
+
+size_t armarPrefijoLinea(const char* medicion, const char* host, const char* topico, char* destino,
+                         size_t capacidad) {
+  size_t largo = copiarEscapado(medicion, ", ", destino, capacidad);
+  const char* nombres[2] = {",host=", ",topic="};
+  const char* valores[2] = {host, topico};
+
+  for (size_t i = 0; i < 2 && largo != SIZE_MAX; i++) {
+    size_t largoNombre = strlen(nombres[i]);
+    if (largo + largoNombre > capacidad) return 0;
+    memcpy(destino + largo, nombres[i], largoNombre);
+    largo += largoNombre;
+
+    size_t largoValor = copiarEscapado(valores[i], ", =", destino + largo, capacidad - largo);
+    largo = largoValor == SIZE_MAX ? SIZE_MAX : largo + largoValor;
+  }
+  if (largo == SIZE_MAX || largo + 1 > capacidad) return 0;
+  destino[largo++] = ' ';
+  return largo;
+}
+
+// Un campo por plantilla, como los codificadores de esquema.h. El
+// timestamp no es un campo: va al final de la línea.
+template <size_t I>
+static size_t escribirCampoLinea(const Medicion& medicion, char* destino) {
+  constexpr const Campo& campo = CAMPOS_MEDICION[I];
+  constexpr size_t largoNombre = largoTexto(campo.nombre);
+  if constexpr (I == CAMPO_TIMESTAMP) return 0;
+
+  size_t largo = 0;
+  if (I > 0) destino[largo++] = ',';
+  memcpy(destino + largo, campo.nombre, largoNombre);
+  largo += largoNombre;
+  destino[largo++] = '=';
+
+  if constexpr (campo.tipo == CAMPO_TEXTO) {
+    // Los textos del esquema no tienen comillas ni barras
+    const char* texto = medicion.textos[I] != nullptr ? medicion.textos[I] : "";
+    size_t largoValor = strnlen(texto, campo.largoMaximo);
+    destino[largo++] = '"';
+    memcpy(destino + largo, texto, largoValor);
+    largo += largoValor;
+    destino[largo++] = '"';
+  } else {
+    largo += esquema_detalle::escribirFijo<campo.decimales>(destino + largo, medicion.numeros[I]);
+  }
+  return largo;
+}
+
+template <size_t... I>
+static size_t escribirCamposLinea(const Medicion& medicion, char* destino, std::index_sequence<I...>) {
+  size_t largo = 0;
+  ((largo += escribirCampoLinea<I>(medicion, destino + largo)), ...);
+  return largo;
+}
+
+size_t escribirLinea(const Medicion& medicion, const char* prefijo, size_t largoPrefijo, char* destino) {
+  static_assert(CAMPO_TIMESTAMP > 0, "el primer campo no puede ser el timestamp");
+
+  memcpy(destino, prefijo, largoPrefijo);
+  size_t largo = largoPrefijo;
+  largo += escribirCamposLinea(medicion, destino + largo, std::make_index_sequence<CANTIDAD_CAMPOS>());
+  destino[largo++] = ' ';
+  largo += esquema_detalle::escribirFijo<0>(destino + largo, medicion.numeros[CAMPO_TIMESTAMP]);
+  destino[largo++] = '\n';
+  return largo;
+}
@@ -0,0 +1,63 @@
+#include "registro.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static_assert((REGISTRO_RANURAS & (REGISTRO_RANURAS - 1)) == 0, "REGISTRO_RANURAS tiene que ser potencia de 2");
+static_assert(REGISTRO_LARGO_MENSAJE <= UINT8_MAX, "El largo del mensaje va en un byte");
+
+void reiniciarColaRegistro(ColaRegistro* cola) {
+  for (std::atomic<bool>& lista : cola->listas) lista.store(false);
+  cola->reservadas.store(0);
+  cola->leidas.store(0);
+  cola->descartados.store(0);
+  cola->cortados.store(0);
+}
+
+bool encolarRegistro(ColaRegistro* cola, uint8_t nivel, uint32_t ms, const char* formato, va_list argumentos) {
+  uint32_t posicion = cola->reservadas.load(std::memory_order_relaxed);
+  do {
+    if (posicion - cola->leidas.load(std::memory_order_acquire) >= REGISTRO_RANURAS) {
+      cola->descartados.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  } while (!cola->reservadas.compare_exchange_weak(posicion, posicion + 1, std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed));
+
+  uint32_t indice = posicion & (REGISTRO_RANURAS - 1);
+  MensajeRegistro& mensaje = cola->ranuras[indice];
+  mensaje.ms = ms;
+  mensaje.nivel = nivel;
+  int largo = vsnprintf(mensaje.texto, sizeof(mensaje.texto), formato, argumentos);
+  if (largo < 0) largo = 0;
+  if ((size_t)largo >= sizeof(mensaje.texto)) {
+    largo = sizeof(mensaje.texto) - 1;
+    cola->cortados.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Los mensajes vienen de println(): el fin de línea lo pone formatearRegistro()
+  while (largo > 0 && (mensaje.texto[largo - 1] == '\n' || mensaje.texto[largo - 1] == '\r')) largo--;
+  mensaje.largo = largo;
+
+  cola->listas[indice].store(true, std::memory_order_release);
+  return true;
+}
+
+bool desencolarRegistro(ColaRegistro* cola, MensajeRegistro* mensaje) {
+  uint32_t leidas = cola->leidas.load(std::memory_order_relaxed);
+  uint32_t indice = leidas & (REGISTRO_RANURAS - 1);
+  if (!cola->listas[indice].load(std::memory_order_acquire)) return false;
+
+  *mensaje = cola->ranuras[indice];
+  cola->listas[indice].store(false, std::memory_order_relaxed);
+  cola->leidas.store(leidas + 1, std::memory_order_release);
+  return true;
+}
+
+size_t formatearRegistro(const MensajeRegistro& mensaje, char* destino, size_t largo) {
+  static const char LETRAS[] = "-EAID";
+  char letra = mensaje.nivel <= REGISTRO_DEPURACION ? LETRAS[mensaje.nivel] : '?';
+  int escrito = snprintf(destino, largo, "%lu %c %.*s\n", (unsigned long)mensaje.ms, letra, (int)mensaje.largo,
+                         mensaje.texto);
+  if (escrito < 0) return 0;
+  return (size_t)escrito < largo ? escrito : largo - 1;
+}
@@ -0,0 +1,157 @@
+#include "registro_uart.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#if REGISTRO_FLASH
+#include <LittleFS.h>
+#endif
+
+// En cero ya es una cola vacía: se puede registrar desde antes de setup()
+static ColaRegistro cola;
+static std::atomic<uint32_t> escritos{0};
+static std::atomic<uint32_t> guardados{0};
+
+#if REGISTRO_FLASH
+// Lo que tiene cada mensaje en flash antes del texto
+struct __attribute__((packed)) EncabezadoRegistro {
+  uint32_t ms;
+  uint8_t nivel;
+  uint8_t largo;
+};
+
+static bool flashLista = false;
+static uint32_t tamanoArchivo = 0;
+
+static void guardarEnFlash(const MensajeRegistro& mensaje) {
+  if (!flashLista || mensaje.nivel > REGISTRO_NIVEL_FLASH) return;
+
+  if (tamanoArchivo + sizeof(EncabezadoRegistro) + mensaje.largo > REGISTRO_FLASH_MAX_BYTES) {
+    LittleFS.remove(REGISTRO_ARCHIVO_ANTERIOR);
+    LittleFS.rename(REGISTRO_ARCHIVO, REGISTRO_ARCHIVO_ANTERIOR);
+    tamanoArchivo = 0;
+  }
+
+  File archivo = LittleFS.open(REGISTRO_ARCHIVO, FILE_APPEND);
+  if (!archivo) return;
+  EncabezadoRegistro encabezado = {mensaje.ms, mensaje.nivel, mensaje.largo};
+  tamanoArchivo += archivo.write((const uint8_t*)&encabezado, sizeof(encabezado));
+  tamanoArchivo += archivo.write((const uint8_t*)mensaje.texto, mensaje.largo);
+  archivo.close();
+  guardados.fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+// Solo una tarea a la vez saca mensajes o toca los archivos: la del
+// registro, o la que llama a vaciarRegistro() o lee la flash
+static SemaphoreHandle_t candado = nullptr;
+
+static void sacarPendientes() {
+  MensajeRegistro mensaje;
+  char linea[REGISTRO_LARGO_LINEA];
+  while (desencolarRegistro(&cola, &mensaje)) {
+    size_t largo = formatearRegistro(mensaje, linea, sizeof(linea));
+    Serial.write((const uint8_t*)linea, largo);
+    escritos.fetch_add(1, std::memory_order_relaxed);
+#if REGISTRO_FLASH
+    guardarEnFlash(mensaje);
+#endif
+  }
+}
+
+static void tareaRegistro(void*) {
+  for (;;) {
+    xSemaphoreTake(candado, portMAX_DELAY);
+    sacarPendientes();
+    xSemaphoreGive(candado);
+    vTaskDelay(pdMS_TO_TICKS(REGISTRO_PERIODO_MS));
+  }
+}
+
+void registrar(uint8_t nivel, const char* formato, ...) {
+  va_list argumentos;
+  va_start(argumentos, formato);
+  encolarRegistro(&cola, nivel, millis(), formato, argumentos);
+  va_end(argumentos);
+}
+
+void iniciarRegistro() {
+  if (candado != nullptr) return;
+  candado = xSemaphoreCreateMutex();
+#if REGISTRO_FLASH
+  flashLista = LittleFS.begin(true);
+  if (flashLista) {
+    File archivo = LittleFS.open(REGISTRO_ARCHIVO, FILE_READ);
+    if (archivo) {
+      tamanoArchivo = archivo.size();
+      archivo.close();
+    }
+  }
+#endif
+  xTaskCreatePinnedToCore(tareaRegistro, "registro", REGISTRO_PILA_TAREA, nullptr, REGISTRO_PRIORIDAD_TAREA, nullptr,
+                          tskNO_AFFINITY);
+}
+
+void vaciarRegistro() {
+  if (candado != nullptr) xSemaphoreTake(candado, portMAX_DELAY);
+  sacarPendientes();
+  Serial.flush();
+  if (candado != nullptr) xSemaphoreGive(candado);
+}
+
+size_t describirRegistro(char* destino, size_t largo) {
+  int escrito = snprintf(destino, largo,
+                         "{\"level\":%d,\"written\":%lu,\"dropped\":%lu,\"truncated\":%lu,\"pending\":%lu,"
+                         "\"flash\":%s,\"flash_saved\":%lu}",
+                         NIVEL_REGISTRO, (unsigned long)escritos.load(), (unsigned long)cola.descartados.load(),
+                         (unsigned long)cola.cortados.load(),
+                         (unsigned long)(cola.reservadas.load() - cola.leidas.load()),
+                         REGISTRO_FLASH ? "true" : "false", (unsigned long)guardados.load());
+  if (escrito < 0) return 0;
+  return std::min((size_t)escrito, largo - 1);
+}
+
+#if REGISTRO_FLASH
+static void leerArchivo(const char* nombre, EscritorRegistro escribir, void* contexto) {
+  File archivo = LittleFS.open(nombre, FILE_READ);
+  if (!archivo) return;
+
+  EncabezadoRegistro encabezado;
+  MensajeRegistro mensaje;
+  char linea[REGISTRO_LARGO_LINEA];
+  while (archivo.read((uint8_t*)&encabezado, sizeof(encabezado)) == sizeof(encabezado)) {
+    // Un mensaje cortado (se cortó la alimentación mientras se escribía) termina el archivo
+    if (encabezado.largo > sizeof(mensaje.texto)) break;
+    if (archivo.read((uint8_t*)mensaje.texto, encabezado.largo) != encabezado.largo) break;
+    mensaje.ms = encabezado.ms;
+    mensaje.nivel = encabezado.nivel;
+    mensaje.largo = encabezado.largo;
+    escribir(contexto, linea, formatearRegistro(mensaje, linea, sizeof(linea)));
+  }
+  archivo.close();
+}
+#endif
+
+void leerRegistroFlash(EscritorRegistro escribir, void* contexto) {
+#if REGISTRO_FLASH
+  // Sin que rote el archivo mientras se lee
+  if (candado == nullptr) return;
+  xSemaphoreTake(candado, portMAX_DELAY);
+  leerArchivo(REGISTRO_ARCHIVO_ANTERIOR, escribir, contexto);
+  leerArchivo(REGISTRO_ARCHIVO, escribir, contexto);
+  xSemaphoreGive(candado);
+#endif
+}
+
+void borrarRegistroFlash() {
+#if REGISTRO_FLASH
+  if (candado == nullptr) return;
+  xSemaphoreTake(candado, portMAX_DELAY);
+  LittleFS.remove(REGISTRO_ARCHIVO_ANTERIOR);
+  LittleFS.remove(REGISTRO_ARCHIVO);
+  tamanoArchivo = 0;
+  xSemaphoreGive(candado);
+#endif
+}
@@ -0,0 +1,622 @@
+// Replay nativo de trazas de sensores (ver include/traza.h).
+//
+// Pasa cada lectura grabada por las mismas funciones de procesamiento que usa
+// el firmware (sensores.cpp), sin esperar entre muestras, y compara lo que da
+// ahora contra lo que había dado el equipo cuando se grabó. Sirve para probar
+// cambios de filtros o umbrales sin volver a flashear ni esperar al agua.
+//
+//   pio run -e native_replay
+//   .pio/build/native_replay/program traza.txt [--salida replay.csv] [--repeticiones N]
+//   .pio/build/native_replay/program --bench-ezo [MB]
+//   .pio/build/native_replay/program --bench-anomalias [días]
+//   .pio/build/native_replay/program --memoria [horas]
+//
+// --bench-ezo mide el lector de respuestas del EZO (ezo.cpp) con un flujo
+// sintético que mezcla valores, códigos de estado, bytes de ruido y líneas
+// demasiado largas.
+//
+// --bench-anomalias pasa días sintéticos de lecturas cada 5 s, con ruido,
+// la variación diaria de la temperatura y anomalías metidas a propósito,
+// por el detector (anomalias.cpp): cuántas detecta, cuántos falsos
+// positivos da y cuánto tarda por muestra. Sale con código 5 si se le
+// escapó algún evento.
+//
+// --memoria corre horas simuladas del camino de cada lectura del firmware
+// (EZO, filtros, muestreo, registro y procesamiento.cpp: historial,
+// resúmenes, anomalías, lote y su JSON) con el mismo planificador, y
+// cuenta los pedidos al heap de setup y de cada tarea, como
+// MEMORIA_ESTATICA en el equipo (ver include/memoria.h). Sale con código 4
+// si alguna tarea pidió memoria.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "anomalias.h"
+#include "esquema.h"
+#include "ezo.h"
+#include "historial.h"
+#include "muestreo.h"
+#include "planificador.h"
+#include "procesamiento.h"
+#include "registro.h"
+#include "resumen.h"
+#include "sensores.h"
+#include "traza.h"
+
+// Pedidos al heap para --memoria, a nombre de la tarea del planificador que
+// está corriendo. Con glibc se reemplazan malloc() y compañía (new termina
+// ahí) y se llega a la implementación real por __libc_*; en otras
+// plataformas solo se cuenta new.
+struct ConteoHeap {
+  unsigned long cantidad;
+  unsigned long bytes;
+};
+
+static const Planificador* planificadorHeap = nullptr;  // nullptr: no se cuenta
+static bool heapEnSetup = false;
+static ConteoHeap heapSetup, heapFueraDeTareas, heapTareas[PLANIFICADOR_MAXIMO_TAREAS];
+
+static void anotarHeap(size_t bytes) {
+  if (planificadorHeap == nullptr) return;
+  int tarea = planificadorHeap->ejecutando;
+  ConteoHeap& c = heapEnSetup ? heapSetup : tarea == TAREA_INVALIDA ? heapFueraDeTareas : heapTareas[tarea];
+  c.cantidad++;
+  c.bytes += bytes;
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t bytes);
+void* __libc_calloc(size_t cantidad, size_t bytes);
+void* __libc_realloc(void* anterior, size_t bytes);
+void __libc_free(void* bloque);
+
+void* malloc(size_t bytes) noexcept {
+  anotarHeap(bytes);
+  return __libc_malloc(bytes);
+}
+
+void* calloc(size_t cantidad, size_t bytes) noexcept {
+  anotarHeap(cantidad * bytes);
+  return __libc_calloc(cantidad, bytes);
+}
+
+void* realloc(void* anterior, size_t bytes) noexcept {
+  anotarHeap(bytes);
+  return __libc_realloc(anterior, bytes);
+}
+
+void free(void* bloque) noexcept {
+  __libc_free(bloque);
+}
+}
+#else
+void* operator new(size_t bytes) {
+  anotarHeap(bytes);
+  void* bloque = std::malloc(bytes);
+  if (bloque == nullptr) throw std::bad_alloc();
+  return bloque;
+}
+
+void operator delete(void* bloque) noexcept {
+  std::free(bloque);
+}
+#endif
+
+struct Estadistica {
+  const char* nombre;
+  unsigned long muestras = 0;
+  unsigned long descartadas = 0;
+  unsigned long conDiferencia = 0;
+  double sumaDelta = 0;
+  double maxDelta = 0;
+  std::vector<double> tiemposNs;
+};
+
+static bool cargarTraza(const char* ruta, std::vector<RegistroTraza>* registros) {
+  FILE* archivo = fopen(ruta, "r");
+  if (archivo == nullptr) return false;
+
+  char linea[256];
+  RegistroTraza registro;
+  while (fgets(linea, sizeof(linea), archivo) != nullptr) {
+    if (leerRegistroTraza(linea, &registro)) registros->push_back(registro);
+  }
+  fclose(archivo);
+  return true;
+}
+
+static double percentil(std::vector<double> valores, double p) {
+  if (valores.empty()) return 0;
+  size_t indice = (size_t)(p * (valores.size() - 1));
+  std::nth_element(valores.begin(), valores.begin() + indice, valores.end());
+  return valores[indice];
+}
+
+static void imprimir(const Estadistica& e) {
+  if (e.muestras == 0) return;
+
+  double sumaNs = 0;
+  for (double t : e.tiemposNs) sumaNs += t;
+
+  printf("%-12s %7lu muestras, %5lu descartadas, %5lu distintas | delta max %.3f prom %.4f"
+         " | ns/muestra prom %.0f p50 %.0f p99 %.0f max %.0f\n",
+         e.nombre, e.muestras, e.descartadas, e.conDiferencia, e.maxDelta,
+         e.sumaDelta / e.muestras, sumaNs / e.tiemposNs.size(),
+         percentil(e.tiemposNs, 0.50), percentil(e.tiemposNs, 0.99),
+         *std::max_element(e.tiemposNs.begin(), e.tiemposNs.end()));
+}
+
+// Genera un flujo de respuestas del EZO con ~30% de líneas problemáticas.
+// Usa un generador propio para que el flujo sea siempre el mismo.
+static std::vector<uint8_t> generarFlujoEzo(size_t bytes) {
+  static const char* const LINEAS[] = {
+    "7.012", "6.998", "14.000", "0.001", "*OK", "25.1,7.02", "7.0", "*ER", "*OV", "*RS",
+  };
+  std::vector<uint8_t> flujo;
+  flujo.reserve(bytes + 64);
+  uint32_t semilla = 12345;
+
+  while (flujo.size() < bytes) {
+    semilla = semilla * 1103515245 + 12345;
+    uint32_t azar = semilla >> 16;
+
+    if (azar % 10 < 7) {
+      const char* linea = LINEAS[(azar / 10) % (sizeof(LINEAS) / sizeof(LINEAS[0]))];
+      flujo.insert(flujo.end(), linea, linea + strlen(linea));
+    } else if (azar % 10 == 7) {
+      // Ruido eléctrico: bytes cualquiera en medio de un valor
+      flujo.push_back('7');
+      for (int i = 0; i < 4; i++) flujo.push_back((uint8_t)(azar >> (i * 3)));
+    } else if (azar % 10 == 8) {
+      // Línea larga sin terminar a tiempo
+      for (int i = 0; i < 48; i++) flujo.push_back('0' + i % 10);
+    } else {
+      // Número mal formado
+      const char* linea = "7..01a";
+      flujo.insert(flujo.end(), linea, linea + strlen(linea));
+    }
+    flujo.push_back('\r');
+  }
+  return flujo;
+}
+
+static int medirLectorEzo(int megabytes) {
+  std::vector<uint8_t> flujo = generarFlujoEzo(1024 * 1024);
+  unsigned long cantidades[EZO_DESBORDE + 1] = {};
+  int64_t suma = 0;
+
+  LectorEzo lector;
+  reiniciarLectorEzo(&lector);
+
+  auto inicio = std::chrono::steady_clock::now();
+  for (int r = 0; r < megabytes; r++) {
+    for (uint8_t byte : flujo) {
+      TipoRespuestaEzo tipo = agregarByteEzo(&lector, byte);
+      cantidades[tipo]++;
+      if (tipo == EZO_VALOR) suma += lector.valor;
+    }
+  }
+  double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+  unsigned long lineas = 0;
+  for (int t = EZO_VALOR; t <= EZO_DESBORDE; t++) lineas += cantidades[t];
+
+  printf("Lector EZO: %d MB en %.3f s -> %.1f MB/s, %.2f M líneas/s (%.1f ns/byte)\n",
+         megabytes, segundos, megabytes / segundos, lineas / segundos / 1e6,
+         segundos * 1e9 / ((double)flujo.size() * megabytes));
+  printf("  valores %lu, *OK %lu, *ER %lu, *OV %lu, *RS %lu, malformadas %lu, desbordes %lu"
+         " (suma de control %lld)\n",
+         cantidades[EZO_VALOR], cantidades[EZO_OK], cantidades[EZO_ER], cantidades[EZO_OV],
+         cantidades[EZO_RS], cantidades[EZO_MALFORMADA], cantidades[EZO_DESBORDE], (long long)suma);
+  return 0;
+}
+
+// Generador propio (el mismo en todas las plataformas) y ruido normal con Box-Muller
+static uint32_t semillaAnomalias = 4321;
+
+static double azarUniforme() {
+  semillaAnomalias = semillaAnomalias * 1103515245 + 12345;
+  return ((semillaAnomalias >> 8) + 0.5) / 16777216.0;
+}
+
+static double azarNormal() {
+  return sqrt(-2 * log(azarUniforme())) * cos(2 * M_PI * azarUniforme());
+}
+
+struct EventoAnomalia {
+  size_t muestra;
+  uint8_t metrica;
+  bool detectado;
+};
+
+static int medirAnomalias(int dias) {
+  const uint32_t intervaloMs = 5000;
+  const size_t muestras = (size_t)dias * 86400000ULL / intervaloMs;
+  const size_t cadaEvento = 6 * 3600 * 1000 / intervaloMs;     // Un evento cada 6 h
+  const size_t duracionEscalon = 30 * 60 * 1000 / intervaloMs;  // Que vuelve a la media hora
+  const double ruido[CANTIDAD_METRICAS] = {0.01, 0.03, 2.0};
+  const double escalon[CANTIDAD_METRICAS] = {0.6, 3.0, 150.0};
+
+  // Cada evento: pico de una muestra, sensor que no responde (marcado o
+  // no), o escalón que vuelve (dos eventos, ida y vuelta)
+  std::vector<EventoAnomalia> eventos;
+  std::vector<int8_t> tipoEvento(muestras, -1);
+  std::vector<uint8_t> metricaEvento(muestras, 0);
+  for (size_t i = cadaEvento; i + duracionEscalon < muestras; i += cadaEvento) {
+    uint8_t metrica = (uint8_t)(azarUniforme() * CANTIDAD_METRICAS);
+    int tipo = (int)(azarUniforme() * 3);
+    tipoEvento[i] = tipo;
+    metricaEvento[i] = metrica;
+    eventos.push_back({i, metrica, false});
+    if (tipo == 2) {
+      tipoEvento[i + duracionEscalon] = 3;
+      metricaEvento[i + duracionEscalon] = metrica;
+      eventos.push_back({i + duracionEscalon, metrica, false});
+    }
+  }
+
+  DetectorAnomalias detector;
+  iniciarDetector(&detector);
+  Anomalia nuevas[CANTIDAD_METRICAS];
+  double desplazamiento[CANTIDAD_METRICAS] = {};
+  unsigned long falsos[CANTIDAD_METRICAS] = {};
+  size_t proximoEvento = 0;
+  double totalNs = 0;
+
+  for (size_t i = 0; i < muestras; i++) {
+    double horas = i * intervaloMs / 3600000.0;
+    float valores[CANTIDAD_METRICAS] = {
+        (float)(7.4 + desplazamiento[METRICA_PH] + ruido[METRICA_PH] * azarNormal()),
+        (float)(26 + 1.5 * sin(2 * M_PI * horas / 24) + desplazamiento[METRICA_TEMPERATURA] +
+                ruido[METRICA_TEMPERATURA] * azarNormal()),
+        (float)(500 + 2 * horas / 24 + desplazamiento[METRICA_TDS] + ruido[METRICA_TDS] * azarNormal()),
+    };
+    uint8_t rechazadas = 0;
+
+    if (tipoEvento[i] == 0) {
+      uint8_t m = metricaEvento[i];
+      valores[m] += 20 * std::max(ruido[m], (double)LIMITES_METRICAS[m].sigmaMinima);
+    } else if (tipoEvento[i] == 1) {
+      // La mitad sin el bit: un NAN que el llamador no marcó tiene que
+      // salir igual como rechazado, sin arruinar la línea de base
+      if ((i / cadaEvento) % 2 == 0) rechazadas = 1u << metricaEvento[i];
+      valores[metricaEvento[i]] = NAN;
+    } else if (tipoEvento[i] == 2) {
+      desplazamiento[metricaEvento[i]] = escalon[metricaEvento[i]];
+      valores[metricaEvento[i]] += escalon[metricaEvento[i]];
+    } else if (tipoEvento[i] == 3) {
+      valores[metricaEvento[i]] -= desplazamiento[metricaEvento[i]];
+      desplazamiento[metricaEvento[i]] = 0;
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    uint8_t cantidad = evaluarMuestra(&detector, valores, rechazadas, (uint32_t)(i * intervaloMs), nuevas);
+    totalNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count();
+
+    // Un episodio cuenta como detección si empieza hasta dos muestras
+    // después de un evento de esa métrica
+    while (proximoEvento < eventos.size() && eventos[proximoEvento].muestra + 2 < i) proximoEvento++;
+    for (uint8_t a = 0; a < cantidad; a++) {
+      bool esperado = false;
+      for (size_t e = proximoEvento; e < eventos.size() && eventos[e].muestra <= i; e++) {
+        if (eventos[e].metrica == nuevas[a].metrica && !eventos[e].detectado) {
+          eventos[e].detectado = true;
+          esperado = true;
+          break;
+        }
+      }
+      if (!esperado) falsos[nuevas[a].metrica]++;
+    }
+  }
+
+  unsigned long detectados = 0;
+  for (const EventoAnomalia& e : eventos) detectados += e.detectado;
+
+  printf("Anomalías: %d días, %zu muestras cada %u s, %zu eventos metidos, %lu detectados (%.1f%%)\n", dias,
+         muestras, intervaloMs / 1000, eventos.size(), detectados,
+         eventos.empty() ? 0.0 : 100.0 * detectados / eventos.size());
+  for (uint8_t m = 0; m < CANTIDAD_METRICAS; m++) {
+    const DetectorMetrica& d = detector.metricas[m];
+    printf("  %-14s falsos positivos %lu (%.2f por día) | episodios %lu, de una muestra %lu, cambios de nivel %lu\n",
+           LIMITES_METRICAS[m].nombre, falsos[m], (double)falsos[m] / dias, (unsigned long)d.episodios,
+           (unsigned long)d.transitorios, (unsigned long)d.cambiosNivel);
+  }
+  printf("  %.0f ns por muestra (las tres métricas)\n", totalNs / muestras);
+  return detectados == eventos.size() ? 0 : 5;
+}
+
+// Lo que en el equipo son miembros de Pileta y estado de los módulos
+struct BancoMemoria {
+  Planificador planificador;
+  int tareaLectura, tareaPublicar;
+  uint32_t reloj;
+
+  LectorEzo lector;
+  ColaEzo colaEzo;
+  ConfiguracionMuestreo muestreo;
+  EstadoMuestreo estadoMuestreo;
+  Procesamiento procesamiento;  // El mismo camino que en Pileta
+  ColaRegistro registro;
+  char payload[TAMANO_LOTE_JSON];
+
+  unsigned long lecturas, publicaciones, bytesPublicados, alertas, resumenesCerrados, mensajes;
+  double nsProcesamiento;
+};
+
+static BancoMemoria banco;
+
+// Como REG_DEPURACION: a la cola y de ahí a una línea, como la tarea del registro
+static void registrarEnBanco(const char* formato, ...) __attribute__((format(printf, 1, 2)));
+static void registrarEnBanco(const char* formato, ...) {
+  va_list argumentos;
+  va_start(argumentos, formato);
+  encolarRegistro(&banco.registro, REGISTRO_DEPURACION, banco.reloj, formato, argumentos);
+  va_end(argumentos);
+
+  MensajeRegistro mensaje;
+  char linea[REGISTRO_LARGO_LINEA];
+  while (desencolarRegistro(&banco.registro, &mensaje)) {
+    formatearRegistro(mensaje, linea, sizeof(linea));
+    banco.mensajes++;
+  }
+}
+
+// Lo que Pileta::publicarLote(), con la hora ya sincronizada y sin la red
+static void publicarBanco(void*) {
+  if (banco.procesamiento.cantidadEnLote == 0) return;
+
+  banco.publicaciones++;
+  banco.bytesPublicados += codificarLoteJson(banco.procesamiento, banco.payload);
+  banco.procesamiento.cantidadEnLote = 0;
+}
+
+static void leerBanco(void*) {
+  // El pH llega byte a byte por la UART y pasa por la cola, como con
+  // EZO_CONTINUO; temperatura y TDS van directo a sus filtros
+  char respuesta[16];
+  snprintf(respuesta, sizeof(respuesta), "%.3f\r", 7.4 + 0.01 * azarNormal());
+  for (const char* c = respuesta; *c != '\0'; c++) {
+    TipoRespuestaEzo tipo = agregarByteEzo(&banco.lector, (uint8_t)*c);
+    if (tipo == EZO_INCOMPLETA) continue;
+    LineaEzo linea;
+    linea.ms = banco.reloj;
+    linea.tipo = tipo;
+    linea.valor = banco.lector.valor;
+    memcpy(linea.linea, banco.lector.linea, sizeof(linea.linea));
+    encolarEzo(&banco.colaEzo, linea);
+  }
+
+  uint8_t rechazadas = 0;
+  LineaEzo linea;
+  while (desencolarEzo(&banco.colaEzo, &linea)) {
+    if (!procesarPhEzo(linea.tipo, linea.valor)) rechazadas |= RECHAZADO_PH;
+  }
+  double horas = banco.reloj / 3600000.0;
+  snprintf(respuesta, sizeof(respuesta), "%.2f", 26 + 1.5 * sin(2 * M_PI * horas / 24) + 0.03 * azarNormal());
+  if (!procesarTemperatura(respuesta)) rechazadas |= RECHAZADO_TEMPERATURA;
+  if (!procesarTds(900 + (int)(5 * azarNormal()))) rechazadas |= RECHAZADO_TDS;
+
+  Lectura lectura = {valorPh, temperaturaAnterior, valorTdsAnterior, TENDENCIA_ESTABLE, 0,
+                     rechazadas, phCrudo, temperaturaCruda, tdsCrudo};
+  banco.lecturas++;
+  cambiarPeriodo(&banco.planificador, banco.tareaLectura,
+                 planificarMuestreo(&banco.estadoMuestreo, banco.muestreo, lectura));
+  registrarEnBanco("Lectura - pH: %.2f, Temp: %.1f C, TDS: %.0f ppm", lectura.ph, lectura.temperatura, lectura.tds);
+
+  // De acá en más, lo que hace Pileta::publishMetrics()
+  const uint32_t timestamp = 1750000000 + banco.reloj / 1000;
+  ResultadoLectura resultado;
+  auto inicio = std::chrono::steady_clock::now();
+  procesarLectura(&banco.procesamiento, lectura, timestamp, banco.reloj, "ESP32_Pileta", &resultado);
+  banco.nsProcesamiento += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count();
+
+  for (uint8_t i = 0; i < resultado.resumenesCerrados; i++) {
+    char json[RESUMEN_LARGO_JSON];
+    codificarResumenJson(resultado.cerrados[i], "ESP32_Pileta", json, sizeof(json));
+    banco.resumenesCerrados++;
+  }
+
+  if (banco.procesamiento.cantidadEnLote == LOTE_MAXIMO) publicarBanco(nullptr);
+  agregarAlLote(&banco.procesamiento, banco.procesamiento.ultimaMedicion);
+  if (banco.procesamiento.cantidadEnLote >= banco.muestreo.lote || banco.estadoMuestreo.acelerado) {
+    programarTarea(&banco.planificador, banco.tareaPublicar, 0);
+  }
+
+  for (uint8_t i = 0; i < resultado.anomalias; i++) {
+    char alerta[ANOMALIA_LARGO_JSON];
+    codificarAlertaJson(resultado.nuevas[i], timestamp, "ESP32_Pileta", alerta, sizeof(alerta));
+    registrarEnBanco("Anomalía: %s", alerta);
+    banco.alertas++;
+  }
+  if (resultado.anomalias > 0) programarTarea(&banco.planificador, banco.tareaPublicar, 0);
+}
+
+static void imprimirConteo(const char* nombre, const ConteoHeap& conteo) {
+  printf("  %-22s %8lu pedidos al heap, %10lu bytes\n", nombre, conteo.cantidad, conteo.bytes);
+}
+
+static int medirMemoria(int horas) {
+  // setup(): todo lo que el firmware inicia una vez
+  planificadorHeap = &banco.planificador;
+  heapEnSetup = true;
+  iniciarPlanificador(&banco.planificador, []() -> uint32_t { return banco.reloj; });
+  banco.tareaLectura = agregarTarea(&banco.planificador, "lectura", leerBanco, nullptr, INTERVALO_ENVIO_MS, 0);
+  banco.tareaPublicar = agregarTarea(&banco.planificador, "publicar", publicarBanco, nullptr, 0, 0);
+  reiniciarSensores();
+  reiniciarLectorEzo(&banco.lector);
+  reiniciarColaEzo(&banco.colaEzo);
+  banco.muestreo = configuracionMuestreoInicial();
+  banco.muestreo.lote = LOTE_MAXIMO;
+  iniciarMuestreo(&banco.estadoMuestreo, banco.muestreo);
+  iniciarProcesamiento(&banco.procesamiento, 60, 900);
+  reiniciarColaRegistro(&banco.registro);
+  programarTarea(&banco.planificador, banco.tareaLectura, 0);
+  heapEnSetup = false;
+
+  // loop(): el reloj salta a la próxima tarea
+  const uint32_t hasta = (uint32_t)horas * 3600000u;
+  auto inicio = std::chrono::steady_clock::now();
+  while (banco.reloj < hasta) {
+    uint32_t espera = ejecutarPendientes(&banco.planificador);
+    banco.reloj += espera > 0 ? espera : 1;
+  }
+  double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+  planificadorHeap = nullptr;
+
+  printf("Memoria: %d h simuladas en %.2f s, %lu lecturas, %lu lotes (%lu bytes de JSON), %lu resúmenes, "
+         "%lu alertas, %lu mensajes de registro\n",
+         horas, segundos, banco.lecturas, banco.publicaciones, banco.bytesPublicados, banco.resumenesCerrados,
+         banco.alertas, banco.mensajes);
+  printf("  Estado fijo: %zu bytes (historial %zu, detector %zu, registro %zu)\n", sizeof(banco),
+         sizeof(banco.procesamiento.historial), sizeof(banco.procesamiento.detector), sizeof(banco.registro));
+  printf("  procesarLectura(): %.0f ns por lectura\n", banco.lecturas > 0 ? banco.nsProcesamiento / banco.lecturas : 0.0);
+#if !defined(__GLIBC__)
+  printf("  (sin glibc solo se cuenta new, no malloc())\n");
+#endif
+  imprimirConteo("setup", heapSetup);
+  imprimirConteo("loop, fuera de tareas", heapFueraDeTareas);
+  unsigned long despues = heapFueraDeTareas.cantidad;
+  for (uint8_t i = 0; i < banco.planificador.cantidad; i++) {
+    imprimirConteo(banco.planificador.tareas[i].nombre, heapTareas[i]);
+    despues += heapTareas[i].cantidad;
+  }
+  printf("  Después de setup: %lu pedidos al heap\n", despues);
+  return despues == 0 ? 0 : 4;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--bench-ezo") == 0) {
+    return medirLectorEzo(argc > 2 ? std::max(1, atoi(argv[2])) : 16);
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench-anomalias") == 0) {
+    return medirAnomalias(argc > 2 ? std::max(1, atoi(argv[2])) : 30);
+  }
+  if (argc > 1 && strcmp(argv[1], "--memoria") == 0) {
+    return medirMemoria(argc > 2 ? std::max(1, atoi(argv[2])) : 24);
+  }
+
+  const char* rutaTraza = nullptr;
+  const char* rutaSalida = nullptr;
+  int repeticiones = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--salida") == 0 && i + 1 < argc) {
+      rutaSalida = argv[++i];
+    } else if (strcmp(argv[i], "--repeticiones") == 0 && i + 1 < argc) {
+      repeticiones = std::max(1, atoi(argv[++i]));
+    } else {
+      rutaTraza = argv[i];
+    }
+  }
+
+  if (rutaTraza == nullptr) {
+    fprintf(stderr, "Uso: %s <traza.txt> [--salida replay.csv] [--repeticiones N]\n", argv[0]);
+    fprintf(stderr, "     %s --bench-ezo [MB]\n", argv[0]);
+    fprintf(stderr, "     %s --bench-anomalias [días]\n", argv[0]);
+    fprintf(stderr, "     %s --memoria [horas]\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<RegistroTraza> registros;
+  if (!cargarTraza(rutaTraza, &registros)) {
+    fprintf(stderr, "No se pudo abrir %s\n", rutaTraza);
+    return 1;
+  }
+  if (registros.empty()) {
+    fprintf(stderr, "%s no tiene registros de traza\n", rutaTraza);
+    return 1;
+  }
+
+  FILE* salida = nullptr;
+  if (rutaSalida != nullptr) {
+    salida = fopen(rutaSalida, "w");
+    if (salida == nullptr) {
+      fprintf(stderr, "No se pudo crear %s\n", rutaSalida);
+      return 1;
+    }
+    fprintf(salida, "ms,tipo,grabado,replay,delta,ns\n");
+  }
+
+  Estadistica ph, temperatura, tds;
+  ph.nombre = "pH";
+  temperatura.nombre = "Temperatura";
+  tds.nombre = "TDS";
+
+  auto inicioTotal = std::chrono::steady_clock::now();
+
+  for (int r = 0; r < repeticiones; r++) {
+    reiniciarSensores();
+
+    for (const RegistroTraza& registro : registros) {
+      Estadistica* e;
+      bool valida;
+      float resultado;
+
+      auto inicio = std::chrono::steady_clock::now();
+      switch (registro.tipo) {
+        case TRAZA_PH:
+          valida = procesarPh(registro.crudo);
+          resultado = valorPh;
+          e = &ph;
+          break;
+        case TRAZA_TEMPERATURA:
+          valida = procesarTemperatura(registro.crudo);
+          resultado = temperaturaAnterior;
+          e = &temperatura;
+          break;
+        case TRAZA_TDS:
+          valida = procesarTds(atoi(registro.crudo));
+          resultado = valorTdsAnterior;
+          e = &tds;
+          break;
+        default:
+          continue;
+      }
+      auto fin = std::chrono::steady_clock::now();
+      double ns = std::chrono::duration<double, std::nano>(fin - inicio).count();
+
+      e->tiemposNs.push_back(ns);
+
+      // Las diferencias solo se cuentan en la primera pasada
+      if (r > 0) continue;
+
+      // La traza guarda la salida con 3 decimales
+      double delta = fabs((double)resultado - registro.salida);
+      e->muestras++;
+      if (!valida) e->descartadas++;
+      if (delta > 0.0005) e->conDiferencia++;
+      e->sumaDelta += delta;
+      e->maxDelta = std::max(e->maxDelta, delta);
+
+      if (salida != nullptr) {
+        fprintf(salida, "%lu,%c,%.3f,%.3f,%.4f,%.0f\n", registro.ms, registro.tipo,
+                registro.salida, resultado, delta, ns);
+      }
+    }
+  }
+
+  double totalMs = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - inicioTotal).count();
+  double trazaMs = (double)(registros.back().ms - registros.front().ms);
+
+  printf("Traza %s: %zu registros, %.1f s de tiempo real, %d repeticion(es)\n",
+         rutaTraza, registros.size(), trazaMs / 1000.0, repeticiones);
+  imprimir(ph);
+  imprimir(temperatura);
+  imprimir(tds);
+  printf("Replay en %.2f ms (%.0fx tiempo real)\n", totalMs,
+         totalMs > 0 ? trazaMs * repeticiones / totalMs : 0.0);
+
+  if (salida != nullptr) fclose(salida);
+
+  // Código 3 si algún valor cambió respecto de lo grabado, para usarlo en scripts
+  bool cambios = ph.conDiferencia + temperatura.conDiferencia + tds.conDiferencia > 0;
+  return cambios ? 3 : 0;
+}
@@ -0,0 +1,87 @@
+#include "resumen.h"
+
+#include <math.h>
+#include <stdio.h>
+
+void iniciarResumen(Resumen* resumen, uint32_t segundos) {
+  resumen->segundos = segundos;
+  resumen->inicio = 0;
+  resumen->cantidad = 0;
+}
+
+bool agregarAResumen(Resumen* resumen, const Medicion& medicion, uint8_t rechazadas, Resumen* cerrado) {
+  uint32_t timestamp = (uint32_t)medicion.numeros[CAMPO_TIMESTAMP];
+  uint32_t inicio = timestamp - timestamp % resumen->segundos;
+
+  bool cerro = false;
+  if (resumen->cantidad > 0 && inicio != resumen->inicio) {
+    // Solo se informa si el tiempo fue para adelante
+    if (inicio > resumen->inicio) {
+      *cerrado = *resumen;
+      cerro = true;
+    }
+    resumen->cantidad = 0;
+  }
+
+  if (resumen->cantidad == 0) {
+    resumen->inicio = inicio;
+    for (AcumuladoCampo& campo : resumen->campos) campo.cantidad = 0;
+  }
+  resumen->cantidad++;
+
+  for (size_t i = 0; i < CANTIDAD_CAMPOS_RESUMEN; i++) {
+    // El valor de un campo rechazado es el de la lectura anterior
+    if (rechazadas & (1u << i)) continue;
+
+    AcumuladoCampo& campo = resumen->campos[i];
+    int64_t valor = medicion.numeros[CAMPOS_RESUMEN[i]];
+    campo.cantidad++;
+
+    if (campo.cantidad == 1) {
+      campo.minimo = campo.maximo = valor;
+      campo.media = (double)valor;
+      campo.m2 = 0;
+      continue;
+    }
+
+    if (valor < campo.minimo) campo.minimo = valor;
+    if (valor > campo.maximo) campo.maximo = valor;
+    double delta = valor - campo.media;
+    campo.media += delta / campo.cantidad;
+    campo.m2 += delta * (valor - campo.media);
+  }
+  return cerro;
+}
+
+size_t codificarResumenJson(const Resumen& resumen, const char* idDispositivo, char* destino, size_t capacidad) {
+  int largo = snprintf(destino, capacidad, "{\"window_s\":%lu,\"count\":%lu", (unsigned long)resumen.segundos,
+                       (unsigned long)resumen.cantidad);
+
+  for (size_t i = 0; i < CANTIDAD_CAMPOS_RESUMEN && largo > 0 && (size_t)largo < capacidad; i++) {
+    const Campo& esquema = CAMPOS_MEDICION[CAMPOS_RESUMEN[i]];
+    const AcumuladoCampo& campo = resumen.campos[i];
+    double escala = (double)potenciaDeDiez(esquema.decimales);
+
+    largo += snprintf(destino + largo, capacidad - largo, ",\"%s_count\":%lu", esquema.nombre,
+                      (unsigned long)campo.cantidad);
+    if (campo.cantidad == 0 || largo < 0 || (size_t)largo >= capacidad) continue;
+
+    // Varianza muestral; con una sola medición el desvío es 0
+    double desvio = campo.cantidad > 1 ? sqrt(campo.m2 / (campo.cantidad - 1)) : 0;
+
+    // Mínimo y máximo con los decimales del esquema; promedio y desvío con uno más
+    int decimales = esquema.decimales;
+    largo += snprintf(destino + largo, capacidad - largo,
+                      ",\"%s_min\":%.*f,\"%s_max\":%.*f,\"%s_mean\":%.*f,\"%s_stddev\":%.*f", esquema.nombre,
+                      decimales, campo.minimo / escala, esquema.nombre, decimales, campo.maximo / escala,
+                      esquema.nombre, decimales + 1, campo.media / escala, esquema.nombre, decimales + 1,
+                      desvio / escala);
+  }
+
+  if (largo > 0 && (size_t)largo < capacidad) {
+    largo += snprintf(destino + largo, capacidad - largo, ",\"timestamp\":%lu,\"device_id\":\"%s\"}",
+                      (unsigned long)resumen.inicio, idDispositivo);
+  }
+  if (largo < 0 || (size_t)largo >= capacidad) return 0;
+  return largo;
+}
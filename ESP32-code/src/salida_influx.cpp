@@ -0,0 +1,230 @@
+#include "salida_influx.h"
+
+#if SALIDA_INFLUX
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <algorithm>
+#include <string.h>
+#include "gzip.h"
+#include "muestreo.h"
+#include "protocolo_lineas.h"
+#include "registro.h"
+
+#define LARGO_MAXIMO_PREFIJO 96
+#define HTTP_ESCRITO 204  // Lo que responde /api/v2/write cuando escribió todo
+
+// Un lote entero o un tramo del diario
+constexpr size_t TAMANO_CUERPO_INFLUX =
+    std::max(LOTE_MAXIMO * (LARGO_MAXIMO_PREFIJO + TAMANO_MAXIMO_CAMPOS_LINEA), (size_t)DIARIO_INFLUX_TRAMO);
+
+static WiFiClient cliente;
+static HTTPClient http;
+static String url;
+static char prefijo[LARGO_MAXIMO_PREFIJO];
+static size_t largoPrefijo = 0;
+
+static char cuerpo[TAMANO_CUERPO_INFLUX];
+#if COMPRIMIR_INFLUX
+static uint8_t comprimido[TAMANO_CUERPO_INFLUX];
+#endif
+
+static EstadisticasInflux estadisticas;
+static bool ultimaEscrituraOk = false;
+
+// Diario: lo que falta reenviar va de 'posicionDiario' a 'tamanoDiario'
+static bool flashIniciada = false;
+static bool flashLista = false;
+static uint32_t tamanoDiario = 0;
+static uint32_t posicionDiario = 0;
+
+void configurarSalidaInflux(const char* servidor, uint16_t puerto) {
+  // org y bucket van sin escapar: tienen que ser nombres simples
+  url = String("http://") + servidor + ":" + String((unsigned)puerto) +
+        "/api/v2/write?org=" INFLUX_ORG "&bucket=" INFLUX_BUCKET "&precision=s";
+  largoPrefijo = armarPrefijoLinea(MEDICION_INFLUX, INFLUX_TAG_HOST, INFLUX_TAG_TOPICO, prefijo, sizeof(prefijo));
+
+  http.setReuse(true);
+  http.setTimeout(INFLUX_TIMEOUT_MS);
+
+  if (flashIniciada) return;
+  flashIniciada = true;
+  flashLista = LittleFS.begin(true);
+  if (!flashLista) {
+    REG_ERROR("Error montando LittleFS, sin diario para InfluxDB");
+    return;
+  }
+
+  // Lo que quedó de antes de reiniciar se reenvía entero
+  File archivo = LittleFS.open(DIARIO_INFLUX_ARCHIVO, FILE_READ);
+  if (archivo) {
+    tamanoDiario = archivo.size();
+    archivo.close();
+    if (tamanoDiario > 0) REG_INFO("Diario de InfluxDB pendiente: %lu bytes", (unsigned long)tamanoDiario);
+  }
+}
+
+// Sin respuesta, timeout, 429 y 5xx se reintentan; otro 4xx es que
+// InfluxDB no acepta esas líneas y volver a mandarlas no cambia nada
+static bool reintentable(int codigo) {
+  return codigo < 0 || codigo == 429 || codigo >= 500;
+}
+
+static uint32_t contarLineas(const char* texto, size_t largo) {
+  uint32_t lineas = 0;
+  for (size_t i = 0; i < largo; i++) lineas += texto[i] == '\n';
+  return lineas;
+}
+
+// POST de 'largo' bytes de cuerpo. Devuelve el código HTTP, o negativo si
+// no hubo respuesta.
+static int escribir(size_t largo) {
+  uint8_t* datos = (uint8_t*)cuerpo;
+  size_t largoEnviado = largo;
+  bool conGzip = false;
+#if COMPRIMIR_INFLUX
+  size_t largoComprimido = comprimirGzip(datos, largo, comprimido, sizeof(comprimido));
+  if (largoComprimido > 0 && largoComprimido < largo) {
+    datos = comprimido;
+    largoEnviado = largoComprimido;
+    conGzip = true;
+  }
+#endif
+
+  // Con setReuse, begin() sigue usando la conexión si el servidor no la cerró
+  http.begin(cliente, url);
+  http.addHeader("Authorization", "Token " INFLUX_TOKEN);
+  http.addHeader("Content-Type", "text/plain; charset=utf-8");
+  if (conGzip) http.addHeader("Content-Encoding", "gzip");
+
+  uint32_t inicio = millis();
+  int codigo = http.POST(datos, largoEnviado);
+  uint32_t duracion = millis() - inicio;
+  if (codigo != HTTP_ESCRITO && codigo > 0) {
+    // InfluxDB explica el error en el cuerpo
+    REG_AVISO("InfluxDB respondió %d: %s", codigo, http.getString().c_str());
+  }
+  http.end();
+
+  estadisticas.ultimoCodigo = codigo;
+  if (codigo != HTTP_ESCRITO) {
+    estadisticas.fallos++;
+    ultimaEscrituraOk = false;
+    if (codigo < 0) REG_AVISO("Error escribiendo en InfluxDB: %s", HTTPClient::errorToString(codigo).c_str());
+    return codigo;
+  }
+
+  estadisticas.escrituras++;
+  estadisticas.msUltima = duracion;
+  estadisticas.msMaxima = std::max(estadisticas.msMaxima, duracion);
+  estadisticas.msTotal += duracion;
+  estadisticas.bytesEnviados += largoEnviado;
+  estadisticas.bytesSinComprimir += largo;
+  ultimaEscrituraOk = true;
+  REG_INFO("Escrito en InfluxDB: %u bytes (%u enviados) en %lu ms", (unsigned)largo,
+           (unsigned)largoEnviado, (unsigned long)duracion);
+  return codigo;
+}
+
+static void guardarEnDiario(size_t largo, uint32_t lineas) {
+  if (!flashLista || tamanoDiario + largo > DIARIO_INFLUX_MAX_BYTES) {
+    estadisticas.lineasDescartadas += lineas;
+    return;
+  }
+
+  File archivo = LittleFS.open(DIARIO_INFLUX_ARCHIVO, FILE_APPEND);
+  if (!archivo || archivo.write((const uint8_t*)cuerpo, largo) != largo) {
+    if (archivo) archivo.close();
+    estadisticas.lineasDescartadas += lineas;
+    return;
+  }
+  archivo.close();
+  tamanoDiario += largo;
+  estadisticas.lineasAlDiario += lineas;
+}
+
+bool publicarEnInflux(const Medicion* mediciones, uint8_t cantidad) {
+  size_t largo = 0;
+  for (uint8_t i = 0; i < cantidad; i++) {
+    largo += escribirLinea(mediciones[i], prefijo, largoPrefijo, cuerpo + largo);
+  }
+
+  int codigo = escribir(largo);
+  if (codigo == HTTP_ESCRITO) return true;
+
+  if (reintentable(codigo)) {
+    guardarEnDiario(largo, cantidad);
+  } else {
+    estadisticas.lineasRechazadas += cantidad;
+  }
+  return false;
+}
+
+void vaciarDiarioInflux() {
+  if (!ultimaEscrituraOk || tamanoDiario == 0) return;
+
+  if (posicionDiario >= tamanoDiario) {
+    LittleFS.remove(DIARIO_INFLUX_ARCHIVO);
+    REG_INFO("Diario de InfluxDB reenviado: %lu bytes", (unsigned long)tamanoDiario);
+    tamanoDiario = 0;
+    posicionDiario = 0;
+    return;
+  }
+
+  File archivo = LittleFS.open(DIARIO_INFLUX_ARCHIVO, FILE_READ);
+  if (!archivo) {
+    tamanoDiario = 0;
+    posicionDiario = 0;
+    return;
+  }
+  archivo.seek(posicionDiario);
+  size_t leidos = archivo.read((uint8_t*)cuerpo, std::min((size_t)DIARIO_INFLUX_TRAMO,
+                                                           (size_t)(tamanoDiario - posicionDiario)));
+  archivo.close();
+
+  // Se corta en la última línea completa; una línea sin \n al final del
+  // archivo (se cortó la alimentación mientras se escribía) se descarta
+  size_t largo = leidos;
+  while (largo > 0 && cuerpo[largo - 1] != '\n') largo--;
+  if (largo == 0) {
+    posicionDiario += leidos > 0 ? leidos : tamanoDiario - posicionDiario;
+    return;
+  }
+
+  uint32_t lineas = contarLineas(cuerpo, largo);
+  int codigo = escribir(largo);
+  if (codigo == HTTP_ESCRITO) {
+    estadisticas.lineasRecuperadas += lineas;
+  } else if (!reintentable(codigo)) {
+    estadisticas.lineasRechazadas += lineas;
+  } else {
+    return;
+  }
+  posicionDiario += largo;
+}
+
+const EstadisticasInflux& estadisticasInflux() {
+  return estadisticas;
+}
+
+size_t describirInflux(char* destino, size_t largo) {
+  const EstadisticasInflux& e = estadisticas;
+  int escrito = snprintf(destino, largo,
+                         "{\"writes\":%lu,\"failures\":%lu,\"last_code\":%d,\"last_ms\":%lu,\"max_ms\":%lu,"
+                         "\"mean_ms\":%lu,\"bytes_sent\":%llu,\"bytes_uncompressed\":%llu,"
+                         "\"journal_lines\":%lu,\"journal_dropped\":%lu,\"journal_replayed\":%lu,"
+                         "\"journal_pending_bytes\":%lu,\"rejected_lines\":%lu}",
+                         (unsigned long)e.escrituras, (unsigned long)e.fallos, e.ultimoCodigo,
+                         (unsigned long)e.msUltima, (unsigned long)e.msMaxima,
+                         (unsigned long)(e.escrituras > 0 ? e.msTotal / e.escrituras : 0),
+                         (unsigned long long)e.bytesEnviados, (unsigned long long)e.bytesSinComprimir,
+                         (unsigned long)e.lineasAlDiario, (unsigned long)e.lineasDescartadas,
+                         (unsigned long)e.lineasRecuperadas, (unsigned long)(tamanoDiario - posicionDiario),
+                         (unsigned long)e.lineasRechazadas);
+  if (escrito < 0) return 0;
+  return std::min((size_t)escrito, largo - 1);
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "sensores.h"
+
+#include <math.h>
+#include <string.h>
+#include "ezo.h"
+
+float valorPh = 7.0;
+float temperaturaAnterior = 25.0;
+float valorTdsAnterior = 300.0;
+float phCrudo = NAN;
+float temperaturaCruda = NAN;
+float tdsCrudo = NAN;
+float ultimoVoltajeTds = 0.0;
+
+// Buffer para lecturas analógicas del TDS
+static int bufferAnalogico[SCOUNT];
+static int indiceBuffer = 0;
+
+void reiniciarSensores() {
+  valorPh = 7.0;
+  temperaturaAnterior = 25.0;
+  valorTdsAnterior = 300.0;
+  phCrudo = NAN;
+  temperaturaCruda = NAN;
+  tdsCrudo = NAN;
+  ultimoVoltajeTds = 0.0;
+
+  for (int i = 0; i < SCOUNT; i++) {
+    bufferAnalogico[i] = 0;
+  }
+  indiceBuffer = 0;
+}
+
+bool procesarPh(const char* respuesta) {
+  int32_t milesimas = 0;
+  TipoRespuestaEzo tipo = clasificarLineaEzo(respuesta, strlen(respuesta), &milesimas);
+  return procesarPhEzo(tipo, milesimas);
+}
+
+bool procesarPhEzo(TipoRespuestaEzo tipo, int32_t milesimas) {
+  phCrudo = tipo == EZO_VALOR ? milesimas / 1000.0f : NAN;
+
+  // Validar rango de pH
+  if (tipo == EZO_VALOR && milesimas >= 0 && milesimas <= 14000) {
+    valorPh = phCrudo;
+    return true;
+  }
+  return false;
+}
+
+bool procesarTemperatura(const char* respuesta) {
+  int32_t milesimas = 0;
+  TipoRespuestaEzo tipo = clasificarLineaEzo(respuesta, strlen(respuesta), &milesimas);
+  return procesarTemperaturaEzo(tipo, milesimas);
+}
+
+bool procesarTemperaturaEzo(TipoRespuestaEzo tipo, int32_t milesimas) {
+  temperaturaCruda = tipo == EZO_VALOR ? milesimas / 1000.0f : NAN;
+
+  // Validar rango razonable de temperatura
+  if (tipo == EZO_VALOR && milesimas >= -10000 && milesimas <= 60000) {
+    temperaturaAnterior = temperaturaCruda;
+    return true;
+  }
+  return false;
+}
+
+bool procesarTds(int codigoAdc) {
+  bufferAnalogico[indiceBuffer] = codigoAdc;
+  indiceBuffer = (indiceBuffer + 1) % SCOUNT;
+
+  // Calcular promedio de las muestras
+  long sumaBuffer = 0;
+  for (int i = 0; i < SCOUNT; i++) {
+    sumaBuffer += bufferAnalogico[i];
+  }
+
+  float promedioAnalogico = (float)sumaBuffer / SCOUNT;
+
+  // Convertir a voltaje (ESP32 ADC: 0-4095 = 0-3.3V)
+  float voltaje = (promedioAnalogico * VREF) / 4095.0;
+  ultimoVoltajeTds = voltaje;
+
+  // Compensación por temperatura (coeficiente típico: 2%/°C)
+  float coeficienteTemperatura = 1.0 + 0.02 * (temperaturaAnterior - 25.0);
+  float voltajeCompensado = voltaje / coeficienteTemperatura;
+
+  // Conversión a TDS en ppm (fórmula típica para sensores TDS genéricos)
+  // Esta fórmula puede necesitar calibración según tu sensor específico
+  float valorTds = (133.42 * voltajeCompensado * voltajeCompensado * voltajeCompensado
+                   - 255.86 * voltajeCompensado * voltajeCompensado
+                   + 857.39 * voltajeCompensado) * 0.5;
+
+  tdsCrudo = valorTds;
+
+  // Validar rango razonable (0-2000 ppm para agua de pileta)
+  if (valorTds >= 0 && valorTds <= 3000) {
+    valorTdsAnterior = valorTds;
+    return true;
+  }
+  return false;
+}
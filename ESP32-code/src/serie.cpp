@@ -0,0 +1,248 @@
+#include "serie.h"
+
+#include <string.h>
+
+// Bits del valor en los códigos '10', '110' y '1110'. Los timestamps con
+// intervalo fijo casi siempre caen en '0'; los saltos de unos segundos por
+// el muestreo adaptivo, en el primero.
+static const uint8_t BITS_TIEMPO[3] = {7, 12, 20};
+static const uint8_t BITS_VALOR[3] = {3, 8, 16};
+
+// ---- Bits ----
+
+static void escribirBits(uint8_t* datos, size_t* bit, uint64_t valor, uint8_t cantidad) {
+  while (cantidad > 0) {
+    size_t byte = *bit / 8;
+    uint8_t libres = 8 - (*bit % 8);
+    uint8_t tramo = cantidad < libres ? cantidad : libres;
+    uint8_t parte = (uint8_t)((valor >> (cantidad - tramo)) & ((1u << tramo) - 1));
+
+    if (libres == 8) datos[byte] = 0;
+    datos[byte] |= parte << (libres - tramo);
+    *bit += tramo;
+    cantidad -= tramo;
+  }
+}
+
+static bool leerBits(const LectorSerie* lector, size_t* bit, uint8_t cantidad, uint64_t* valor) {
+  if (*bit + cantidad > lector->largo * 8) return false;
+
+  uint64_t resultado = 0;
+  while (cantidad > 0) {
+    uint8_t disponibles = 8 - (*bit % 8);
+    uint8_t tramo = cantidad < disponibles ? cantidad : disponibles;
+    uint8_t byte = lector->datos[*bit / 8];
+    resultado = (resultado << tramo) | ((byte >> (disponibles - tramo)) & ((1u << tramo) - 1));
+    *bit += tramo;
+    cantidad -= tramo;
+  }
+  *valor = resultado;
+  return true;
+}
+
+static uint64_t zigzag(int64_t valor) {
+  return ((uint64_t)valor << 1) ^ (uint64_t)(valor >> 63);
+}
+
+static int64_t desZigzag(uint64_t valor) {
+  return (int64_t)(valor >> 1) ^ -(int64_t)(valor & 1);
+}
+
+// Bits que va a ocupar 'diferencia' (o el valor completo, si no entra)
+static uint8_t largoCodigo(int64_t diferencia, const uint8_t* bits) {
+  if (diferencia == 0) return 1;
+  uint64_t z = zigzag(diferencia);
+  for (uint8_t i = 0; i < 3; i++) {
+    if (z < (1ull << bits[i])) return i + 2 + bits[i];
+  }
+  return 4 + 32;
+}
+
+static void escribirCodigo(uint8_t* datos, size_t* bit, int64_t diferencia, int64_t valor,
+                           const uint8_t* bits) {
+  if (diferencia == 0) {
+    escribirBits(datos, bit, 0, 1);
+    return;
+  }
+  uint64_t z = zigzag(diferencia);
+  for (uint8_t i = 0; i < 3; i++) {
+    if (z < (1ull << bits[i])) {
+      // i+1 unos y un cero: '10', '110', '1110'
+      escribirBits(datos, bit, ((1u << (i + 1)) - 1) << 1, i + 2);
+      escribirBits(datos, bit, z, bits[i]);
+      return;
+    }
+  }
+  escribirBits(datos, bit, 0xf, 4);
+  escribirBits(datos, bit, (uint32_t)valor, 32);
+}
+
+// Lee un código: una diferencia o, con el escape, el valor completo en
+// *completo (y *esCompleto en true)
+static bool leerCodigo(LectorSerie* lector, const uint8_t* bits, int64_t* diferencia,
+                       uint32_t* completo, bool* esCompleto) {
+  uint8_t unos = 0;
+  uint64_t bit;
+  while (unos < 4) {
+    if (!leerBits(lector, &lector->bit, 1, &bit)) return false;
+    if (bit == 0) break;
+    unos++;
+  }
+
+  *esCompleto = unos == 4;
+  *diferencia = 0;
+  if (unos == 0) return true;
+
+  uint64_t valor;
+  if (!leerBits(lector, &lector->bit, *esCompleto ? 32 : bits[unos - 1], &valor)) return false;
+  if (*esCompleto) {
+    *completo = (uint32_t)valor;
+  } else {
+    *diferencia = desZigzag(valor);
+  }
+  return true;
+}
+
+// Los valores completos se guardan en 32 bits: con signo salvo el timestamp
+static int64_t valorDe32(uint32_t bits, size_t campo) {
+  return campo == CAMPO_TIMESTAMP ? (int64_t)bits : (int64_t)(int32_t)bits;
+}
+
+// ---- Compresor ----
+
+static void escribirCantidad(CompresorSerie* compresor) {
+  compresor->datos[1] = (uint8_t)compresor->cantidad;
+  compresor->datos[2] = (uint8_t)(compresor->cantidad >> 8);
+}
+
+bool iniciarCompresor(CompresorSerie* compresor, uint8_t* datos, size_t capacidad,
+                      const char* idDispositivo) {
+  size_t largoId = strnlen(idDispositivo, CAMPOS_MEDICION[CAMPO_ID_DISPOSITIVO].largoMaximo);
+  if (capacidad < 4 + largoId) return false;
+
+  compresor->datos = datos;
+  compresor->capacidad = capacidad;
+  compresor->cantidad = 0;
+  compresor->deltaTiempo = 0;
+  memset(compresor->anteriores, 0, sizeof(compresor->anteriores));
+
+  datos[0] = SERIE_VERSION;
+  escribirCantidad(compresor);
+  datos[3] = (uint8_t)largoId;
+  memcpy(datos + 4, idDispositivo, largoId);
+  compresor->bits = (4 + largoId) * 8;
+  return true;
+}
+
+bool agregarMedicion(CompresorSerie* compresor, const Medicion& medicion) {
+  if (compresor->cantidad == UINT16_MAX) return false;
+
+  // Primero se mide, para no dejar la serie a medio escribir
+  int64_t diferencias[CANTIDAD_CAMPOS];
+  int64_t deltaTiempo = 0;
+  size_t bits = 0;
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (CAMPOS_MEDICION[i].tipo != CAMPO_NUMERO) continue;
+
+    if (compresor->cantidad == 0) {
+      bits += 32;
+      continue;
+    }
+    diferencias[i] = medicion.numeros[i] - compresor->anteriores[i];
+    if (i == CAMPO_TIMESTAMP) {
+      deltaTiempo = diferencias[i];
+      diferencias[i] = deltaTiempo - compresor->deltaTiempo;
+      bits += largoCodigo(diferencias[i], BITS_TIEMPO);
+    } else {
+      bits += largoCodigo(diferencias[i], BITS_VALOR);
+    }
+  }
+  if (compresor->bits + bits > compresor->capacidad * 8) return false;
+
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (CAMPOS_MEDICION[i].tipo != CAMPO_NUMERO) continue;
+
+    if (compresor->cantidad == 0) {
+      escribirBits(compresor->datos, &compresor->bits, (uint32_t)medicion.numeros[i], 32);
+    } else {
+      escribirCodigo(compresor->datos, &compresor->bits, diferencias[i], medicion.numeros[i],
+                     i == CAMPO_TIMESTAMP ? BITS_TIEMPO : BITS_VALOR);
+    }
+    compresor->anteriores[i] = medicion.numeros[i];
+  }
+
+  compresor->deltaTiempo = deltaTiempo;
+  compresor->cantidad++;
+  escribirCantidad(compresor);
+  return true;
+}
+
+size_t largoSerie(const CompresorSerie& compresor) {
+  return (compresor.bits + 7) / 8;
+}
+
+// ---- Lector ----
+
+bool iniciarLectorSerie(LectorSerie* lector, const uint8_t* datos, size_t largo) {
+  if (largo < 4 || datos[0] != SERIE_VERSION) return false;
+  size_t largoId = datos[3];
+  if (largoId > CAMPOS_MEDICION[CAMPO_ID_DISPOSITIVO].largoMaximo || largo < 4 + largoId) return false;
+
+  lector->datos = datos;
+  lector->largo = largo;
+  lector->bit = (4 + largoId) * 8;
+  lector->restantes = (uint16_t)(datos[1] | (datos[2] << 8));
+  lector->primera = true;
+  lector->deltaTiempo = 0;
+  memset(lector->anteriores, 0, sizeof(lector->anteriores));
+  memcpy(lector->idDispositivo, datos + 4, largoId);
+  lector->idDispositivo[largoId] = '\0';
+  return true;
+}
+
+bool leerMedicion(LectorSerie* lector, Medicion* medicion) {
+  if (lector->restantes == 0) return false;
+
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    const Campo& campo = CAMPOS_MEDICION[i];
+    if (campo.tipo != CAMPO_NUMERO) continue;
+
+    int64_t valor;
+    if (lector->primera) {
+      uint64_t bits;
+      if (!leerBits(lector, &lector->bit, 32, &bits)) return false;
+      valor = valorDe32((uint32_t)bits, i);
+    } else {
+      int64_t diferencia;
+      uint32_t completo;
+      bool esCompleto;
+      if (!leerCodigo(lector, i == CAMPO_TIMESTAMP ? BITS_TIEMPO : BITS_VALOR, &diferencia,
+                      &completo, &esCompleto)) {
+        return false;
+      }
+
+      if (esCompleto) {
+        valor = valorDe32(completo, i);
+      } else if (i == CAMPO_TIMESTAMP) {
+        valor = lector->anteriores[i] + lector->deltaTiempo + diferencia;
+      } else {
+        valor = lector->anteriores[i] + diferencia;
+      }
+    }
+
+    if (valor < campo.minimo || valor > campo.maximo) return false;
+    if (i == CAMPO_TIMESTAMP && !lector->primera) lector->deltaTiempo = valor - lector->anteriores[i];
+    lector->anteriores[i] = valor;
+    medicion->numeros[i] = valor;
+  }
+
+  int64_t tendencia = medicion->numeros[CAMPO_VALOR_TENDENCIA];
+  medicion->textos[CAMPO_TENDENCIA] = tendencia > 0 ? TENDENCIA_SUBIENDO
+                                      : tendencia < 0 ? TENDENCIA_BAJANDO
+                                                      : TENDENCIA_ESTABLE;
+  medicion->textos[CAMPO_ID_DISPOSITIVO] = lector->idDispositivo;
+
+  lector->primera = false;
+  lector->restantes--;
+  return true;
+}
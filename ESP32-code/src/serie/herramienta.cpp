@@ -0,0 +1,237 @@
+// Herramienta de la PC para las series comprimidas (ver include/serie.h).
+//
+//   pio run -e native_serie
+//   mosquitto_sub -t pool/metrics/serie -F %x | .pio/build/native_serie/program
+//   .pio/build/native_serie/program --bench
+//   mosquitto_sub -t pool/metrics -C 2000 > capturado.txt
+//   .pio/build/native_serie/program --bench capturado.txt
+//
+// Sin opciones lee series en hexadecimal de la entrada estándar y escribe
+// cada medición como el JSON que publica el firmware, una por línea.
+//
+// --bench compara bytes por medición y velocidad de codificación contra el
+// JSON y el binario de esquema.h, con una serie sintética (un día por
+// minuto, con una dosificación de cloro) o con mediciones JSON capturadas.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "esquema.h"
+#include "muestreo.h"
+#include "serie.h"
+
+#define MEDICIONES_SINTETICAS (1440 * 30)
+
+static int valorHex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static int decodificar() {
+  static char linea[2 * 65536 + 2];
+  static uint8_t datos[65536];
+  char json[TAMANO_MAXIMO_JSON];
+  unsigned long series = 0, mediciones = 0, invalidas = 0;
+
+  while (fgets(linea, sizeof(linea), stdin) != nullptr) {
+    size_t largo = strcspn(linea, "\r\n");
+    if (largo == 0) continue;
+
+    size_t bytes = 0;
+    bool ok = largo % 2 == 0;
+    for (size_t i = 0; ok && i < largo; i += 2) {
+      int alto = valorHex(linea[i]), bajo = valorHex(linea[i + 1]);
+      ok = alto >= 0 && bajo >= 0;
+      datos[bytes++] = (uint8_t)(alto * 16 + bajo);
+    }
+
+    LectorSerie lector;
+    ok = ok && iniciarLectorSerie(&lector, datos, bytes);
+    Medicion medicion;
+    while (ok && lector.restantes > 0) {
+      ok = leerMedicion(&lector, &medicion);
+      if (ok) {
+        codificarJson(medicion, json);
+        printf("%s\n", json);
+        mediciones++;
+      }
+    }
+
+    if (ok) {
+      series++;
+    } else {
+      invalidas++;
+      fprintf(stderr, "INVALIDA: %.*s\n", (int)largo, linea);
+    }
+  }
+
+  fprintf(stderr, "%lu series válidas (%lu mediciones), %lu inválidas\n", series, mediciones, invalidas);
+  return invalidas > 0 ? 1 : 0;
+}
+
+// ---- Benchmark ----
+
+// Un día tras otro con una medición por minuto: temperatura con ciclo
+// diario, pH y TDS con ruido de la última cifra, y una dosificación de
+// cloro (pH que sube y vuelve) cada día
+static std::vector<Medicion> serieSintetica() {
+  std::vector<Medicion> serie;
+  uint32_t azar = 12345;
+  auto ruido = [&azar](int amplitud) {
+    azar = azar * 1103515245 + 12345;
+    return (int)((azar >> 16) % (2 * amplitud + 1)) - amplitud;
+  };
+
+  for (int i = 0; i < MEDICIONES_SINTETICAS; i++) {
+    int minutoDelDia = i % 1440;
+    double dosificacion = minutoDelDia >= 600 && minutoDelDia < 660 ? sin((minutoDelDia - 600) * M_PI / 60) : 0;
+
+    Medicion medicion;
+    fijarNumero(&medicion, CAMPO_PH, 7.40 + 0.4 * dosificacion + ruido(1) / 100.0);
+    fijarNumero(&medicion, CAMPO_TEMPERATURA, 26 + 2 * sin(minutoDelDia * 2 * M_PI / 1440) + ruido(1) / 10.0);
+    fijarNumero(&medicion, CAMPO_TDS, 450 + i / 1440 + ruido(2));
+    fijarNumero(&medicion, CAMPO_VALOR_TENDENCIA, 0);
+    medicion.textos[CAMPO_TENDENCIA] = TENDENCIA_ESTABLE;
+    fijarNumero(&medicion, CAMPO_TIMESTAMP, 1750000000 + 60 * i);
+    medicion.textos[CAMPO_ID_DISPOSITIVO] = "ESP32_Pileta";
+    serie.push_back(medicion);
+  }
+  return serie;
+}
+
+static bool leerCapturadas(const char* archivo, std::vector<Medicion>* serie,
+                           std::vector<std::vector<char>>* textos) {
+  FILE* entrada = fopen(archivo, "r");
+  if (!entrada) {
+    perror(archivo);
+    return false;
+  }
+
+  char linea[1024];
+  while (fgets(linea, sizeof(linea), entrada) != nullptr) {
+    size_t largo = strcspn(linea, "\r\n");
+    textos->emplace_back(TAMANO_TEXTOS_MEDICION);
+    Medicion medicion;
+    if (largo > 0 && decodificarJson(linea, largo, &medicion, textos->back().data())) {
+      serie->push_back(medicion);
+    } else {
+      textos->pop_back();
+    }
+  }
+  fclose(entrada);
+  return !serie->empty();
+}
+
+static bool mismosNumeros(const Medicion& a, const Medicion& b) {
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (CAMPOS_MEDICION[i].tipo == CAMPO_NUMERO && a.numeros[i] != b.numeros[i]) return false;
+  }
+  return true;
+}
+
+static double nsDesde(std::chrono::steady_clock::time_point inicio, size_t mediciones) {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - inicio);
+  return (double)ns.count() / mediciones;
+}
+
+// Comprime la serie en lotes de 'lote' mediciones y la vuelve a leer
+static bool medirSerie(const std::vector<Medicion>& serie, size_t lote, const char* nombre,
+                       size_t bytesJson) {
+  std::vector<uint8_t> buffer(tamanoMaximoSerie(lote));
+  std::vector<std::vector<uint8_t>> lotes;
+  const char* id = serie[0].textos[CAMPO_ID_DISPOSITIVO];
+
+  auto inicio = std::chrono::steady_clock::now();
+  for (size_t desde = 0; desde < serie.size(); desde += lote) {
+    CompresorSerie compresor;
+    iniciarCompresor(&compresor, buffer.data(), buffer.size(), id);
+    for (size_t i = desde; i < desde + lote && i < serie.size(); i++) {
+      if (!agregarMedicion(&compresor, serie[i])) return false;
+    }
+    lotes.emplace_back(buffer.begin(), buffer.begin() + largoSerie(compresor));
+  }
+  double nsCodificar = nsDesde(inicio, serie.size());
+
+  size_t bytes = 0;
+  for (const auto& datos : lotes) bytes += datos.size();
+
+  std::vector<Medicion> leidas;
+  leidas.reserve(serie.size());
+  inicio = std::chrono::steady_clock::now();
+  for (const auto& datos : lotes) {
+    LectorSerie lector;
+    if (!iniciarLectorSerie(&lector, datos.data(), datos.size())) return false;
+    Medicion medicion;
+    while (lector.restantes > 0) {
+      if (!leerMedicion(&lector, &medicion)) return false;
+      leidas.push_back(medicion);
+    }
+  }
+  double nsDecodificar = nsDesde(inicio, serie.size());
+
+  if (leidas.size() != serie.size()) return false;
+  for (size_t i = 0; i < serie.size(); i++) {
+    if (!mismosNumeros(leidas[i], serie[i])) {
+      fprintf(stderr, "La medición %zu no vuelve igual\n", i);
+      return false;
+    }
+  }
+
+  double porMedicion = (double)bytes / serie.size();
+  printf("%-20s %8.2f %7.1fx %12.1f %12.1f\n", nombre, porMedicion, (double)bytesJson / bytes,
+         nsCodificar, nsDecodificar);
+  return true;
+}
+
+static int benchmark(const char* archivo) {
+  std::vector<Medicion> serie;
+  std::vector<std::vector<char>> textos;
+  if (archivo) {
+    if (!leerCapturadas(archivo, &serie, &textos)) {
+      fprintf(stderr, "No hay mediciones JSON válidas en %s\n", archivo);
+      return 1;
+    }
+  } else {
+    serie = serieSintetica();
+  }
+  printf("%zu mediciones (%s)\n\n", serie.size(), archivo ? archivo : "sintéticas, 1 por minuto");
+
+  // Lo que el firmware publica hoy, una medición por mensaje
+  char json[TAMANO_MAXIMO_JSON];
+  uint8_t binario[TAMANO_MAXIMO_BINARIO];
+  size_t bytesJson = 0, bytesBinario = 0;
+
+  auto inicio = std::chrono::steady_clock::now();
+  for (const Medicion& medicion : serie) bytesJson += codificarJson(medicion, json);
+  double nsJson = nsDesde(inicio, serie.size());
+
+  inicio = std::chrono::steady_clock::now();
+  for (const Medicion& medicion : serie) bytesBinario += codificarBinario(medicion, binario);
+  double nsBinario = nsDesde(inicio, serie.size());
+
+  printf("%-20s %8s %8s %12s %12s\n", "formato", "B/med", "vs JSON", "ns/med cod", "ns/med dec");
+  printf("%-20s %8.2f %7.1fx %12.1f %12s\n", "JSON", (double)bytesJson / serie.size(), 1.0, nsJson, "-");
+  printf("%-20s %8.2f %7.1fx %12.1f %12s\n", "binario", (double)bytesBinario / serie.size(),
+         (double)bytesJson / bytesBinario, nsBinario, "-");
+
+  bool ok = medirSerie(serie, LOTE_MAXIMO, "serie, lote MQTT", bytesJson) &&
+            medirSerie(serie, 60, "serie, 1 hora", bytesJson) &&
+            medirSerie(serie, 1440, "serie, 1 día", bytesJson);
+  if (!ok) {
+    fprintf(stderr, "Error: la serie no se pudo comprimir y leer sin cambios\n");
+    return 2;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+    return benchmark(argc > 2 ? argv[2] : nullptr);
+  }
+  return decodificar();
+}
@@ -0,0 +1,58 @@
+#include "traza.h"
+
+#if MODO_TRAZA != TRAZA_NINGUNA
+
+#include <Arduino.h>
+#include "registro.h"
+
+#if MODO_TRAZA == TRAZA_FLASH
+#include <LittleFS.h>
+
+static bool flashLista = false;
+#endif
+
+void iniciarTraza() {
+#if MODO_TRAZA == TRAZA_FLASH
+  flashLista = LittleFS.begin(true);
+  if (!flashLista) {
+    REG_ERROR("Error montando LittleFS, no se grabará la traza");
+    return;
+  }
+  REG_INFO("Grabando traza en %s", TRAZA_ARCHIVO);
+#else
+  REG_INFO("Grabando traza por el puerto serie");
+#endif
+}
+
+void registrarTraza(char tipo, float salida, const char* crudo) {
+  char linea[96];
+  int largo = snprintf(linea, sizeof(linea), TRAZA_PREFIJO "%lu,%c,%.3f,%s\n",
+                       millis(), tipo, salida, crudo);
+  if (largo <= 0) return;
+  if (largo >= (int)sizeof(linea)) {
+    // Respuesta demasiado larga: se corta, pero la línea sigue terminando en \n
+    largo = sizeof(linea) - 1;
+    linea[largo - 1] = '\n';
+  }
+
+#if MODO_TRAZA == TRAZA_FLASH
+  if (!flashLista) return;
+
+  File archivo = LittleFS.open(TRAZA_ARCHIVO, FILE_APPEND);
+  if (!archivo) return;
+  if (archivo.size() + largo <= TRAZA_MAX_BYTES) {
+    archivo.write((const uint8_t*)linea, largo);
+  }
+  archivo.close();
+#else
+  Serial.write((const uint8_t*)linea, largo);
+#endif
+}
+
+void registrarTraza(char tipo, float salida, int crudo) {
+  char texto[12];
+  snprintf(texto, sizeof(texto), "%d", crudo);
+  registrarTraza(tipo, salida, texto);
+}
+
+#endif
@@ -0,0 +1,41 @@
+#include "uart_ezo.h"
+
+#include <Arduino.h>
+
+// El lector lo usa solo la tarea de la UART; la cola es lo único compartido
+static LectorEzo lector;
+static ColaEzo cola;
+
+static void recibirEzo() {
+  while (Serial2.available()) {
+    TipoRespuestaEzo tipo = agregarByteEzo(&lector, Serial2.read());
+    if (tipo == EZO_INCOMPLETA) continue;
+
+    LineaEzo linea;
+    linea.ms = millis();
+    linea.tipo = tipo;
+    linea.valor = lector.valor;
+    memcpy(linea.linea, lector.linea, sizeof(linea.linea));
+    encolarEzo(&cola, linea);
+  }
+}
+
+void iniciarUartEzo() {
+  reiniciarLectorEzo(&lector);
+  reiniciarColaEzo(&cola);
+  Serial2.onReceive(recibirEzo);
+}
+
+bool siguienteLineaEzo(LineaEzo* linea) {
+  return desencolarEzo(&cola, linea);
+}
+
+void descartarLineasEzo() {
+  LineaEzo linea;
+  while (desencolarEzo(&cola, &linea)) {
+  }
+}
+
+uint32_t lineasPerdidasEzo() {
+  return cola.descartadas.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,175 @@
+// Aplicación de deltas de firmware (delta.h): pio test -e native_test
+#include <string.h>
+#include <unity.h>
+#include "delta.h"
+
+// La imagen que corre y la que se arma, en memoria
+static uint8_t base[2048];
+static uint8_t nueva[4096];
+static size_t largoNueva;
+static bool fallarEscritura;
+
+static bool leerBase(uint32_t origen, uint8_t* destino, size_t largo, void*) {
+  memcpy(destino, base + origen, largo);
+  return true;
+}
+
+static bool escribir(const uint8_t* datos, size_t largo, void*) {
+  if (fallarEscritura || largoNueva + largo > sizeof(nueva)) return false;
+  memcpy(nueva + largoNueva, datos, largo);
+  largoNueva += largo;
+  return true;
+}
+
+// Arma un delta de a una operación
+struct Armado {
+  uint8_t datos[1024];
+  size_t largo;
+};
+
+static void agregarU32(Armado* armado, uint32_t valor) {
+  for (int i = 0; i < 4; i++) armado->datos[armado->largo++] = (uint8_t)(valor >> (8 * i));
+}
+
+static void empezar(Armado* armado, uint32_t tamanoFinal) {
+  memcpy(armado->datos, DELTA_MAGICO, 4);
+  armado->largo = 4;
+  agregarU32(armado, tamanoFinal);
+}
+
+static void copiar(Armado* armado, uint32_t origen, uint32_t largo) {
+  armado->datos[armado->largo++] = 'C';
+  agregarU32(armado, origen);
+  agregarU32(armado, largo);
+}
+
+static void agregar(Armado* armado, const char* texto) {
+  armado->datos[armado->largo++] = 'A';
+  agregarU32(armado, strlen(texto));
+  memcpy(armado->datos + armado->largo, texto, strlen(texto));
+  armado->largo += strlen(texto);
+}
+
+static void terminar(Armado* armado) {
+  armado->datos[armado->largo++] = 'F';
+}
+
+// Aplica el delta en pedazos de 'pedazo' bytes
+static bool aplicar(const Armado& armado, size_t pedazo, AplicadorDelta* delta) {
+  iniciarDelta(delta, leerBase, escribir, nullptr, sizeof(base));
+  largoNueva = 0;
+  for (size_t i = 0; i < armado.largo; i += pedazo) {
+    size_t tramo = armado.largo - i < pedazo ? armado.largo - i : pedazo;
+    if (!agregarDelta(delta, armado.datos + i, tramo)) return false;
+  }
+  return true;
+}
+
+void setUp() {
+  for (size_t i = 0; i < sizeof(base); i++) base[i] = (uint8_t)(i * 31 + 7);
+  fallarEscritura = false;
+}
+void tearDown() {}
+
+void test_copias_y_agregados_en_cualquier_pedazo() {
+  // Una copia más larga que DELTA_BLOQUE_COPIA, un agregado y otra copia
+  Armado armado;
+  empezar(&armado, 1500 + 5 + 100);
+  copiar(&armado, 100, 1500);
+  agregar(&armado, "hola!");
+  copiar(&armado, 0, 100);
+  terminar(&armado);
+
+  uint8_t esperada[1605];
+  memcpy(esperada, base + 100, 1500);
+  memcpy(esperada + 1500, "hola!", 5);
+  memcpy(esperada + 1505, base, 100);
+
+  const size_t pedazos[] = {1, 3, 7, 64, sizeof(armado.datos)};
+  for (size_t pedazo : pedazos) {
+    AplicadorDelta delta;
+    TEST_ASSERT_TRUE(aplicar(armado, pedazo, &delta));
+    TEST_ASSERT_TRUE(deltaCompleto(delta));
+    TEST_ASSERT_EQUAL(sizeof(esperada), largoNueva);
+    TEST_ASSERT_TRUE(memcmp(esperada, nueva, sizeof(esperada)) == 0);
+  }
+}
+
+void test_incompleto_o_de_otro_tamano() {
+  AplicadorDelta delta;
+  Armado armado;
+
+  // Sin la 'F'
+  empezar(&armado, 5);
+  agregar(&armado, "hola!");
+  TEST_ASSERT_TRUE(aplicar(armado, 1, &delta));
+  TEST_ASSERT_FALSE(deltaCompleto(delta));
+
+  // Escribe menos de lo anunciado
+  empezar(&armado, 6);
+  agregar(&armado, "hola!");
+  terminar(&armado);
+  TEST_ASSERT_TRUE(aplicar(armado, 1, &delta));
+  TEST_ASSERT_FALSE(deltaCompleto(delta));
+
+  // Escribe más
+  empezar(&armado, 4);
+  agregar(&armado, "hola!");
+  TEST_ASSERT_FALSE(aplicar(armado, 1, &delta));
+}
+
+void test_deltas_invalidos() {
+  AplicadorDelta delta;
+  Armado armado;
+
+  empezar(&armado, 5);
+  armado.datos[0] = 'X';
+  TEST_ASSERT_FALSE(aplicar(armado, 1, &delta));
+
+  // Operación desconocida
+  empezar(&armado, 5);
+  armado.datos[armado.largo++] = 'Z';
+  TEST_ASSERT_FALSE(aplicar(armado, 1, &delta));
+
+  // Copia fuera de la imagen actual, también por desborde de origen + largo
+  empezar(&armado, 10);
+  copiar(&armado, sizeof(base) - 5, 10);
+  TEST_ASSERT_FALSE(aplicar(armado, 1, &delta));
+  empezar(&armado, 10);
+  copiar(&armado, 5, UINT32_MAX - 2);
+  TEST_ASSERT_FALSE(aplicar(armado, 1, &delta));
+
+  // Algo después de la 'F'
+  empezar(&armado, 0);
+  terminar(&armado);
+  terminar(&armado);
+  TEST_ASSERT_FALSE(aplicar(armado, 1, &delta));
+
+  // Una vez en error no sigue
+  empezar(&armado, 5);
+  armado.datos[armado.largo++] = 'Z';
+  TEST_ASSERT_FALSE(aplicar(armado, sizeof(armado.datos), &delta));
+  const uint8_t fin = 'F';
+  TEST_ASSERT_FALSE(agregarDelta(&delta, &fin, 1));
+}
+
+void test_falla_la_escritura() {
+  Armado armado;
+  empezar(&armado, 100);
+  copiar(&armado, 0, 100);
+  terminar(&armado);
+
+  fallarEscritura = true;
+  AplicadorDelta delta;
+  TEST_ASSERT_FALSE(aplicar(armado, 1, &delta));
+  TEST_ASSERT_FALSE(deltaCompleto(delta));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_copias_y_agregados_en_cualquier_pedazo);
+  RUN_TEST(test_incompleto_o_de_otro_tamano);
+  RUN_TEST(test_deltas_invalidos);
+  RUN_TEST(test_falla_la_escritura);
+  return UNITY_END();
+}
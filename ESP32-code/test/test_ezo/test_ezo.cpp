@@ -0,0 +1,181 @@
+// Lector de respuestas del EZO (ezo.h): pio test -e native_test
+#include <string.h>
+#include <unity.h>
+#include "ezo.h"
+
+static TipoRespuestaEzo clasificar(const char* linea, int32_t* valor) {
+  return clasificarLineaEzo(linea, strlen(linea), valor);
+}
+
+// Manda 'bytes' al lector y devuelve lo que dio el último
+static TipoRespuestaEzo enviar(LectorEzo* lector, const char* bytes) {
+  TipoRespuestaEzo tipo = EZO_INCOMPLETA;
+  for (const char* p = bytes; *p != '\0'; p++) tipo = agregarByteEzo(lector, (uint8_t)*p);
+  return tipo;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_codigos_de_estado() {
+  int32_t valor = 0;
+  TEST_ASSERT_EQUAL(EZO_OK, clasificar("*OK", &valor));
+  TEST_ASSERT_EQUAL(EZO_ER, clasificar("*ER", &valor));
+  TEST_ASSERT_EQUAL(EZO_OV, clasificar("*OV", &valor));
+  TEST_ASSERT_EQUAL(EZO_UV, clasificar("*UV", &valor));
+  TEST_ASSERT_EQUAL(EZO_RS, clasificar("*RS", &valor));
+  TEST_ASSERT_EQUAL(EZO_OTRO_ESTADO, clasificar("*RE", &valor));
+  TEST_ASSERT_EQUAL(EZO_OTRO_ESTADO, clasificar("*SL", &valor));
+  TEST_ASSERT_EQUAL(EZO_OTRO_ESTADO, clasificar("*DONE", &valor));
+  TEST_ASSERT_EQUAL(EZO_OTRO_ESTADO, clasificar("*O", &valor));
+  TEST_ASSERT_EQUAL(EZO_OK, clasificar("  *OK \t", &valor));
+  TEST_ASSERT_EQUAL(0, valor);  // Un estado no toca el valor
+}
+
+void test_valores_en_milesimas() {
+  int32_t valor;
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("7.000", &valor));
+  TEST_ASSERT_EQUAL_INT32(7000, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("7.25", &valor));
+  TEST_ASSERT_EQUAL_INT32(7250, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("12", &valor));
+  TEST_ASSERT_EQUAL_INT32(12000, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar(".5", &valor));
+  TEST_ASSERT_EQUAL_INT32(500, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("-1.5", &valor));
+  TEST_ASSERT_EQUAL_INT32(-1500, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar(" 6.8 ", &valor));
+  TEST_ASSERT_EQUAL_INT32(6800, valor);
+}
+
+void test_redondeo_del_cuarto_decimal() {
+  int32_t valor;
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("7.0004", &valor));
+  TEST_ASSERT_EQUAL_INT32(7000, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("7.0005", &valor));
+  TEST_ASSERT_EQUAL_INT32(7001, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("7.99951", &valor));
+  TEST_ASSERT_EQUAL_INT32(8000, valor);
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("-1.0005", &valor));
+  TEST_ASSERT_EQUAL_INT32(-1001, valor);
+}
+
+void test_varios_valores_toma_el_primero() {
+  int32_t valor;
+  TEST_ASSERT_EQUAL(EZO_VALOR, clasificar("7.12,25.3", &valor));
+  TEST_ASSERT_EQUAL_INT32(7120, valor);
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar(",7.12", &valor));
+}
+
+void test_lineas_malformadas() {
+  int32_t valor = 123;
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar("", &valor));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar("   ", &valor));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar("-", &valor));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar(".", &valor));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar("7.1x", &valor));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar("7..1", &valor));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, clasificar("3000000", &valor));
+  TEST_ASSERT_EQUAL_INT32(123, valor);
+}
+
+void test_arma_la_linea_hasta_el_retorno() {
+  LectorEzo lector;
+  reiniciarLectorEzo(&lector);
+  TEST_ASSERT_EQUAL(EZO_INCOMPLETA, enviar(&lector, "7.25"));
+  TEST_ASSERT_EQUAL(EZO_VALOR, agregarByteEzo(&lector, '\r'));
+  TEST_ASSERT_EQUAL_INT32(7250, lector.valor);
+  TEST_ASSERT_EQUAL_STRING("7.25", lector.linea);
+
+  TEST_ASSERT_EQUAL(EZO_OK, enviar(&lector, "*OK\r"));
+  TEST_ASSERT_EQUAL_STRING("*OK", lector.linea);
+  TEST_ASSERT_EQUAL_INT32(7250, lector.valor);
+}
+
+void test_ignora_el_salto_despues_del_retorno() {
+  LectorEzo lector;
+  reiniciarLectorEzo(&lector);
+  TEST_ASSERT_EQUAL(EZO_VALOR, enviar(&lector, "7.25\r"));
+  TEST_ASSERT_EQUAL(EZO_VALOR, enviar(&lector, "\n8.5\r"));
+  TEST_ASSERT_EQUAL_INT32(8500, lector.valor);
+  TEST_ASSERT_EQUAL_STRING("8.5", lector.linea);
+  TEST_ASSERT_EQUAL(EZO_ER, enviar(&lector, "\n*ER\r"));
+}
+
+void test_linea_demasiado_larga() {
+  LectorEzo lector;
+  reiniciarLectorEzo(&lector);
+  char linea[EZO_LARGO_MAXIMO + 2];
+
+  // Justo el máximo entra
+  memset(linea, 'A', EZO_LARGO_MAXIMO);
+  linea[0] = '*';
+  linea[EZO_LARGO_MAXIMO] = '\0';
+  TEST_ASSERT_EQUAL(EZO_INCOMPLETA, enviar(&lector, linea));
+  TEST_ASSERT_EQUAL(EZO_OTRO_ESTADO, agregarByteEzo(&lector, '\r'));
+  TEST_ASSERT_EQUAL(EZO_LARGO_MAXIMO, strlen(lector.linea));
+
+  // Uno más no, y la línea siguiente empieza de cero
+  memset(linea, '1', EZO_LARGO_MAXIMO + 1);
+  linea[EZO_LARGO_MAXIMO + 1] = '\0';
+  enviar(&lector, linea);
+  TEST_ASSERT_EQUAL(EZO_DESBORDE, agregarByteEzo(&lector, '\r'));
+  TEST_ASSERT_EQUAL(EZO_VALOR, enviar(&lector, "7.1\r"));
+  TEST_ASSERT_EQUAL_INT32(7100, lector.valor);
+}
+
+void test_bytes_de_ruido() {
+  LectorEzo lector;
+  reiniciarLectorEzo(&lector);
+  TEST_ASSERT_EQUAL(EZO_INCOMPLETA, enviar(&lector, "7."));
+  TEST_ASSERT_EQUAL(EZO_INCOMPLETA, agregarByteEzo(&lector, 0xff));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, enviar(&lector, "25\r"));
+  TEST_ASSERT_EQUAL(EZO_INCOMPLETA, agregarByteEzo(&lector, 0x00));
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, enviar(&lector, "*OK\r"));
+
+  // El ruido no pasa a la línea siguiente
+  TEST_ASSERT_EQUAL(EZO_VALOR, enviar(&lector, "6.9\r"));
+  TEST_ASSERT_EQUAL_INT32(6900, lector.valor);
+}
+
+void test_retorno_solo() {
+  LectorEzo lector;
+  reiniciarLectorEzo(&lector);
+  TEST_ASSERT_EQUAL(EZO_MALFORMADA, agregarByteEzo(&lector, '\r'));
+  TEST_ASSERT_EQUAL_STRING("", lector.linea);
+}
+
+void test_cola_llena_descarta() {
+  static ColaEzo cola;
+  reiniciarColaEzo(&cola);
+  LineaEzo linea = {};
+  for (int i = 0; i < EZO_CAPACIDAD_COLA; i++) {
+    linea.valor = i;
+    TEST_ASSERT_TRUE(encolarEzo(&cola, linea));
+  }
+  TEST_ASSERT_FALSE(encolarEzo(&cola, linea));
+  TEST_ASSERT_EQUAL_UINT32(1, cola.descartadas.load());
+
+  LineaEzo leida;
+  for (int i = 0; i < EZO_CAPACIDAD_COLA; i++) {
+    TEST_ASSERT_TRUE(desencolarEzo(&cola, &leida));
+    TEST_ASSERT_EQUAL_INT32(i, leida.valor);
+  }
+  TEST_ASSERT_FALSE(desencolarEzo(&cola, &leida));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_codigos_de_estado);
+  RUN_TEST(test_valores_en_milesimas);
+  RUN_TEST(test_redondeo_del_cuarto_decimal);
+  RUN_TEST(test_varios_valores_toma_el_primero);
+  RUN_TEST(test_lineas_malformadas);
+  RUN_TEST(test_arma_la_linea_hasta_el_retorno);
+  RUN_TEST(test_ignora_el_salto_despues_del_retorno);
+  RUN_TEST(test_linea_demasiado_larga);
+  RUN_TEST(test_bytes_de_ruido);
+  RUN_TEST(test_retorno_solo);
+  RUN_TEST(test_cola_llena_descarta);
+  return UNITY_END();
+}
@@ -0,0 +1,162 @@
+// Compresión gzip (gzip.h): pio test -e native_test
+//
+// Para leer lo comprimido alcanza con un inflate de códigos fijos, que es
+// lo único que escribe comprimirGzip().
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "gzip.h"
+
+struct LectorBits {
+  const uint8_t* datos;
+  size_t largo;
+  size_t bit;
+};
+
+static uint32_t leerBits(LectorBits* lector, uint8_t cantidad) {
+  uint32_t valor = 0;
+  for (uint8_t i = 0; i < cantidad; i++) {
+    if (lector->bit >= lector->largo * 8) return UINT32_MAX;
+    valor |= (uint32_t)((lector->datos[lector->bit / 8] >> (lector->bit % 8)) & 1) << i;
+    lector->bit++;
+  }
+  return valor;
+}
+
+// Un código Huffman, desde el bit más significativo
+static uint32_t leerCodigo(LectorBits* lector, uint8_t cantidad) {
+  uint32_t codigo = 0;
+  for (uint8_t i = 0; i < cantidad; i++) codigo = (codigo << 1) | leerBits(lector, 1);
+  return codigo;
+}
+
+static int leerSimbolo(LectorBits* lector) {
+  uint32_t codigo = leerCodigo(lector, 7);
+  if (codigo <= 0x17) return 256 + codigo;
+  codigo = (codigo << 1) | leerBits(lector, 1);
+  if (codigo >= 0x30 && codigo <= 0xBF) return codigo - 0x30;
+  if (codigo >= 0xC0 && codigo <= 0xC7) return 280 + codigo - 0xC0;
+  codigo = (codigo << 1) | leerBits(lector, 1);
+  return 144 + codigo - 0x190;
+}
+
+static const uint16_t BASE_LARGO[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t EXTRA_LARGO[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t BASE_DISTANCIA[30] = {1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+                                            33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+                                            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t EXTRA_DISTANCIA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static uint32_t crc32(const uint8_t* datos, size_t largo) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < largo; i++) {
+    crc ^= datos[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+  }
+  return ~crc;
+}
+
+static uint32_t leerU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Descomprime en 'destino'. Devuelve el largo, o -1 si el gzip no es válido
+// (encabezado, bloque, distancias, CRC o largo de la cola).
+static long descomprimir(const uint8_t* gzip, size_t largo, uint8_t* destino, size_t capacidad) {
+  if (largo < 18 || gzip[0] != 0x1F || gzip[1] != 0x8B || gzip[2] != 8 || gzip[3] != 0) return -1;
+
+  LectorBits lector = {gzip + 10, largo - 18, 0};
+  if (leerBits(&lector, 1) != 1 || leerBits(&lector, 2) != 1) return -1;  // Final, códigos fijos
+
+  size_t escritos = 0;
+  while (true) {
+    int simbolo = leerSimbolo(&lector);
+    if (lector.bit > lector.largo * 8 || simbolo > 285) return -1;
+    if (simbolo == 256) break;
+    if (simbolo < 256) {
+      if (escritos >= capacidad) return -1;
+      destino[escritos++] = (uint8_t)simbolo;
+      continue;
+    }
+
+    int codigo = simbolo - 257;
+    size_t copia = BASE_LARGO[codigo] + leerBits(&lector, EXTRA_LARGO[codigo]);
+    codigo = leerCodigo(&lector, 5);
+    if (codigo >= 30) return -1;
+    size_t distancia = BASE_DISTANCIA[codigo] + leerBits(&lector, EXTRA_DISTANCIA[codigo]);
+    if (distancia > escritos || escritos + copia > capacidad) return -1;
+    for (size_t i = 0; i < copia; i++, escritos++) destino[escritos] = destino[escritos - distancia];
+  }
+
+  const uint8_t* cola = gzip + largo - 8;
+  if (leerU32(cola) != crc32(destino, escritos) || leerU32(cola + 4) != escritos) return -1;
+  return (long)escritos;
+}
+
+static uint8_t comprimido[8192];
+static uint8_t descomprimido[8192];
+
+static void idaYVuelta(const uint8_t* datos, size_t largo) {
+  size_t largoComprimido = comprimirGzip(datos, largo, comprimido, sizeof(comprimido));
+  TEST_ASSERT_TRUE(largoComprimido > 0);
+  TEST_ASSERT_EQUAL(largo, descomprimir(comprimido, largoComprimido, descomprimido, sizeof(descomprimido)));
+  TEST_ASSERT_TRUE(memcmp(datos, descomprimido, largo) == 0);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_protocolo_de_lineas() {
+  // Lo que manda salida_influx: el prefijo y los nombres se repiten
+  char lineas[4096];
+  size_t largo = 0;
+  for (int i = 0; i < 20; i++) {
+    largo += snprintf(lineas + largo, sizeof(lineas) - largo,
+                      "Mediciones-Pileta,device_id=ESP32_Pileta ph=7.%02d,temperature_c=26.%d,tds_ppm=%di,"
+                      "trend=\"estable\",trend_value=0i %d000000000\n",
+                      40 + i % 7, i % 10, 1200 + i, 1750000000 + 10 * i);
+  }
+  idaYVuelta((const uint8_t*)lineas, largo);
+
+  size_t largoComprimido = comprimirGzip((const uint8_t*)lineas, largo, comprimido, sizeof(comprimido));
+  TEST_ASSERT_TRUE(largoComprimido < largo / 3);
+}
+
+void test_vacio_y_cortos() {
+  idaYVuelta((const uint8_t*)"", 0);
+  idaYVuelta((const uint8_t*)"a", 1);
+  idaYVuelta((const uint8_t*)"ab", 2);
+  idaYVuelta((const uint8_t*)"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 30);  // Se copia a sí mismo (distancia 1)
+}
+
+void test_todos_los_bytes() {
+  // Literales de 8 y de 9 bits, y coincidencias de todos los largos
+  uint8_t datos[4096];
+  for (size_t i = 0; i < 256; i++) datos[i] = (uint8_t)i;
+  for (size_t i = 256; i < sizeof(datos); i++) datos[i] = datos[(i * 7) % 256] ^ (uint8_t)(i / 300);
+  idaYVuelta(datos, sizeof(datos));
+}
+
+void test_lo_que_no_entra() {
+  const char* texto = "ph=7.40,temperature_c=26.1 ph=7.40,temperature_c=26.1";
+  size_t largo = strlen(texto);
+  size_t necesario = comprimirGzip((const uint8_t*)texto, largo, comprimido, sizeof(comprimido));
+  TEST_ASSERT_TRUE(necesario > 0);
+  TEST_ASSERT_EQUAL(0, comprimirGzip((const uint8_t*)texto, largo, comprimido, necesario - 1));
+  TEST_ASSERT_EQUAL(necesario, comprimirGzip((const uint8_t*)texto, largo, comprimido, necesario));
+
+  static uint8_t grande[GZIP_LARGO_MAXIMO + 1];
+  TEST_ASSERT_EQUAL(0, comprimirGzip(grande, sizeof(grande), comprimido, sizeof(comprimido)));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_protocolo_de_lineas);
+  RUN_TEST(test_vacio_y_cortos);
+  RUN_TEST(test_todos_los_bytes);
+  RUN_TEST(test_lo_que_no_entra);
+  return UNITY_END();
+}
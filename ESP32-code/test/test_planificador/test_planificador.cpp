@@ -0,0 +1,153 @@
+// Planificador con rueda de tiempo (planificador.h): pio test -e native_test
+#include <unity.h>
+#include "planificador.h"
+
+static uint32_t reloj;
+static uint32_t leerReloj() {
+  return reloj;
+}
+
+static Planificador planificador;
+
+// Lo que ejecutó cada tarea, en orden
+static int orden[32];
+static uint8_t ejecutadas;
+static uint32_t horas[32];
+
+static void anotar(void* contexto) {
+  if (ejecutadas < 32) {
+    orden[ejecutadas] = (int)(intptr_t)contexto;
+    horas[ejecutadas] = reloj;
+    ejecutadas++;
+  }
+}
+
+// Avanza el reloj de a 'pasoMs' hasta 'hastaMs' (relativo), con una pasada en cada paso
+static void avanzar(uint32_t hastaMs, uint32_t pasoMs) {
+  for (uint32_t transcurrido = 0; transcurrido < hastaMs; transcurrido += pasoMs) {
+    reloj += pasoMs;
+    ejecutarPendientes(&planificador);
+  }
+}
+
+void setUp() {
+  reloj = 1000;
+  ejecutadas = 0;
+  iniciarPlanificador(&planificador, leerReloj);
+}
+void tearDown() {}
+
+void test_una_vuelta_como_mucho() {
+  // Tres tareas en ranuras distintas y el reloj salta varias vueltas: las
+  // 16 ranuras cubren todas, y salen en orden de hora programada
+  int a = agregarTarea(&planificador, "a", anotar, (void*)0, 0, 0);
+  int b = agregarTarea(&planificador, "b", anotar, (void*)1, 0, 0);
+  int c = agregarTarea(&planificador, "c", anotar, (void*)2, 0, 0);
+  programarTarea(&planificador, c, 200);
+  programarTarea(&planificador, a, 10);
+  programarTarea(&planificador, b, 30);
+
+  reloj += 1000;  // 250 ticks
+  ejecutarPendientes(&planificador);
+  TEST_ASSERT_EQUAL(3, ejecutadas);
+  TEST_ASSERT_EQUAL(0, orden[0]);
+  TEST_ASSERT_EQUAL(1, orden[1]);
+  TEST_ASSERT_EQUAL(2, orden[2]);
+
+  // De una vez: no vuelven a salir
+  reloj += 1000;
+  ejecutarPendientes(&planificador);
+  TEST_ASSERT_EQUAL(3, ejecutadas);
+}
+
+void test_misma_ranura_distinta_vuelta() {
+  // 'b' cae en la misma ranura que 'a' pero una vuelta después
+  int a = agregarTarea(&planificador, "a", anotar, (void*)0, 0, 0);
+  int b = agregarTarea(&planificador, "b", anotar, (void*)1, 0, 0);
+  programarTarea(&planificador, a, 8);
+  programarTarea(&planificador, b, 8 + PLANIFICADOR_RANURAS * PLANIFICADOR_TICK_MS);
+
+  avanzar(8, 1);
+  TEST_ASSERT_EQUAL(1, ejecutadas);
+  TEST_ASSERT_EQUAL(0, orden[0]);
+
+  avanzar(PLANIFICADOR_RANURAS * PLANIFICADOR_TICK_MS, 1);
+  TEST_ASSERT_EQUAL(2, ejecutadas);
+  TEST_ASSERT_EQUAL(1, orden[1]);
+  TEST_ASSERT_EQUAL_UINT32(1000 + 8 + PLANIFICADOR_RANURAS * PLANIFICADOR_TICK_MS, horas[1]);
+}
+
+void test_tarea_a_varias_vueltas() {
+  // 500 ms son casi 8 vueltas de la rueda
+  int tarea = agregarTarea(&planificador, "lejana", anotar, (void*)0, 0, 0);
+  programarTarea(&planificador, tarea, 500);
+  TEST_ASSERT_EQUAL_UINT32(500, ejecutarPendientes(&planificador));
+
+  avanzar(499, 1);
+  TEST_ASSERT_EQUAL(0, ejecutadas);
+  TEST_ASSERT_EQUAL_UINT32(1, ejecutarPendientes(&planificador));
+
+  avanzar(1, 1);
+  TEST_ASSERT_EQUAL(1, ejecutadas);
+  TEST_ASSERT_EQUAL_UINT32(1500, horas[0]);
+  TEST_ASSERT_EQUAL_UINT32(PLANIFICADOR_ESPERA_MAXIMA_MS, ejecutarPendientes(&planificador));
+}
+
+// Tarea que en su primera ejecución pasa a un período de 300 ms
+static int tareaQueCambia;
+static void cambiarDesdeAdentro(void* contexto) {
+  anotar(contexto);
+  if (ejecutadas == 1) cambiarPeriodo(&planificador, tareaQueCambia, 300);
+}
+
+void test_cambiar_periodo_desde_la_tarea() {
+  tareaQueCambia = agregarTarea(&planificador, "cambia", cambiarDesdeAdentro, (void*)0, 100, 0);
+  programarTarea(&planificador, tareaQueCambia, 100);
+
+  avanzar(1000, 1);
+  // 1100, y de ahí cada 300 ms
+  TEST_ASSERT_EQUAL(4, ejecutadas);
+  TEST_ASSERT_EQUAL_UINT32(1100, horas[0]);
+  TEST_ASSERT_EQUAL_UINT32(1400, horas[1]);
+  TEST_ASSERT_EQUAL_UINT32(1700, horas[2]);
+  TEST_ASSERT_EQUAL_UINT32(2000, horas[3]);
+}
+
+void test_cambiar_periodo_desde_afuera() {
+  int tarea = agregarTarea(&planificador, "periodica", anotar, (void*)0, 100, 0);
+  programarTarea(&planificador, tarea, 100);
+  avanzar(100, 1);
+  TEST_ASSERT_EQUAL(1, ejecutadas);
+
+  // Programada para 1200: pasa a la anterior más el período nuevo
+  avanzar(20, 1);
+  cambiarPeriodo(&planificador, tarea, 50);
+  avanzar(40, 1);
+  TEST_ASSERT_EQUAL(2, ejecutadas);
+  TEST_ASSERT_EQUAL_UINT32(1150, horas[1]);
+}
+
+void test_millis_da_la_vuelta() {
+  reloj = UINT32_MAX - 50;
+  iniciarPlanificador(&planificador, leerReloj);
+  int tarea = agregarTarea(&planificador, "periodica", anotar, (void*)0, 20, 0);
+  programarTarea(&planificador, tarea, 20);
+
+  avanzar(200, 1);
+  TEST_ASSERT_EQUAL(10, ejecutadas);
+  for (uint8_t i = 0; i < ejecutadas; i++) {
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX - 50 + 20 * (i + 1), horas[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, planificador.tareas[tarea].estadisticas.atrasoMaximoMs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_una_vuelta_como_mucho);
+  RUN_TEST(test_misma_ranura_distinta_vuelta);
+  RUN_TEST(test_tarea_a_varias_vueltas);
+  RUN_TEST(test_cambiar_periodo_desde_la_tarea);
+  RUN_TEST(test_cambiar_periodo_desde_afuera);
+  RUN_TEST(test_millis_da_la_vuelta);
+  return UNITY_END();
+}
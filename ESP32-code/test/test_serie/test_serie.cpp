@@ -0,0 +1,147 @@
+// Series comprimidas (serie.h): pio test -e native_test
+#include <string.h>
+#include <unity.h>
+#include "serie.h"
+
+static Medicion medicion(int64_t ph, int64_t temperatura, int64_t tds, int64_t tendencia, int64_t timestamp) {
+  Medicion m = {};
+  m.numeros[CAMPO_PH] = ph;
+  m.numeros[CAMPO_TEMPERATURA] = temperatura;
+  m.numeros[CAMPO_TDS] = tds;
+  m.numeros[CAMPO_VALOR_TENDENCIA] = tendencia;
+  m.numeros[CAMPO_TIMESTAMP] = timestamp;
+  return m;
+}
+
+static void compararNumeros(const Medicion& esperada, const Medicion& leida) {
+  for (size_t i = 0; i < CANTIDAD_CAMPOS; i++) {
+    if (CAMPOS_MEDICION[i].tipo != CAMPO_NUMERO) continue;
+    TEST_ASSERT_EQUAL(esperada.numeros[i], leida.numeros[i]);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_ida_y_vuelta() {
+  // Cambios chicos, medianos, grandes y el escape de 32 bits
+  Medicion mediciones[] = {
+      medicion(740, 261, 1200, 0, 1750000000),  medicion(741, 261, 1200, 1, 1750000010),
+      medicion(738, 262, 1210, 1, 1750000020),  medicion(700, 250, 1500, -1, 1750000031),
+      medicion(1400, -100, 0, 0, 1750000100),   medicion(0, 600, 3000, 0, 1750100000),
+      medicion(0, 600, 3000, 0, 1750100000),
+  };
+  const size_t cantidad = sizeof(mediciones) / sizeof(mediciones[0]);
+  uint8_t datos[tamanoMaximoSerie(cantidad)];
+
+  CompresorSerie compresor;
+  TEST_ASSERT_TRUE(iniciarCompresor(&compresor, datos, sizeof(datos), "ESP32_Pileta"));
+  for (const Medicion& m : mediciones) TEST_ASSERT_TRUE(agregarMedicion(&compresor, m));
+  TEST_ASSERT_EQUAL(cantidad, compresor.cantidad);
+
+  LectorSerie lector;
+  TEST_ASSERT_TRUE(iniciarLectorSerie(&lector, datos, largoSerie(compresor)));
+  TEST_ASSERT_EQUAL_STRING("ESP32_Pileta", lector.idDispositivo);
+
+  Medicion leida;
+  for (const Medicion& m : mediciones) {
+    TEST_ASSERT_TRUE(leerMedicion(&lector, &leida));
+    compararNumeros(m, leida);
+    TEST_ASSERT_EQUAL_STRING("ESP32_Pileta", leida.textos[CAMPO_ID_DISPOSITIVO]);
+  }
+  TEST_ASSERT_FALSE(leerMedicion(&lector, &leida));
+}
+
+void test_tendencia_desde_el_valor() {
+  uint8_t datos[tamanoMaximoSerie(3)];
+  CompresorSerie compresor;
+  iniciarCompresor(&compresor, datos, sizeof(datos), "");
+  agregarMedicion(&compresor, medicion(740, 260, 1200, 1, 100));
+  agregarMedicion(&compresor, medicion(740, 260, 1200, 0, 110));
+  agregarMedicion(&compresor, medicion(740, 260, 1200, -1, 120));
+
+  LectorSerie lector;
+  Medicion leida;
+  iniciarLectorSerie(&lector, datos, largoSerie(compresor));
+  leerMedicion(&lector, &leida);
+  TEST_ASSERT_EQUAL_STRING(TENDENCIA_SUBIENDO, leida.textos[CAMPO_TENDENCIA]);
+  leerMedicion(&lector, &leida);
+  TEST_ASSERT_EQUAL_STRING(TENDENCIA_ESTABLE, leida.textos[CAMPO_TENDENCIA]);
+  leerMedicion(&lector, &leida);
+  TEST_ASSERT_EQUAL_STRING(TENDENCIA_BAJANDO, leida.textos[CAMPO_TENDENCIA]);
+}
+
+void test_valores_quietos_ocupan_un_bit() {
+  // Intervalo fijo y valores iguales: un bit por campo numérico
+  uint8_t datos[256];
+  CompresorSerie compresor;
+  iniciarCompresor(&compresor, datos, sizeof(datos), "");
+  for (int i = 0; i < 101; i++) agregarMedicion(&compresor, medicion(740, 260, 1200, 0, 1750000000 + 10 * i));
+
+  size_t bits = 4 * 8 + CAMPOS_NUMERICOS_SERIE * 32  // Encabezado sin id y la primera
+                + (CAMPOS_NUMERICOS_SERIE - 1) + 9    // La segunda: el intervalo nuevo ('10' + 7 bits)
+                + 99 * CAMPOS_NUMERICOS_SERIE;        // El resto
+  TEST_ASSERT_EQUAL((bits + 7) / 8, largoSerie(compresor));
+}
+
+void test_lo_que_no_entra_no_se_escribe() {
+  uint8_t datos[4 + CAMPOS_NUMERICOS_SERIE * 4 + 1];
+  CompresorSerie compresor;
+  TEST_ASSERT_FALSE(iniciarCompresor(&compresor, datos, 3, ""));
+  TEST_ASSERT_TRUE(iniciarCompresor(&compresor, datos, sizeof(datos), ""));
+
+  TEST_ASSERT_TRUE(agregarMedicion(&compresor, medicion(740, 260, 1200, 0, 1000)));
+  // Un cambio grande en todos los campos no entra en el byte que queda
+  TEST_ASSERT_FALSE(agregarMedicion(&compresor, medicion(100, -50, 2900, 1, 90000)));
+  // Sin ningún cambio (ni en el timestamp) es un bit por campo: entra
+  TEST_ASSERT_TRUE(agregarMedicion(&compresor, medicion(740, 260, 1200, 0, 1000)));
+  TEST_ASSERT_EQUAL(2, compresor.cantidad);
+
+  // La serie quedó entera
+  LectorSerie lector;
+  Medicion leida;
+  TEST_ASSERT_TRUE(iniciarLectorSerie(&lector, datos, largoSerie(compresor)));
+  TEST_ASSERT_TRUE(leerMedicion(&lector, &leida));
+  TEST_ASSERT_TRUE(leerMedicion(&lector, &leida));
+  compararNumeros(medicion(740, 260, 1200, 0, 1000), leida);
+  TEST_ASSERT_FALSE(leerMedicion(&lector, &leida));
+}
+
+void test_datos_invalidos() {
+  uint8_t datos[tamanoMaximoSerie(2)];
+  CompresorSerie compresor;
+  iniciarCompresor(&compresor, datos, sizeof(datos), "equipo");
+  agregarMedicion(&compresor, medicion(740, 260, 1200, 0, 1000));
+  agregarMedicion(&compresor, medicion(741, 260, 1200, 0, 1010));
+  size_t largo = largoSerie(compresor);
+
+  LectorSerie lector;
+  Medicion leida;
+  TEST_ASSERT_FALSE(iniciarLectorSerie(&lector, datos, 3));
+
+  // Cortada: la primera se lee, la segunda no
+  TEST_ASSERT_TRUE(iniciarLectorSerie(&lector, datos, 4 + 6 + CAMPOS_NUMERICOS_SERIE * 4));
+  TEST_ASSERT_TRUE(leerMedicion(&lector, &leida));
+  TEST_ASSERT_FALSE(leerMedicion(&lector, &leida));
+  TEST_ASSERT_EQUAL(1, lector.restantes);
+
+  // Otra versión
+  datos[0] = SERIE_VERSION + 1;
+  TEST_ASSERT_FALSE(iniciarLectorSerie(&lector, datos, largo));
+  datos[0] = SERIE_VERSION;
+
+  // Un pH fuera del rango del esquema (el primero va en 32 bits, desde el byte 10)
+  datos[4 + 6] = 0x7F;
+  TEST_ASSERT_TRUE(iniciarLectorSerie(&lector, datos, largo));
+  TEST_ASSERT_FALSE(leerMedicion(&lector, &leida));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_ida_y_vuelta);
+  RUN_TEST(test_tendencia_desde_el_valor);
+  RUN_TEST(test_valores_quietos_ocupan_un_bit);
+  RUN_TEST(test_lo_que_no_entra_no_se_escribe);
+  RUN_TEST(test_datos_invalidos);
+  return UNITY_END();
+}
@@ -0,0 +1,103 @@
+"""Carga de prueba para comparar Telegraf con el puente (ver comparar.sh).
+
+Publica mediciones con el esquema del firmware en pool/metrics, con
+timestamps distintos, y consulta InfluxDB hasta que están todas. Corre en la
+imagen del simulador (que ya tiene paho-mqtt):
+
+    docker compose run --rm --no-deps -v "$PWD/influx-bridge/bench:/bench" \\
+        lecture-simulator python /bench/carga.py --mediciones 50000
+
+Escribe una línea JSON con el resultado.
+"""
+import argparse, json, os, sys, time, urllib.request
+
+import paho.mqtt.client as mqtt
+
+sys.path.insert(0, "/app")
+import esquema_pileta
+
+
+def contar(dispositivo, desde, hasta):
+    """Mediciones de 'dispositivo' que ya están en InfluxDB"""
+    consulta = f'''
+from(bucket: "{os.environ["INFLUX_BUCKET"]}")
+  |> range(start: {desde}, stop: {hasta})
+  |> filter(fn: (r) => r._measurement == "Mediciones-Pileta" and r._field == "device_id" and r._value == "{dispositivo}")
+  |> count()
+'''
+    pedido = urllib.request.Request(
+        f'{os.environ["INFLUX_URL"]}/api/v2/query?org={os.environ["INFLUX_ORG"]}',
+        data=consulta.encode(),
+        headers={
+            "Authorization": f'Token {os.environ["INFLUX_TOKEN"]}',
+            "Content-Type": "application/vnd.flux",
+            "Accept": "application/csv",
+        },
+    )
+    with urllib.request.urlopen(pedido, timeout=10) as respuesta:
+        filas = [f.split(",") for f in respuesta.read().decode().splitlines() if f.strip()]
+    if not filas:
+        return 0
+    columna = filas[0].index("_value")
+    return sum(int(f[columna]) for f in filas[1:] if f[columna] != "_value")
+
+
+def main():
+    argumentos = argparse.ArgumentParser()
+    argumentos.add_argument("--mediciones", type=int, default=50000)
+    argumentos.add_argument("--por-segundo", type=float, default=0, help="Mensajes por segundo (0: sin límite)")
+    argumentos.add_argument("--lote", type=int, default=1, help="Mediciones por mensaje (array JSON, como el firmware)")
+    argumentos.add_argument("--dispositivo", default=f"bench-{int(time.time())}")
+    argumentos.add_argument("--timeout", type=float, default=120)
+    a = argumentos.parse_args()
+
+    # Un segundo por medición, todas en el pasado
+    base = int(time.time()) - a.mediciones - 60
+
+    cliente = mqtt.Client(client_id=a.dispositivo)
+    cliente.max_inflight_messages_set(200)
+    cliente.connect(os.environ.get("MQTT_HOST", "mosquitto"), int(os.environ.get("MQTT_PORT", "1883")))
+    cliente.loop_start()
+
+    inicio = time.time()
+    pendientes = []
+    for desde in range(0, a.mediciones, a.lote):
+        lote = [
+            esquema_pileta.armar_payload(
+                ph=7.4 + (i % 7) / 100, temperature_c=26 + (i % 11) / 10, tds_ppm=450 + i % 13,
+                trend=esquema_pileta.TENDENCIA_ESTABLE, trend_value=0, timestamp=base + i,
+                device_id=a.dispositivo,
+            )
+            for i in range(desde, min(desde + a.lote, a.mediciones))
+        ]
+        payload = json.dumps(lote[0] if a.lote == 1 else lote, separators=(",", ":"))
+        pendientes.append(cliente.publish(os.environ.get("MQTT_TOPIC", "pool/metrics"), payload, qos=1))
+        if a.por_segundo > 0:
+            espera = inicio + len(pendientes) / a.por_segundo - time.time()
+            if espera > 0:
+                time.sleep(espera)
+    for p in pendientes:
+        p.wait_for_publish()
+    publicado = time.time()
+
+    cantidad = 0
+    while cantidad < a.mediciones and time.time() - publicado < a.timeout:
+        time.sleep(0.5)
+        cantidad = contar(a.dispositivo, base - 1, base + a.mediciones + 1)
+    fin = time.time()
+    cliente.loop_stop()
+
+    print(json.dumps({
+        "mediciones": a.mediciones,
+        "escritas": cantidad,
+        "mensajes": len(pendientes),
+        "publicacion_s": round(publicado - inicio, 2),
+        "total_s": round(fin - inicio, 2),
+        "mediciones_por_s": round(cantidad / (fin - inicio), 1),
+        "lag_ultima_s": round(fin - publicado, 2),
+    }))
+    return 0 if cantidad == a.mediciones else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
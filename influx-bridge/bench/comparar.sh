@@ -0,0 +1,58 @@
+#!/bin/sh
+# Compara Telegraf con el puente con la misma carga y el mismo mosquitto e
+# InfluxDB del docker-compose. Desde la raíz del repo:
+#
+#   sh influx-bridge/bench/comparar.sh [mediciones] [mensajes/s] [mediciones por mensaje]
+#
+# Para cada uno levanta solo ese servicio, publica la carga (carga.py),
+# espera a que esté todo en InfluxDB y muestra el resultado junto con la
+# memoria y la CPU del contenedor (en reposo y el pico durante la carga).
+# Al final deja Telegraf como estaba.
+set -e
+
+MEDICIONES=${1:-50000}
+POR_SEGUNDO=${2:-0}
+LOTE=${3:-1}
+
+set -a
+. ./.env
+set +a
+
+# Pico de memoria (MiB) y de CPU (%) de las muestras de docker stats
+pico() {
+  awk '{
+    valor = $1; unidad = $1
+    sub(/[A-Za-z]+$/, "", valor); sub(/^[0-9.]+/, "", unidad)
+    factor = unidad == "GiB" ? 1024 : unidad == "KiB" ? 1 / 1024 : unidad == "B" ? 1 / 1048576 : 1
+    if (valor * factor > memoria) memoria = valor * factor
+    cpu = $4; sub(/%/, "", cpu)
+    if (cpu + 0 > maximo) maximo = cpu + 0
+  } END { printf "memoria pico %.1f MiB, CPU pico %.0f%%", memoria, maximo }' "$1"
+}
+
+docker compose --profile puente build influx-bridge
+docker compose up -d mosquitto influxdb
+
+for servicio in telegraf influx-bridge; do
+  docker compose --profile puente stop telegraf influx-bridge lecture-simulator >/dev/null 2>&1 || true
+  docker compose --profile puente up -d "$servicio"
+  sleep 10
+
+  reposo=$(docker stats --no-stream --format '{{.MemUsage}}' "$servicio" | cut -d/ -f1)
+  muestras=$(mktemp)
+  (while true; do docker stats --no-stream --format '{{.MemUsage}} {{.CPUPerc}}' "$servicio"; done >"$muestras") &
+  muestreo=$!
+
+  echo "== $servicio"
+  docker compose run --rm --no-deps -v "$PWD/influx-bridge/bench:/bench" \
+    -e INFLUX_URL -e INFLUX_ORG -e INFLUX_BUCKET -e INFLUX_TOKEN \
+    lecture-simulator python /bench/carga.py --mediciones "$MEDICIONES" --por-segundo "$POR_SEGUNDO" \
+    --lote "$LOTE" --dispositivo "bench-$servicio-$(date +%s)" || true
+
+  kill "$muestreo"
+  echo "memoria en reposo $reposo, $(pico "$muestras")"
+  rm -f "$muestras"
+done
+
+docker compose --profile puente stop influx-bridge
+docker compose up -d telegraf
@@ -0,0 +1,180 @@
+#include "influx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "red.h"
+
+#define TAMANO_RESPUESTA 4096
+
+// Agrega 'texto' a 'destino' como parámetro de URL
+static bool agregarCodificado(char* destino, size_t capacidad, const char* texto) {
+  static const char* hex = "0123456789ABCDEF";
+  size_t largo = strlen(destino);
+  for (; *texto != '\0'; texto++) {
+    unsigned char c = (unsigned char)*texto;
+    bool seguro = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '-' || c == '_' || c == '.' || c == '~';
+    if (largo + (seguro ? 1 : 3) >= capacidad) return false;
+    if (seguro) {
+      destino[largo++] = (char)c;
+    } else {
+      destino[largo++] = '%';
+      destino[largo++] = hex[c >> 4];
+      destino[largo++] = hex[c & 0x0f];
+    }
+  }
+  destino[largo] = '\0';
+  return true;
+}
+
+static bool agregar(char* destino, size_t capacidad, const char* texto) {
+  size_t largo = strlen(destino);
+  if (largo + strlen(texto) >= capacidad) return false;
+  strcpy(destino + largo, texto);
+  return true;
+}
+
+bool configurarInflux(DestinoInflux* destino, const char* url, const char* organizacion, const char* bucket,
+                      const char* token) {
+  destino->socket = -1;
+  if (strncmp(url, "http://", 7) != 0) return false;
+
+  const char* host = url + 7;
+  size_t largoHost = strcspn(host, ":/");
+  if (largoHost == 0 || largoHost >= sizeof(destino->host)) return false;
+  memcpy(destino->host, host, largoHost);
+  destino->host[largoHost] = '\0';
+
+  const char* resto = host + largoHost;
+  destino->puerto = 80;
+  if (*resto == ':') {
+    char* fin;
+    long puerto = strtol(resto + 1, &fin, 10);
+    if (puerto <= 0 || puerto > 65535) return false;
+    destino->puerto = (uint16_t)puerto;
+    resto = fin;
+  }
+  if (strcmp(resto, "") != 0 && strcmp(resto, "/") != 0) return false;
+
+  char hostPuerto[160];
+  snprintf(hostPuerto, sizeof(hostPuerto), "%s:%u", destino->host, destino->puerto);
+
+  char* e = destino->encabezado;
+  size_t capacidad = sizeof(destino->encabezado);
+  e[0] = '\0';
+  return agregar(e, capacidad, "POST /api/v2/write?org=") && agregarCodificado(e, capacidad, organizacion) &&
+         agregar(e, capacidad, "&bucket=") && agregarCodificado(e, capacidad, bucket) &&
+         agregar(e, capacidad, "&precision=s HTTP/1.1\r\nHost: ") && agregar(e, capacidad, hostPuerto) &&
+         agregar(e, capacidad, "\r\nAuthorization: Token ") && agregar(e, capacidad, token) &&
+         agregar(e, capacidad,
+                 "\r\nContent-Type: text/plain; charset=utf-8\r\n"
+                 "Connection: keep-alive\r\n");
+}
+
+// Valor del encabezado 'nombre' en 'encabezados' (terminados en \0), o nullptr
+static const char* buscarEncabezado(const char* encabezados, const char* nombre) {
+  size_t largoNombre = strlen(nombre);
+  for (const char* linea = strstr(encabezados, "\r\n"); linea != nullptr; linea = strstr(linea, "\r\n")) {
+    linea += 2;
+    if (strncasecmp(linea, nombre, largoNombre) == 0 && linea[largoNombre] == ':') {
+      const char* valor = linea + largoNombre + 1;
+      while (*valor == ' ') valor++;
+      return valor;
+    }
+  }
+  return nullptr;
+}
+
+// Lee la respuesta. Devuelve el código HTTP o -1 si se cortó.
+static int leerRespuesta(DestinoInflux* destino, int64_t* esperaMs) {
+  char respuesta[TAMANO_RESPUESTA];
+  size_t largo = 0;
+  char* finEncabezados = nullptr;
+
+  while (finEncabezados == nullptr) {
+    if (largo == sizeof(respuesta) - 1) return -1;
+    ssize_t leidos = recv(destino->socket, respuesta + largo, sizeof(respuesta) - 1 - largo, 0);
+    if (leidos <= 0) return -1;
+    largo += (size_t)leidos;
+    respuesta[largo] = '\0';
+    finEncabezados = strstr(respuesta, "\r\n\r\n");
+  }
+  *finEncabezados = '\0';
+  const char* cuerpo = finEncabezados + 4;
+  size_t recibidoCuerpo = largo - (size_t)(cuerpo - respuesta);
+
+  int codigo;
+  if (sscanf(respuesta, "HTTP/1.%*d %d", &codigo) != 1) return -1;
+
+  const char* retryAfter = buscarEncabezado(respuesta, "Retry-After");
+  if (retryAfter != nullptr) *esperaMs = atol(retryAfter) * 1000;
+
+  // El cuerpo se descarta (o se muestra, si es un error). 1xx, 204 (lo que
+  // responde una escritura buena) y 304 no tienen cuerpo ni Content-Length.
+  // Con otro código y sin largo no se sabe dónde termina, así que la
+  // conexión no se vuelve a usar.
+  bool sinCuerpo = codigo / 100 == 1 || codigo == 204 || codigo == 304;
+  const char* largoCuerpo = buscarEncabezado(respuesta, "Content-Length");
+  const char* conexion = buscarEncabezado(respuesta, "Connection");
+  bool seguir = (sinCuerpo || largoCuerpo != nullptr) &&
+                (conexion == nullptr || strncasecmp(conexion, "close", 5) != 0);
+
+  if (codigo >= 300) {
+    fprintf(stderr, "InfluxDB respondió %d: %.*s\n", codigo, (int)(recibidoCuerpo < 300 ? recibidoCuerpo : 300), cuerpo);
+  }
+
+  if (seguir) {
+    long faltan = sinCuerpo ? 0 : atol(largoCuerpo) - (long)recibidoCuerpo;
+    char descarte[1024];
+    while (faltan > 0) {
+      ssize_t leidos = recv(destino->socket, descarte, faltan < (long)sizeof(descarte) ? faltan : sizeof(descarte), 0);
+      if (leidos <= 0) return -1;
+      faltan -= leidos;
+    }
+  } else {
+    cerrarInflux(destino);
+  }
+  return codigo;
+}
+
+// Un intento sobre la conexión abierta (o una nueva)
+static int intentar(DestinoInflux* destino, const char* lineas, size_t largo, int64_t* esperaMs) {
+  if (destino->socket < 0) destino->socket = conectarTcp(destino->host, destino->puerto);
+  if (destino->socket < 0) return -1;
+
+  char largoContenido[48];
+  int largoEncabezado = snprintf(largoContenido, sizeof(largoContenido), "Content-Length: %zu\r\n\r\n", largo);
+  if (!enviarTodo(destino->socket, destino->encabezado, strlen(destino->encabezado)) ||
+      !enviarTodo(destino->socket, largoContenido, (size_t)largoEncabezado) ||
+      !enviarTodo(destino->socket, lineas, largo)) {
+    cerrarInflux(destino);
+    return -1;
+  }
+
+  int codigo = leerRespuesta(destino, esperaMs);
+  if (codigo < 0) cerrarInflux(destino);
+  return codigo;
+}
+
+ResultadoEscritura escribirInflux(DestinoInflux* destino, const char* lineas, size_t largo, int64_t* esperaMs) {
+  *esperaMs = 0;
+  bool reusada = destino->socket >= 0;
+  int codigo = intentar(destino, lineas, largo, esperaMs);
+
+  // InfluxDB pudo haber cerrado la conexión mientras estaba quieta
+  if (codigo < 0 && reusada) codigo = intentar(destino, lineas, largo, esperaMs);
+
+  if (codigo >= 200 && codigo < 300) return ESCRITURA_OK;
+  if (codigo < 0 || codigo == 429 || codigo >= 500) return ESCRITURA_REINTENTAR;
+  return ESCRITURA_RECHAZADA;
+}
+
+void cerrarInflux(DestinoInflux* destino) {
+  if (destino->socket >= 0) close(destino->socket);
+  destino->socket = -1;
+}
@@ -0,0 +1,36 @@
+#ifndef INFLUX_H
+#define INFLUX_H
+
+// Escritura en InfluxDB v2 (POST /api/v2/write) sobre una conexión HTTP/1.1
+// que se mantiene abierta entre lotes. Solo http:// (la red de
+// docker-compose); para llegar por https hay que poner un proxy adelante.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct DestinoInflux {
+  char host[128];
+  uint16_t puerto;
+  char encabezado[1024];  // Línea de pedido y encabezados fijos, sin Content-Length
+  int socket;
+};
+
+// Arma el destino a partir de INFLUX_URL, la organización, el bucket y el
+// token. Devuelve false si la URL no es http://host[:puerto].
+bool configurarInflux(DestinoInflux* destino, const char* url, const char* organizacion, const char* bucket,
+                      const char* token);
+
+enum ResultadoEscritura {
+  ESCRITURA_OK,
+  ESCRITURA_REINTENTAR,  // Sin conexión, timeout, 429 o 5xx
+  ESCRITURA_RECHAZADA,   // 4xx: el lote no va a entrar nunca
+};
+
+// Manda un lote en protocolo de líneas (precision=s). Si hay que
+// reintentar, *esperaMs queda con lo que pidió el servidor (Retry-After) o
+// en 0.
+ResultadoEscritura escribirInflux(DestinoInflux* destino, const char* lineas, size_t largo, int64_t* esperaMs);
+
+void cerrarInflux(DestinoInflux* destino);
+
+#endif
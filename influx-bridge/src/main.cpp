@@ -0,0 +1,457 @@
+// Puente MQTT -> InfluxDB v2 para la telemetría de la pileta. Reemplaza a
+// Telegraf (telegraf/telegraf.conf) en el camino de ingesta: escribe las
+// mismas líneas, pero entiende el esquema del firmware en vez de parsear
+// JSON genérico y arma los lotes por tamaño y por tiempo.
+//
+//   recepción (este hilo)                      escritura (otro hilo)
+//   MQTT -> mensaje -> líneas -> lote actual -> cola de lotes llenos -> POST /api/v2/write
+//                                   ^                                        |
+//                                   +------------ lotes libres <-------------+
+//
+// Hay BRIDGE_BUFFERS lotes reservados al arrancar, que se reusan. Si
+// InfluxDB no da abasto (o está caído) se llenan todos y la recepción deja
+// de leer el socket de MQTT hasta que se libera uno: la contrapresión llega
+// al broker por TCP en vez de crecer la memoria del puente.
+//
+// Configuración por variables de entorno, con los mismos nombres que el
+// resto del docker-compose (ver README.md).
+
+#include <condition_variable>
+#include <mutex>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+#include "influx.h"
+#include "mensajes.h"
+#include "metricas.h"
+#include "mqtt.h"
+#include "protocolo_lineas.h"
+#include "red.h"
+
+#define MAXIMO_LOTES 64
+#define REINTENTO_MINIMO_MS 1000
+#define REINTENTO_MAXIMO_MS 30000
+#define INVALIDOS_EN_LOG 10  // Después se avisa uno cada 1000
+
+struct Configuracion {
+  const char* hostMqtt;
+  uint16_t puertoMqtt;
+  const char* idCliente;
+  char topicos[CANTIDAD_FORMATOS][128];  // Indexados por FormatoMensaje
+  FormatoMensaje formato;                // El único que se lee
+
+  const char* urlInflux;
+  const char* organizacion;
+  const char* bucket;
+  const char* token;
+  const char* medicion;
+  const char* host;
+
+  size_t lineasPorLote;
+  size_t bytesPorLote;
+  int64_t esperaLoteMs;
+  size_t cantidadLotes;
+  uint16_t puertoMetricas;
+  int64_t intervaloLogMs;
+};
+
+struct Lote {
+  char* texto;
+  size_t capacidad;
+  size_t largo;
+  size_t lineas;
+  int64_t primerMensajeMs;
+  int64_t timestampMaximo;
+};
+
+// Cola de punteros a lote de tamaño fijo
+struct ColaLotes {
+  Lote* lotes[MAXIMO_LOTES];
+  size_t primero;
+  size_t cantidad;
+};
+
+static Configuracion configuracion;
+static MetricasPuente metricas;
+static DestinoInflux destino;
+
+static std::mutex mutexLotes;
+static std::condition_variable cambioLotes;
+static ColaLotes libres, llenos;
+static volatile sig_atomic_t terminando = 0;
+static bool recepcionTerminada = false;
+
+static char prefijo[512];
+static size_t largoPrefijo;
+
+// ---- Configuración ----
+
+static const char* variable(const char* nombre, const char* porDefecto) {
+  const char* valor = getenv(nombre);
+  return valor != nullptr && valor[0] != '\0' ? valor : porDefecto;
+}
+
+static long variableNumero(const char* nombre, long porDefecto, long minimo, long maximo) {
+  const char* valor = getenv(nombre);
+  if (valor == nullptr || valor[0] == '\0') return porDefecto;
+  char* fin;
+  long numero = strtol(valor, &fin, 10);
+  if (*fin != '\0' || numero < minimo || numero > maximo) {
+    fprintf(stderr, "%s=%s fuera de rango [%ld, %ld], se usa %ld\n", nombre, valor, minimo, maximo, porDefecto);
+    return porDefecto;
+  }
+  return numero;
+}
+
+static bool leerConfiguracion(Configuracion* c) {
+  c->hostMqtt = variable("MQTT_HOST", "mosquitto");
+  c->puertoMqtt = (uint16_t)variableNumero("MQTT_PORT", 1883, 1, 65535);
+  c->idCliente = variable("BRIDGE_CLIENT_ID", "influx-bridge");
+
+  // Los mismos tópicos que publica el firmware (include/pileta.h)
+  const char* topico = variable("MQTT_TOPIC", "pool/metrics");
+  snprintf(c->topicos[FORMATO_JSON], sizeof(c->topicos[0]), "%s", topico);
+  snprintf(c->topicos[FORMATO_BINARIO], sizeof(c->topicos[0]), "%s/bin", topico);
+  snprintf(c->topicos[FORMATO_SERIE], sizeof(c->topicos[0]), "%s/serie", topico);
+
+  // El firmware puede mandar la misma medición en más de un formato: leer
+  // más de uno la escribiría varias veces
+  const char* formato = variable("MQTT_FORMAT", NOMBRES_FORMATOS[FORMATO_JSON]);
+  c->formato = CANTIDAD_FORMATOS;
+  for (uint8_t i = 0; i < CANTIDAD_FORMATOS; i++) {
+    if (strcmp(formato, NOMBRES_FORMATOS[i]) == 0) c->formato = (FormatoMensaje)i;
+  }
+  if (c->formato == CANTIDAD_FORMATOS) {
+    fprintf(stderr, "MQTT_FORMAT=%s: tiene que ser json, binario o serie\n", formato);
+    return false;
+  }
+
+  c->urlInflux = variable("INFLUX_URL", "http://influxdb:8086");
+  c->organizacion = variable("INFLUX_ORG", nullptr);
+  c->bucket = variable("INFLUX_BUCKET", nullptr);
+  c->token = variable("INFLUX_TOKEN", nullptr);
+  if (c->organizacion == nullptr || c->bucket == nullptr || c->token == nullptr) {
+    fprintf(stderr, "Faltan INFLUX_ORG, INFLUX_BUCKET o INFLUX_TOKEN\n");
+    return false;
+  }
+
+  // Como name_override y [inputs.mqtt_consumer.tags] de telegraf.conf
+  c->medicion = variable("BRIDGE_MEASUREMENT", MEDICION_INFLUX);
+  c->host = variable("BRIDGE_TAG_HOST", "Pileta1");
+
+  c->lineasPorLote = (size_t)variableNumero("BRIDGE_BATCH_LINES", 5000, 1, 1000000);
+  c->bytesPorLote = (size_t)variableNumero("BRIDGE_BATCH_BYTES", 1024 * 1024, 1024, 64 * 1024 * 1024);
+  c->esperaLoteMs = variableNumero("BRIDGE_FLUSH_MS", 1000, 1, 600000);
+  c->cantidadLotes = (size_t)variableNumero("BRIDGE_BUFFERS", 4, 2, MAXIMO_LOTES);
+  c->puertoMetricas = (uint16_t)variableNumero("BRIDGE_METRICS_PORT", 9464, 0, 65535);
+  c->intervaloLogMs = variableNumero("BRIDGE_LOG_SECONDS", 60, 0, 86400) * 1000;
+  return true;
+}
+
+// ---- Lotes ----
+
+static void encolar(ColaLotes* cola, Lote* lote) {
+  cola->lotes[(cola->primero + cola->cantidad) % MAXIMO_LOTES] = lote;
+  cola->cantidad++;
+}
+
+static Lote* desencolar(ColaLotes* cola) {
+  Lote* lote = cola->lotes[cola->primero];
+  cola->primero = (cola->primero + 1) % MAXIMO_LOTES;
+  cola->cantidad--;
+  return lote;
+}
+
+static void vaciarLote(Lote* lote) {
+  lote->largo = 0;
+  lote->lineas = 0;
+  lote->primerMensajeMs = 0;
+  lote->timestampMaximo = 0;
+}
+
+// El lote siempre tiene lugar para una línea más
+static void reservarLotes() {
+  for (size_t i = 0; i < configuracion.cantidadLotes; i++) {
+    Lote* lote = new Lote;
+    lote->capacidad = configuracion.bytesPorLote + largoPrefijo + TAMANO_MAXIMO_CAMPOS_LINEA;
+    lote->texto = new char[lote->capacidad];
+    vaciarLote(lote);
+    encolar(&libres, lote);
+  }
+}
+
+// ---- Escritura ----
+
+static void registrarEscritura(const Lote& lote, int64_t duracionMs) {
+  metricas.lotesEscritos++;
+  metricas.lineasEscritas += lote.lineas;
+  metricas.bytesEscritos += lote.largo;
+  metricas.escrituraMsTotal += (uint64_t)duracionMs;
+  metricas.escrituraMsUltima = duracionMs;
+  if (duracionMs > metricas.escrituraMsMaxima) metricas.escrituraMsMaxima = duracionMs;
+  metricas.lagIngestaMs = ahoraMs() - lote.primerMensajeMs;
+  metricas.lagDatosS = (int64_t)time(nullptr) - lote.timestampMaximo;
+}
+
+static void escribirLote(Lote* lote) {
+  int64_t reintentoMs = REINTENTO_MINIMO_MS;
+
+  while (true) {
+    int64_t inicio = ahoraMs();
+    int64_t esperaMs;
+    ResultadoEscritura resultado = escribirInflux(&destino, lote->texto, lote->largo, &esperaMs);
+    int64_t duracion = ahoraMs() - inicio;
+
+    if (resultado == ESCRITURA_OK) {
+      registrarEscritura(*lote, duracion);
+      return;
+    }
+    if (resultado == ESCRITURA_RECHAZADA) {
+      metricas.lotesRechazados++;
+      metricas.lineasRechazadas += lote->lineas;
+      return;
+    }
+
+    metricas.reintentos++;
+    if (terminando) {
+      fprintf(stderr, "Se descartan %zu líneas sin escribir al salir\n", lote->lineas);
+      return;
+    }
+
+    // Mientras tanto los demás lotes se llenan y, si se acaban, la
+    // recepción se frena
+    int64_t espera = esperaMs > reintentoMs ? esperaMs : reintentoMs;
+    fprintf(stderr, "No se pudo escribir en InfluxDB, reintento en %lld ms\n", (long long)espera);
+    for (int64_t fin = ahoraMs() + espera; ahoraMs() < fin && !terminando;) usleep(100 * 1000);
+    reintentoMs = reintentoMs * 2 < REINTENTO_MAXIMO_MS ? reintentoMs * 2 : REINTENTO_MAXIMO_MS;
+  }
+}
+
+static void escribirLotes() {
+  while (true) {
+    Lote* lote;
+    {
+      std::unique_lock<std::mutex> bloqueo(mutexLotes);
+      cambioLotes.wait(bloqueo, [] { return llenos.cantidad > 0 || recepcionTerminada; });
+      if (llenos.cantidad == 0) return;
+      lote = desencolar(&llenos);
+    }
+
+    escribirLote(lote);
+    vaciarLote(lote);
+
+    {
+      std::lock_guard<std::mutex> bloqueo(mutexLotes);
+      encolar(&libres, lote);
+      metricas.lotesPendientes = (int)llenos.cantidad;
+    }
+    cambioLotes.notify_all();
+  }
+}
+
+// ---- Recepción ----
+
+static ConexionMqtt mqtt;
+static Lote* actual;
+static int64_t proximoLogMs;
+
+static void escribirLog(int64_t ahora) {
+  static uint64_t mensajesAntes, medicionesAntes, lineasAntes;
+  static int64_t desde;
+  if (configuracion.intervaloLogMs == 0 || ahora < proximoLogMs) return;
+
+  uint64_t mensajes = 0;
+  for (size_t i = 0; i < CANTIDAD_FORMATOS; i++) mensajes += metricas.mensajes[i];
+  double segundos = desde > 0 ? (ahora - desde) / 1000.0 : configuracion.intervaloLogMs / 1000.0;
+  uint64_t lotes = metricas.lotesEscritos;
+
+  printf("%.1f mensajes/s, %.1f mediciones/s, %.1f líneas escritas/s | escritura promedio %.1f ms, "
+         "lag %lld ms (datos %lld s) | %d lotes pendientes, %llu ms de contrapresión, %llu inválidos, "
+         "%llu reintentos\n",
+         (mensajes - mensajesAntes) / segundos, (metricas.mediciones - medicionesAntes) / segundos,
+         (metricas.lineasEscritas - lineasAntes) / segundos,
+         lotes > 0 ? (double)metricas.escrituraMsTotal / lotes : 0.0, (long long)metricas.lagIngestaMs.load(),
+         (long long)metricas.lagDatosS.load(), metricas.lotesPendientes.load(),
+         (unsigned long long)metricas.contrapresionMs.load(), (unsigned long long)metricas.mensajesInvalidos.load(),
+         (unsigned long long)metricas.reintentos.load());
+  fflush(stdout);
+
+  mensajesAntes = mensajes;
+  medicionesAntes = metricas.mediciones;
+  lineasAntes = metricas.lineasEscritas;
+  desde = ahora;
+  proximoLogMs = ahora + configuracion.intervaloLogMs;
+}
+
+// Pasa el lote actual a la escritura y toma uno libre. Si no hay, espera
+// sin leer MQTT (solo mantiene viva la conexión).
+static void entregarLote() {
+  std::unique_lock<std::mutex> bloqueo(mutexLotes);
+  if (actual->lineas > 0) {
+    encolar(&llenos, actual);
+    metricas.lotesPendientes = (int)llenos.cantidad;
+    actual = nullptr;
+    cambioLotes.notify_all();
+  }
+  if (actual != nullptr) return;
+
+  int64_t inicio = ahoraMs();
+  while (libres.cantidad == 0) {
+    cambioLotes.wait_for(bloqueo, std::chrono::seconds(1));
+    int64_t ahora = ahoraMs();
+    if (mqtt.socket >= 0 && !mantenerMqtt(&mqtt, ahora, false)) cerrarMqtt(&mqtt);
+    escribirLog(ahora);
+  }
+  metricas.contrapresionMs += (uint64_t)(ahoraMs() - inicio);
+  actual = desencolar(&libres);
+}
+
+static void agregarMedicion(const Medicion& medicion, int64_t ahora) {
+  if (actual->lineas == 0) actual->primerMensajeMs = ahora;
+  actual->largo += escribirLinea(medicion, prefijo, largoPrefijo, actual->texto + actual->largo);
+  actual->lineas++;
+  if (medicion.numeros[CAMPO_TIMESTAMP] > actual->timestampMaximo) {
+    actual->timestampMaximo = medicion.numeros[CAMPO_TIMESTAMP];
+  }
+  metricas.mediciones++;
+
+  if (actual->lineas >= configuracion.lineasPorLote || actual->largo >= configuracion.bytesPorLote) entregarLote();
+}
+
+static void procesarMensaje(const MensajeMqtt& mensaje, int64_t ahora) {
+  FormatoMensaje formato = configuracion.formato;
+  const char* topico = configuracion.topicos[formato];
+  if (strlen(topico) != mensaje.largoTopico || memcmp(topico, mensaje.topico, mensaje.largoTopico) != 0) return;
+
+  metricas.mensajes[formato]++;
+  metricas.bytesRecibidos += mensaje.largo;
+
+  LectorMensaje lector;
+  Medicion medicion;
+  int resultado;
+  iniciarLectorMensaje(&lector, formato, mensaje.datos, mensaje.largo);
+  while ((resultado = siguienteMedicion(&lector, &medicion)) > 0) agregarMedicion(medicion, ahora);
+
+  if (resultado < 0) {
+    uint64_t invalidos = ++metricas.mensajesInvalidos;
+    if (invalidos <= INVALIDOS_EN_LOG || invalidos % 1000 == 0) {
+      fprintf(stderr, "Mensaje inválido en %s (%zu bytes), van %llu\n", configuracion.topicos[formato],
+              mensaje.largo, (unsigned long long)invalidos);
+    }
+  }
+}
+
+static bool conectar(bool primeraVez) {
+  const char* topico = configuracion.topicos[configuracion.formato];
+  if (!conectarMqtt(&mqtt, configuracion.hostMqtt, configuracion.puertoMqtt, configuracion.idCliente, &topico, 1,
+                    ahoraMs(), &terminando)) {
+    return false;
+  }
+  if (!primeraVez) metricas.reconexionesMqtt++;
+  printf("Conectado a %s:%u, suscripto a %s (%s)\n", configuracion.hostMqtt, configuracion.puertoMqtt, topico,
+         NOMBRES_FORMATOS[configuracion.formato]);
+  fflush(stdout);
+  return true;
+}
+
+static void recibir() {
+  bool conectadoAlgunaVez = false;
+  int64_t reintentoMs = REINTENTO_MINIMO_MS;
+
+  while (!terminando) {
+    int64_t ahora = ahoraMs();
+    escribirLog(ahora);
+
+    if (mqtt.socket < 0) {
+      if (conectar(!conectadoAlgunaVez)) {
+        conectadoAlgunaVez = true;
+        reintentoMs = REINTENTO_MINIMO_MS;
+      } else {
+        for (int64_t fin = ahoraMs() + reintentoMs; ahoraMs() < fin && !terminando;) usleep(100 * 1000);
+        reintentoMs = reintentoMs * 2 < REINTENTO_MAXIMO_MS ? reintentoMs * 2 : REINTENTO_MAXIMO_MS;
+      }
+      continue;
+    }
+
+    // Se despierta para cerrar el lote a tiempo aunque no llegue nada
+    int64_t espera = 1000;
+    if (actual->lineas > 0) {
+      int64_t faltan = actual->primerMensajeMs + configuracion.esperaLoteMs - ahora;
+      espera = faltan < 0 ? 0 : faltan < espera ? faltan : espera;
+    }
+
+    pollfd pedido = {mqtt.socket, POLLIN, 0};
+    int listos = poll(&pedido, 1, (int)espera);
+    ahora = ahoraMs();
+
+    if (listos > 0) {
+      bool error = !recibirMqtt(&mqtt);
+      MensajeMqtt mensaje;
+      while (!error && siguienteMensajeMqtt(&mqtt, &mensaje, &error)) procesarMensaje(mensaje, ahora);
+      if (error) {
+        cerrarMqtt(&mqtt);
+        continue;
+      }
+    }
+
+    if (actual->lineas > 0 && ahora - actual->primerMensajeMs >= configuracion.esperaLoteMs) entregarLote();
+    if (mqtt.socket >= 0 && !mantenerMqtt(&mqtt, ahora, true)) cerrarMqtt(&mqtt);
+  }
+}
+
+static void alTerminar(int) {
+  terminando = 1;
+}
+
+int main() {
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  if (!leerConfiguracion(&configuracion)) return 1;
+  if (!configurarInflux(&destino, configuracion.urlInflux, configuracion.organizacion, configuracion.bucket,
+                        configuracion.token)) {
+    fprintf(stderr, "INFLUX_URL tiene que ser http://host[:puerto]: %s\n", configuracion.urlInflux);
+    return 1;
+  }
+  largoPrefijo = armarPrefijoLinea(configuracion.medicion, configuracion.host, configuracion.topicos[FORMATO_JSON],
+                                   prefijo, sizeof(prefijo));
+  if (largoPrefijo == 0) {
+    fprintf(stderr, "BRIDGE_MEASUREMENT, BRIDGE_TAG_HOST o MQTT_TOPIC demasiado largos\n");
+    return 1;
+  }
+
+  struct sigaction accion = {};
+  accion.sa_handler = alTerminar;
+  sigaction(SIGINT, &accion, nullptr);
+  sigaction(SIGTERM, &accion, nullptr);
+
+  iniciarMqtt(&mqtt);
+  reservarLotes();
+  actual = desencolar(&libres);
+  if (configuracion.puertoMetricas != 0 && !servirMetricas(&metricas, configuracion.puertoMetricas)) return 1;
+
+  printf("Lotes de hasta %zu líneas, %zu bytes o %lld ms, %zu lotes en memoria. InfluxDB en %s, bucket %s\n",
+         configuracion.lineasPorLote, configuracion.bytesPorLote, (long long)configuracion.esperaLoteMs,
+         configuracion.cantidadLotes, configuracion.urlInflux, configuracion.bucket);
+
+  std::thread escritura(escribirLotes);
+  proximoLogMs = ahoraMs() + configuracion.intervaloLogMs;
+  recibir();
+
+  // Lo que quedó se escribe antes de salir (un intento por lote)
+  printf("Saliendo, escribiendo lo pendiente\n");
+  {
+    std::lock_guard<std::mutex> bloqueo(mutexLotes);
+    if (actual->lineas > 0) encolar(&llenos, actual);
+    recepcionTerminada = true;
+  }
+  cambioLotes.notify_all();
+  escritura.join();
+  cerrarMqtt(&mqtt);
+  cerrarInflux(&destino);
+  return 0;
+}
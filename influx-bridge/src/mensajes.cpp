@@ -0,0 +1,115 @@
+#include "mensajes.h"
+
+const char* const NOMBRES_FORMATOS[CANTIDAD_FORMATOS] = {"json", "binario", "serie"};
+
+void iniciarLectorMensaje(LectorMensaje* lector, FormatoMensaje formato, const uint8_t* datos, size_t largo) {
+  lector->formato = formato;
+  lector->datos = datos;
+  lector->largo = largo;
+  lector->posicion = 0;
+  lector->esArray = false;
+  lector->terminado = false;
+  lector->invalido = false;
+
+  // Encabezado inválido: se avisa en la primera lectura
+  if (formato == FORMATO_SERIE && !iniciarLectorSerie(&lector->serie, datos, largo)) {
+    lector->terminado = lector->invalido = true;
+  }
+}
+
+static bool esEspacio(uint8_t c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static void saltarEspacios(LectorMensaje* lector) {
+  while (lector->posicion < lector->largo && esEspacio(lector->datos[lector->posicion])) lector->posicion++;
+}
+
+// Fin del objeto que empieza en 'inicio' ('{'), sin contar las llaves que
+// haya dentro de los textos. El esquema no tiene objetos anidados.
+static size_t finDeObjeto(const uint8_t* datos, size_t inicio, size_t largo) {
+  bool enTexto = false;
+  for (size_t i = inicio + 1; i < largo; i++) {
+    if (datos[i] == '"') enTexto = !enTexto;
+    if (!enTexto && datos[i] == '}') return i + 1;
+  }
+  return 0;
+}
+
+static int siguienteJson(LectorMensaje* lector, Medicion* medicion) {
+  if (lector->posicion == 0) {
+    saltarEspacios(lector);
+    if (lector->posicion < lector->largo && lector->datos[lector->posicion] == '[') {
+      lector->esArray = true;
+      lector->posicion++;
+    }
+  }
+  saltarEspacios(lector);
+
+  if (lector->esArray) {
+    if (lector->posicion < lector->largo && lector->datos[lector->posicion] == ']') {
+      lector->posicion++;
+      saltarEspacios(lector);
+      return lector->posicion == lector->largo ? 0 : -1;
+    }
+  } else if (lector->posicion == lector->largo) {
+    // Un objeto suelto que ya se leyó
+    return 0;
+  }
+
+  if (lector->posicion >= lector->largo || lector->datos[lector->posicion] != '{') return -1;
+  size_t fin = finDeObjeto(lector->datos, lector->posicion, lector->largo);
+  if (fin == 0) return -1;
+
+  const char* objeto = (const char*)lector->datos + lector->posicion;
+  if (!decodificarJson(objeto, fin - lector->posicion, medicion, lector->textos)) return -1;
+  lector->posicion = fin;
+
+  if (lector->esArray) {
+    saltarEspacios(lector);
+    if (lector->posicion < lector->largo && lector->datos[lector->posicion] == ',') {
+      lector->posicion++;
+    } else if (lector->posicion >= lector->largo || lector->datos[lector->posicion] != ']') {
+      return -1;
+    }
+  }
+  return 1;
+}
+
+int siguienteMedicion(LectorMensaje* lector, Medicion* medicion) {
+  if (lector->terminado) return lector->invalido ? -1 : 0;
+
+  int resultado;
+  switch (lector->formato) {
+    case FORMATO_JSON:
+      resultado = siguienteJson(lector, medicion);
+      break;
+
+    case FORMATO_BINARIO:
+      // Una medición por mensaje
+      if (lector->posicion > 0) {
+        resultado = 0;
+      } else {
+        resultado = decodificarBinario(lector->datos, lector->largo, medicion, lector->textos) ? 1 : -1;
+        lector->posicion = lector->largo;
+      }
+      break;
+
+    case FORMATO_SERIE:
+      if (lector->serie.restantes == 0) {
+        resultado = 0;
+      } else {
+        resultado = leerMedicion(&lector->serie, medicion) ? 1 : -1;
+      }
+      break;
+
+    default:
+      resultado = -1;
+  }
+
+  if (resultado <= 0) {
+    lector->terminado = true;
+    lector->invalido = resultado < 0;
+  }
+  return resultado;
+}
@@ -0,0 +1,46 @@
+#ifndef MENSAJES_H
+#define MENSAJES_H
+
+// Lectura de los mensajes de pool/metrics, pool/metrics/bin y
+// pool/metrics/serie.
+//
+// Los mensajes se leen en el mismo buffer en el que llegan, con los
+// decodificadores del esquema del firmware (ESP32-code/include/esquema.h):
+// no se arma ningún árbol JSON ni se copian los payloads. Cada medición
+// leída se pasa a una línea con protocolo_lineas.h.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esquema.h"
+#include "serie.h"
+
+enum FormatoMensaje : uint8_t {
+  FORMATO_JSON,     // Un objeto o un array de objetos (lote)
+  FORMATO_BINARIO,  // codificarBinario()
+  FORMATO_SERIE,    // Serie comprimida (serie.h)
+  CANTIDAD_FORMATOS
+};
+
+extern const char* const NOMBRES_FORMATOS[CANTIDAD_FORMATOS];
+
+// Recorre las mediciones de un mensaje. Los textos de la medición apuntan
+// al lector, así que valen hasta la siguiente lectura.
+struct LectorMensaje {
+  FormatoMensaje formato;
+  const uint8_t* datos;
+  size_t largo;
+  size_t posicion;
+  bool esArray;
+  bool terminado;
+  bool invalido;
+  LectorSerie serie;
+  char textos[TAMANO_TEXTOS_MEDICION];
+};
+
+void iniciarLectorMensaje(LectorMensaje* lector, FormatoMensaje formato, const uint8_t* datos, size_t largo);
+
+// 1 si dejó una medición en *medicion, 0 al terminar y -1 si el mensaje no
+// respeta el esquema (las mediciones anteriores ya leídas son válidas)
+int siguienteMedicion(LectorMensaje* lector, Medicion* medicion);
+
+#endif
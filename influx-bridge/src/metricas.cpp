@@ -0,0 +1,121 @@
+#include "metricas.h"
+
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "red.h"
+
+#define TAMANO_METRICAS 4096
+
+// Memoria residente del proceso, para compararla con la de Telegraf
+static uint64_t memoriaResidente() {
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (statm == nullptr) return 0;
+  unsigned long total, residente = 0;
+  if (fscanf(statm, "%lu %lu", &total, &residente) != 2) residente = 0;
+  fclose(statm);
+  return (uint64_t)residente * (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+struct Escritor {
+  char* destino;
+  size_t capacidad;
+  size_t largo;
+};
+
+static void escribir(Escritor* e, const char* tipo, const char* nombre, const char* ayuda, long long valor) {
+  if (e->largo >= e->capacidad) return;
+  int escritos = snprintf(e->destino + e->largo, e->capacidad - e->largo, "# HELP %s %s\n# TYPE %s %s\n%s %lld\n",
+                          nombre, ayuda, nombre, tipo, nombre, valor);
+  if (escritos > 0) e->largo += (size_t)escritos;
+  if (e->largo > e->capacidad) e->largo = e->capacidad;
+}
+
+size_t renderizarMetricas(const MetricasPuente& m, char* destino, size_t capacidad) {
+  Escritor e = {destino, capacidad, 0};
+
+  e.largo += snprintf(destino, capacidad,
+                      "# HELP puente_mensajes_total Mensajes MQTT recibidos por formato\n"
+                      "# TYPE puente_mensajes_total counter\n");
+  for (size_t i = 0; i < CANTIDAD_FORMATOS && e.largo < capacidad; i++) {
+    e.largo += snprintf(destino + e.largo, capacidad - e.largo, "puente_mensajes_total{formato=\"%s\"} %llu\n",
+                        NOMBRES_FORMATOS[i], (unsigned long long)m.mensajes[i].load());
+  }
+  if (e.largo > capacidad) e.largo = capacidad;
+
+  escribir(&e, "counter", "puente_bytes_recibidos_total", "Bytes de payload MQTT recibidos", m.bytesRecibidos);
+  escribir(&e, "counter", "puente_mediciones_total", "Mediciones leídas de los mensajes", m.mediciones);
+  escribir(&e, "counter", "puente_mensajes_invalidos_total", "Mensajes que no respetan el esquema", m.mensajesInvalidos);
+  escribir(&e, "counter", "puente_reconexiones_mqtt_total", "Conexiones al broker después de la primera",
+           m.reconexionesMqtt);
+  escribir(&e, "counter", "puente_contrapresion_ms_total", "Tiempo sin leer MQTT esperando un lote libre",
+           m.contrapresionMs);
+  escribir(&e, "counter", "puente_lotes_escritos_total", "Lotes escritos en InfluxDB", m.lotesEscritos);
+  escribir(&e, "counter", "puente_lineas_escritas_total", "Líneas escritas en InfluxDB", m.lineasEscritas);
+  escribir(&e, "counter", "puente_bytes_escritos_total", "Bytes de protocolo de líneas escritos", m.bytesEscritos);
+  escribir(&e, "counter", "puente_reintentos_total", "Escrituras que hubo que reintentar", m.reintentos);
+  escribir(&e, "counter", "puente_lotes_rechazados_total", "Lotes que InfluxDB rechazó (4xx)", m.lotesRechazados);
+  escribir(&e, "counter", "puente_lineas_rechazadas_total", "Líneas de los lotes rechazados", m.lineasRechazadas);
+  escribir(&e, "counter", "puente_escritura_ms_total", "Tiempo total escribiendo lotes", m.escrituraMsTotal);
+  escribir(&e, "gauge", "puente_escritura_ms", "Duración de la última escritura", m.escrituraMsUltima);
+  escribir(&e, "gauge", "puente_escritura_ms_maxima", "Escritura más lenta desde el arranque", m.escrituraMsMaxima);
+  escribir(&e, "gauge", "puente_lag_ingesta_ms", "Del mensaje más viejo del último lote a su escritura",
+           m.lagIngestaMs);
+  escribir(&e, "gauge", "puente_lag_datos_segundos", "Del timestamp más nuevo del último lote a su escritura",
+           m.lagDatosS);
+  escribir(&e, "gauge", "puente_lotes_pendientes", "Lotes llenos esperando la escritura", m.lotesPendientes);
+  escribir(&e, "gauge", "puente_memoria_residente_bytes", "Memoria residente del proceso",
+           (long long)memoriaResidente());
+  return e.largo;
+}
+
+static void atenderMetricas(const MetricasPuente* metricas, int servidor) {
+  static char cuerpo[TAMANO_METRICAS];
+  char pedido[1024];
+  char encabezado[160];
+
+  while (true) {
+    int cliente = accept(servidor, nullptr, nullptr);
+    if (cliente < 0) continue;
+    timeval timeout = {2, 0};
+    setsockopt(cliente, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(cliente, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    ssize_t leidos = recv(cliente, pedido, sizeof(pedido) - 1, 0);
+    if (leidos > 0) {
+      pedido[leidos] = '\0';
+      bool esMetricas = strncmp(pedido, "GET /metrics ", 13) == 0 || strncmp(pedido, "GET / ", 6) == 0;
+      size_t largo = esMetricas ? renderizarMetricas(*metricas, cuerpo, sizeof(cuerpo)) : 0;
+      int largoEncabezado = snprintf(encabezado, sizeof(encabezado),
+                                     "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                     "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                                     esMetricas ? "200 OK" : "404 Not Found", largo);
+      if (enviarTodo(cliente, encabezado, (size_t)largoEncabezado)) enviarTodo(cliente, cuerpo, largo);
+    }
+    close(cliente);
+  }
+}
+
+bool servirMetricas(const MetricasPuente* metricas, uint16_t puerto) {
+  int servidor = socket(AF_INET, SOCK_STREAM, 0);
+  if (servidor < 0) return false;
+  int uno = 1;
+  setsockopt(servidor, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+
+  sockaddr_in direccion = {};
+  direccion.sin_family = AF_INET;
+  direccion.sin_addr.s_addr = htonl(INADDR_ANY);
+  direccion.sin_port = htons(puerto);
+  if (bind(servidor, (sockaddr*)&direccion, sizeof(direccion)) != 0 || listen(servidor, 4) != 0) {
+    perror("Métricas");
+    close(servidor);
+    return false;
+  }
+
+  std::thread(atenderMetricas, metricas, servidor).detach();
+  return true;
+}
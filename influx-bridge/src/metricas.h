@@ -0,0 +1,47 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+// Contadores del puente. Se exponen en formato de texto de Prometheus en
+// http://<puente>:BRIDGE_METRICS_PORT/metrics y se resumen en el log.
+// Los escriben los dos hilos (recepción y escritura), por eso son atómicos.
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mensajes.h"
+
+struct MetricasPuente {
+  // Recepción
+  std::atomic<uint64_t> mensajes[CANTIDAD_FORMATOS];
+  std::atomic<uint64_t> bytesRecibidos;
+  std::atomic<uint64_t> mediciones;
+  std::atomic<uint64_t> mensajesInvalidos;
+  std::atomic<uint64_t> reconexionesMqtt;
+  std::atomic<uint64_t> contrapresionMs;  // Tiempo sin leer MQTT por falta de lotes libres
+
+  // Escritura
+  std::atomic<uint64_t> lotesEscritos;
+  std::atomic<uint64_t> lineasEscritas;
+  std::atomic<uint64_t> bytesEscritos;
+  std::atomic<uint64_t> reintentos;
+  std::atomic<uint64_t> lotesRechazados;
+  std::atomic<uint64_t> lineasRechazadas;
+  std::atomic<uint64_t> escrituraMsTotal;
+  std::atomic<int64_t> escrituraMsUltima;
+  std::atomic<int64_t> escrituraMsMaxima;
+
+  // Lag del último lote escrito
+  std::atomic<int64_t> lagIngestaMs;   // Del mensaje más viejo del lote a la escritura
+  std::atomic<int64_t> lagDatosS;      // Del timestamp más nuevo del lote a la escritura
+
+  std::atomic<int> lotesPendientes;    // Llenos, esperando la escritura
+};
+
+// Escribe todas las métricas en 'destino'. Devuelve el largo.
+size_t renderizarMetricas(const MetricasPuente& metricas, char* destino, size_t capacidad);
+
+// Atiende GET /metrics en 'puerto', en un hilo propio
+bool servirMetricas(const MetricasPuente* metricas, uint16_t puerto);
+
+#endif
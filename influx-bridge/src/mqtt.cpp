@@ -0,0 +1,276 @@
+#include "mqtt.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "red.h"
+
+// Tipos de paquete (byte 0 >> 4)
+#define MQTT_CONNECT 1
+#define MQTT_CONNACK 2
+#define MQTT_PUBLISH 3
+#define MQTT_PUBACK 4
+#define MQTT_SUBSCRIBE 8
+#define MQTT_SUBACK 9
+#define MQTT_PINGREQ 12
+#define MQTT_PINGRESP 13
+
+#define MQTT_ID_SUSCRIPCION 1
+
+void iniciarMqtt(ConexionMqtt* conexion) {
+  conexion->socket = -1;
+  conexion->buffer = (uint8_t*)malloc(MQTT_TAMANO_BUFFER);
+  conexion->inicio = conexion->largo = 0;
+  conexion->ultimoEnvioMs = 0;
+  conexion->esperandoPing = false;
+}
+
+// Largo restante (varint de hasta 4 bytes). Devuelve los bytes que ocupa,
+// 0 si todavía no llegó entero y -1 si es inválido.
+static int leerLargoRestante(const uint8_t* datos, size_t disponibles, size_t* largo) {
+  size_t valor = 0;
+  for (int i = 0; i < 4; i++) {
+    if ((size_t)i >= disponibles) return 0;
+    valor |= (size_t)(datos[i] & 0x7f) << (7 * i);
+    if ((datos[i] & 0x80) == 0) {
+      *largo = valor;
+      return i + 1;
+    }
+  }
+  return -1;
+}
+
+static size_t escribirLargoRestante(uint8_t* destino, size_t largo) {
+  size_t bytes = 0;
+  do {
+    uint8_t byte = largo % 128;
+    largo /= 128;
+    destino[bytes++] = largo > 0 ? byte | 0x80 : byte;
+  } while (largo > 0);
+  return bytes;
+}
+
+static size_t escribirTexto(uint8_t* destino, const char* texto) {
+  size_t largo = strlen(texto);
+  destino[0] = (uint8_t)(largo >> 8);
+  destino[1] = (uint8_t)largo;
+  memcpy(destino + 2, texto, largo);
+  return 2 + largo;
+}
+
+// Manda un paquete: el primer byte del encabezado fijo, el largo y 'cuerpo'
+static bool enviarPaquete(ConexionMqtt* conexion, uint8_t encabezado, const uint8_t* cuerpo, size_t largo) {
+  uint8_t fijo[5];
+  fijo[0] = encabezado;
+  size_t largoFijo = 1 + escribirLargoRestante(fijo + 1, largo);
+  if (!enviarTodo(conexion->socket, fijo, largoFijo)) return false;
+  if (largo > 0 && !enviarTodo(conexion->socket, cuerpo, largo)) return false;
+  return true;
+}
+
+enum LecturaSocket { LEIDO, SIN_DATOS, INTERRUMPIDO, CORTADO };
+
+// Lee lo que haya en el socket después de lo que ya está en el buffer
+static LecturaSocket leerSocket(ConexionMqtt* conexion) {
+  if (conexion->socket < 0) return CORTADO;
+
+  // Lo ya procesado se descarta
+  if (conexion->inicio > 0) {
+    memmove(conexion->buffer, conexion->buffer + conexion->inicio, conexion->largo - conexion->inicio);
+    conexion->largo -= conexion->inicio;
+    conexion->inicio = 0;
+  }
+  if (conexion->largo == MQTT_TAMANO_BUFFER) {
+    fprintf(stderr, "MQTT: paquete de más de %d bytes\n", MQTT_TAMANO_BUFFER);
+    return CORTADO;
+  }
+
+  ssize_t leidos = recv(conexion->socket, conexion->buffer + conexion->largo, MQTT_TAMANO_BUFFER - conexion->largo, 0);
+  if (leidos == 0) {
+    fprintf(stderr, "MQTT: el broker cerró la conexión\n");
+    return CORTADO;
+  }
+  if (leidos < 0) {
+    // Con SO_RCVTIMEO, EAGAIN es que pasó RED_TIMEOUT_MS sin nada
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return SIN_DATOS;
+    if (errno == EINTR) return INTERRUMPIDO;
+    perror("MQTT");
+    return CORTADO;
+  }
+  conexion->largo += (size_t)leidos;
+  return LEIDO;
+}
+
+// Espera un paquete entero al principio del buffer (solo durante la
+// conexión). Falla si el broker no manda nada en RED_TIMEOUT_MS o si
+// 'cancelar' se pone en 1.
+static bool esperarPaquete(ConexionMqtt* conexion, uint8_t tipo, size_t* largoCuerpo, size_t* inicioCuerpo,
+                           const volatile sig_atomic_t* cancelar) {
+  while (!*cancelar) {
+    size_t disponibles = conexion->largo - conexion->inicio;
+    size_t largo;
+    int bytesLargo = disponibles > 1 ? leerLargoRestante(conexion->buffer + conexion->inicio + 1, disponibles - 1, &largo) : 0;
+    if (bytesLargo < 0) return false;
+    if (bytesLargo > 0 && disponibles >= 1 + bytesLargo + largo) {
+      uint8_t recibido = conexion->buffer[conexion->inicio] >> 4;
+      *inicioCuerpo = conexion->inicio + 1 + bytesLargo;
+      *largoCuerpo = largo;
+      conexion->inicio = *inicioCuerpo + largo;
+      if (recibido == tipo) return true;
+      fprintf(stderr, "MQTT: se esperaba el paquete %u y llegó %u\n", tipo, recibido);
+      return false;
+    }
+    switch (leerSocket(conexion)) {
+      case LEIDO:
+      case INTERRUMPIDO:
+        break;
+      case SIN_DATOS:
+        fprintf(stderr, "MQTT: el broker no contestó en %d ms\n", RED_TIMEOUT_MS);
+        return false;
+      case CORTADO:
+        return false;
+    }
+  }
+  return false;
+}
+
+bool conectarMqtt(ConexionMqtt* conexion, const char* host, uint16_t puerto, const char* idCliente,
+                  const char* const* topicos, size_t cantidad, int64_t ahoraMs,
+                  const volatile sig_atomic_t* cancelar) {
+  uint8_t paquete[512];
+  size_t largoTopicos = 0;
+  for (size_t i = 0; i < cantidad; i++) largoTopicos += 3 + strlen(topicos[i]);
+  if (strlen(idCliente) > 64 || 2 + largoTopicos > sizeof(paquete)) return false;
+
+  cerrarMqtt(conexion);
+  conexion->socket = conectarTcp(host, puerto);
+  if (conexion->socket < 0) return false;
+
+  size_t largo = escribirTexto(paquete, "MQTT");
+  paquete[largo++] = 4;     // 3.1.1
+  paquete[largo++] = 0x02;  // Sesión limpia
+  paquete[largo++] = 0;
+  paquete[largo++] = MQTT_KEEPALIVE_S;
+  largo += escribirTexto(paquete + largo, idCliente);
+
+  size_t cuerpo, inicio;
+  if (!enviarPaquete(conexion, MQTT_CONNECT << 4, paquete, largo) ||
+      !esperarPaquete(conexion, MQTT_CONNACK, &cuerpo, &inicio, cancelar) || cuerpo != 2) {
+    fprintf(stderr, "MQTT: no se pudo conectar a %s:%u\n", host, puerto);
+    cerrarMqtt(conexion);
+    return false;
+  }
+  if (conexion->buffer[inicio + 1] != 0) {
+    fprintf(stderr, "MQTT: el broker rechazó la conexión (código %u)\n", conexion->buffer[inicio + 1]);
+    cerrarMqtt(conexion);
+    return false;
+  }
+
+  largo = 0;
+  paquete[largo++] = 0;
+  paquete[largo++] = MQTT_ID_SUSCRIPCION;
+  for (size_t i = 0; i < cantidad; i++) {
+    largo += escribirTexto(paquete + largo, topicos[i]);
+    paquete[largo++] = 1;  // QoS 1, como telegraf.conf
+  }
+  if (!enviarPaquete(conexion, (MQTT_SUBSCRIBE << 4) | 0x02, paquete, largo) ||
+      !esperarPaquete(conexion, MQTT_SUBACK, &cuerpo, &inicio, cancelar) || cuerpo != 2 + cantidad) {
+    fprintf(stderr, "MQTT: no se pudo suscribir\n");
+    cerrarMqtt(conexion);
+    return false;
+  }
+  for (size_t i = 0; i < cantidad; i++) {
+    if (conexion->buffer[inicio + 2 + i] == 0x80) {
+      fprintf(stderr, "MQTT: el broker rechazó la suscripción a %s\n", topicos[i]);
+      cerrarMqtt(conexion);
+      return false;
+    }
+  }
+
+  conexion->ultimoEnvioMs = ahoraMs;
+  conexion->esperandoPing = false;
+  return true;
+}
+
+bool recibirMqtt(ConexionMqtt* conexion) {
+  // Después de poll() no debería quedarse sin datos; si pasa, o llega una
+  // señal, se sigue en la próxima vuelta
+  return leerSocket(conexion) != CORTADO;
+}
+
+bool siguienteMensajeMqtt(ConexionMqtt* conexion, MensajeMqtt* mensaje, bool* error) {
+  *error = false;
+  while (true) {
+    size_t disponibles = conexion->largo - conexion->inicio;
+    if (disponibles < 2) return false;
+
+    const uint8_t* paquete = conexion->buffer + conexion->inicio;
+    size_t largo;
+    int bytesLargo = leerLargoRestante(paquete + 1, disponibles - 1, &largo);
+    if (bytesLargo == 0) return false;
+    if (bytesLargo < 0 || 1 + bytesLargo + largo > MQTT_TAMANO_BUFFER) {
+      *error = true;
+      return false;
+    }
+    if (disponibles < 1 + bytesLargo + largo) return false;
+
+    uint8_t tipo = paquete[0] >> 4;
+    const uint8_t* cuerpo = paquete + 1 + bytesLargo;
+    conexion->inicio += 1 + bytesLargo + largo;
+
+    if (tipo == MQTT_PINGRESP) {
+      conexion->esperandoPing = false;
+      continue;
+    }
+    if (tipo != MQTT_PUBLISH) continue;
+
+    uint8_t qos = (paquete[0] >> 1) & 0x03;
+    if (largo < 2) {
+      *error = true;
+      return false;
+    }
+    size_t largoTopico = (size_t)(cuerpo[0] << 8 | cuerpo[1]);
+    size_t encabezado = 2 + largoTopico + (qos > 0 ? 2 : 0);
+    if (qos > 1 || encabezado > largo) {
+      *error = true;
+      return false;
+    }
+
+    if (qos == 1) {
+      // Se confirma al recibirlo: desde acá la medición es responsabilidad
+      // del puente
+      const uint8_t* id = cuerpo + 2 + largoTopico;
+      if (!enviarPaquete(conexion, MQTT_PUBACK << 4, id, 2)) {
+        *error = true;
+        return false;
+      }
+    }
+
+    mensaje->topico = (const char*)cuerpo + 2;
+    mensaje->largoTopico = largoTopico;
+    mensaje->datos = cuerpo + encabezado;
+    mensaje->largo = largo - encabezado;
+    return true;
+  }
+}
+
+bool mantenerMqtt(ConexionMqtt* conexion, int64_t ahoraMs, bool verificarRespuesta) {
+  if (ahoraMs - conexion->ultimoEnvioMs < MQTT_KEEPALIVE_S * 1000 / 2) return true;
+  if (conexion->esperandoPing && verificarRespuesta) {
+    fprintf(stderr, "MQTT: el broker no contestó el PINGREQ\n");
+    return false;
+  }
+  conexion->esperandoPing = true;
+  conexion->ultimoEnvioMs = ahoraMs;
+  return enviarPaquete(conexion, MQTT_PINGREQ << 4, nullptr, 0);
+}
+
+void cerrarMqtt(ConexionMqtt* conexion) {
+  if (conexion->socket >= 0) close(conexion->socket);
+  conexion->socket = -1;
+  conexion->inicio = conexion->largo = 0;
+}
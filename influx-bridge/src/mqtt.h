@@ -0,0 +1,62 @@
+#ifndef MQTT_H
+#define MQTT_H
+
+// Cliente MQTT 3.1.1 mínimo, solo para suscribirse: CONNECT, SUBSCRIBE,
+// PUBLISH entrante con QoS 0 o 1 (se contesta el PUBACK) y PINGREQ.
+//
+// Los paquetes se leen en un buffer fijo y los mensajes se entregan
+// apuntando a ese buffer, sin copiarlos. Mientras no se llama a
+// recibirMqtt() no se lee el socket: si el que consume se atrasa, TCP
+// frena al broker (ver contrapresión en main.cpp).
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MQTT_TAMANO_BUFFER (256 * 1024)  // Mayor mensaje que se acepta, con el tópico
+#define MQTT_KEEPALIVE_S 30
+
+struct ConexionMqtt {
+  int socket;
+  uint8_t* buffer;   // MQTT_TAMANO_BUFFER bytes
+  size_t inicio;     // Primer byte sin procesar
+  size_t largo;      // Bytes recibidos
+  int64_t ultimoEnvioMs;
+  bool esperandoPing;
+};
+
+struct MensajeMqtt {
+  const char* topico;  // Sin \0
+  size_t largoTopico;
+  const uint8_t* datos;
+  size_t largo;
+};
+
+void iniciarMqtt(ConexionMqtt* conexion);
+
+// Conecta con sesión limpia y se suscribe a 'topicos' con QoS 1. Bloquea
+// hasta el SUBACK o un error (que se escribe en stderr). Un broker que no
+// contesta en RED_TIMEOUT_MS es un error. Si '*cancelar' se pone en 1 (una
+// señal), deja de esperar y devuelve false.
+bool conectarMqtt(ConexionMqtt* conexion, const char* host, uint16_t puerto, const char* idCliente,
+                  const char* const* topicos, size_t cantidad, int64_t ahoraMs,
+                  const volatile sig_atomic_t* cancelar);
+
+// Lee lo que haya en el socket (llamar cuando poll() avisa). Devuelve false
+// si se cortó la conexión.
+bool recibirMqtt(ConexionMqtt* conexion);
+
+// Siguiente PUBLISH completo del buffer. Los demás paquetes se procesan y
+// se saltean. El mensaje vale hasta la siguiente llamada a recibirMqtt().
+// Devuelve false cuando no hay más; *error queda en true si la conexión ya
+// no sirve.
+bool siguienteMensajeMqtt(ConexionMqtt* conexion, MensajeMqtt* mensaje, bool* error);
+
+// Manda PINGREQ si hace falta. Devuelve false si no se pudo o si el broker
+// no contestó el anterior. Mientras no se lee el socket (contrapresión) el
+// PINGRESP no se ve: ahí va 'verificarRespuesta' en false.
+bool mantenerMqtt(ConexionMqtt* conexion, int64_t ahoraMs, bool verificarRespuesta);
+
+void cerrarMqtt(ConexionMqtt* conexion);
+
+#endif
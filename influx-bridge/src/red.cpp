@@ -0,0 +1,63 @@
+#include "red.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+int64_t ahoraMs() {
+  timespec ahora;
+  clock_gettime(CLOCK_MONOTONIC, &ahora);
+  return (int64_t)ahora.tv_sec * 1000 + ahora.tv_nsec / 1000000;
+}
+
+int conectarTcp(const char* host, uint16_t puerto) {
+  addrinfo pista = {};
+  pista.ai_family = AF_UNSPEC;
+  pista.ai_socktype = SOCK_STREAM;
+  char servicio[8];
+  snprintf(servicio, sizeof(servicio), "%u", puerto);
+
+  addrinfo* direcciones;
+  int error = getaddrinfo(host, servicio, &pista, &direcciones);
+  if (error != 0) {
+    fprintf(stderr, "No se pudo resolver %s: %s\n", host, gai_strerror(error));
+    return -1;
+  }
+
+  int conectado = -1;
+  for (addrinfo* d = direcciones; d != nullptr && conectado < 0; d = d->ai_next) {
+    int s = socket(d->ai_family, d->ai_socktype, d->ai_protocol);
+    if (s < 0) continue;
+
+    timeval timeout = {RED_TIMEOUT_MS / 1000, (RED_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    int uno = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+
+    if (connect(s, d->ai_addr, d->ai_addrlen) == 0) {
+      conectado = s;
+    } else {
+      close(s);
+    }
+  }
+  freeaddrinfo(direcciones);
+
+  if (conectado < 0) perror(host);
+  return conectado;
+}
+
+bool enviarTodo(int socket, const void* datos, size_t largo) {
+  const uint8_t* p = (const uint8_t*)datos;
+  while (largo > 0) {
+    ssize_t enviados = send(socket, p, largo, MSG_NOSIGNAL);
+    if (enviados <= 0) return false;
+    p += enviados;
+    largo -= (size_t)enviados;
+  }
+  return true;
+}
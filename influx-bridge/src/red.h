@@ -0,0 +1,20 @@
+#ifndef RED_H
+#define RED_H
+
+// Sockets TCP bloqueantes con timeout, compartidos por MQTT e InfluxDB
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RED_TIMEOUT_MS 10000
+
+// Milisegundos de un reloj monótono
+int64_t ahoraMs();
+
+// Devuelve el socket o -1 (con el motivo en stderr)
+int conectarTcp(const char* host, uint16_t puerto);
+
+// Manda todo 'datos'. Devuelve false si se cortó o venció el timeout.
+bool enviarTodo(int socket, const void* datos, size_t largo);
+
+#endif
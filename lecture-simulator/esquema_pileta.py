@@ -0,0 +1,37 @@
+# Generado por ESP32-code/src/esquema/herramienta.cpp --python a partir de
+# ESP32-code/include/esquema.h. No editar a mano.
+
+import math
+
+ESQUEMA_VERSION = 1
+
+# (nombre, tipo, decimales, minimo, maximo, largo_maximo)
+CAMPOS = [
+    ("ph", "numero", 2, 0, 1400, 0),
+    ("temperature_c", "numero", 1, -100, 600, 0),
+    ("tds_ppm", "numero", 0, 0, 3000, 0),
+    ("trend", "texto", 0, 0, 0, 8),
+    ("trend_value", "numero", 0, -1, 1, 0),
+    ("timestamp", "numero", 0, 0, 4294967295, 0),
+    ("device_id", "texto", 0, 0, 0, 32),
+]
+
+TENDENCIA_SUBIENDO = "subiendo"
+TENDENCIA_ESTABLE = "estable"
+TENDENCIA_BAJANDO = "bajando"
+
+
+def armar_payload(**valores):
+    """Arma el diccionario a publicar con el mismo redondeo y rango que el firmware"""
+    payload = {}
+    for nombre, tipo, decimales, minimo, maximo, largo_maximo in CAMPOS:
+        valor = valores[nombre]
+        if tipo == "texto":
+            payload[nombre] = str(valor)[:largo_maximo]
+        else:
+            # Como fijarNumero(): la mitad se aleja del cero (round() va al par)
+            escalado = valor * 10 ** decimales
+            entero = int(math.copysign(math.floor(abs(escalado) + 0.5), escalado))
+            escalado = min(max(entero, minimo), maximo)
+            payload[nombre] = escalado / 10 ** decimales if decimales else escalado
+    return payload
@@ -1,6 +1,6 @@
 import os, json, time, random, math, logging
-from datetime import datetime, timezone
 import paho.mqtt.client as mqtt
+import esquema_pileta
 
 # Configurar logging
 logging.basicConfig(level=logging.INFO, format='%(asctime)s - %(levelname)s - %(message)s')
@@ -11,6 +11,7 @@ HOST = os.getenv("MQTT_HOST", "mosquitto")
 PUERTO = int(os.getenv("MQTT_PORT", "1883"))
 TOPICO = os.getenv("MQTT_TOPIC", "pool/metrics")
 INTERVALO = int(os.getenv("SIM_INTERVAL_SECONDS", "10"))
+ID_DISPOSITIVO = os.getenv("DEVICE_ID", "sim-pileta")
 
 PH_BASE = float(os.getenv("PH_BASE", "7.4"))
 TEMP_BASE = float(os.getenv("TEMP_BASE_C", "25.0"))
@@ -90,23 +91,25 @@ def generar_lectura(ph_previo, angulo):
     # Tendencia basada en diferencia actual vs previa
     delta = ph - ph_previo
     if delta > 0.01:
-        tendencia = "subiendo"
+        tendencia = esquema_pileta.TENDENCIA_SUBIENDO
         valor_tendencia = 1
     elif delta < -0.01:
-        tendencia = "bajando" 
+        tendencia = esquema_pileta.TENDENCIA_BAJANDO
         valor_tendencia = -1
     else:
-        tendencia = "estable"
+        tendencia = esquema_pileta.TENDENCIA_ESTABLE
         valor_tendencia = 0
     
-    payload = {
-        "ph": round(ph, 2),
-        "temperature_c": round(temperatura, 2),
-        "tds_ppm": int(round(tds)),
-        "trend": tendencia,
-        "trend_value": valor_tendencia,
-        "timestamp": datetime.now(timezone.utc).strftime("%Y-%m-%dT%H:%M:%SZ")
-    }
+    # Mismos campos, redondeo y rangos que el firmware (esquema_pileta.py)
+    payload = esquema_pileta.armar_payload(
+        ph=ph,
+        temperature_c=temperatura,
+        tds_ppm=tds,
+        trend=tendencia,
+        trend_value=valor_tendencia,
+        timestamp=int(time.time()),
+        device_id=ID_DISPOSITIVO,
+    )
     
     return payload, ph
 